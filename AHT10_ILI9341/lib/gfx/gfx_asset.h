@@ -0,0 +1,54 @@
+#ifndef gfx_asset_H
+#define gfx_asset_H
+
+#include "pico/stdlib.h"
+
+// Compressed image and font assets, produced on the host by
+// host/gfx_assetconv and decoded row by row straight into spans: runs are
+// filled into the framebuffer, or without one streamed into a single window
+// (one window per row stretch when the asset has transparent pixels).
+
+// Paletted image. Each row is a sequence of PackBits-style packets that
+// never cross the end of the row:
+//   0x80 | (n - 1), index     n pixels (1..128) of one palette entry
+//   n - 1, index * n          n literal palette indexes (1..128)
+typedef struct {
+	uint16_t width;			 ///< Image dimensions in pixels
+	uint16_t height;		 ///< Image dimensions in pixels
+	const uint16_t *palette; ///< RGB565 colors
+	uint16_t paletteSize;	 ///< Entries in palette
+	int16_t transparent;	 ///< Palette index left undrawn, -1 for none
+	const uint8_t *data;	 ///< Packets, all rows concatenated
+} GFX_Image;
+
+/// Run-encoded glyph: each row is a list of run lengths that alternate
+/// between background and foreground, starting with background, and add up
+/// to the glyph width.
+typedef struct {
+	uint16_t dataOffset; ///< Offset of the first row in GFX_RunFont->data
+	uint8_t width;		 ///< Bounding box in pixels
+	uint8_t height;		 ///< Bounding box in pixels
+	uint8_t xAdvance;	 ///< Distance to advance cursor (x axis)
+	int8_t xOffset;		 ///< X dist from cell left to UL corner
+	int8_t yOffset;		 ///< Y dist from cell top to UL corner
+} GFX_RunGlyph;
+
+typedef struct {
+	const uint8_t *data;		///< Glyph runs, concatenated
+	const GFX_RunGlyph *glyph; ///< Glyph array
+	uint16_t first;				///< ASCII extents (first char)
+	uint16_t last;				///< ASCII extents (last char)
+	uint8_t yAdvance;			///< Cell height and newline distance
+} GFX_RunFont;
+
+void GFX_drawImage(const GFX_Image *img, int16_t x, int16_t y);
+
+// (x, y) is the top-left corner of the character cell. With bg != color the
+// whole cell (xAdvance x yAdvance) is painted, otherwise only the glyph.
+// Both return the x position of the next character.
+int16_t GFX_drawRunChar(const GFX_RunFont *f, int16_t x, int16_t y, unsigned char c,
+						uint16_t color, uint16_t bg);
+int16_t GFX_drawRunText(const GFX_RunFont *f, int16_t x, int16_t y, const char *text,
+						uint16_t color, uint16_t bg);
+
+#endif
@@ -0,0 +1,219 @@
+#include "pico/stdlib.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "gfx.h"
+#include "gfx_console.h"
+#include "ili9341.h"
+
+static bool conActive = false;
+static uint16_t *conLine = NULL; // Current text line, full width x conLineH
+
+static uint16_t conTop;	  // First panel row of the scroll area
+static uint16_t conRows;  // Text rows in the scroll area
+static uint16_t conCols;  // Text columns
+static uint16_t conLineH; // Pixel rows per text row
+static uint8_t conSize;
+
+static uint16_t conFirst; // Text row currently shown at the top of the area
+static uint16_t conRow;	  // Cursor row, counted from the top of the area
+static uint16_t conCol;	  // Cursor column
+
+static uint16_t conColor = 0xFFFF;
+static uint16_t conBg = 0x0000;
+
+static int16_t dirtyX0, dirtyX1; // Pixel span of conLine not yet sent
+static bool scrollPending = false;
+
+static char conBuf[100];
+
+// Panel row holding the first pixel row of the given on-screen text row
+static uint16_t conPanelRow(uint16_t row)
+{
+	return conTop + ((conFirst + row) % conRows) * conLineH;
+}
+
+static void conClearLine()
+{
+	uint32_t n = GFX_getWidth() * conLineH;
+	for (uint32_t i = 0; i < n; i++)
+		conLine[i] = conBg;
+}
+
+static void conMarkDirty(int16_t x0, int16_t x1)
+{
+	if (dirtyX0 > dirtyX1)
+	{
+		dirtyX0 = x0;
+		dirtyX1 = x1;
+		return;
+	}
+	if (x0 < dirtyX0)
+		dirtyX0 = x0;
+	if (x1 > dirtyX1)
+		dirtyX1 = x1;
+}
+
+static void conNewLine()
+{
+	// A scrolled-in row that got no text still has to be blanked on the panel
+	if (scrollPending)
+		conMarkDirty(0, GFX_getWidth() - 1);
+	GFX_consoleFlush();
+	conCol = 0;
+	conClearLine();
+
+	if (conRow < conRows - 1)
+	{
+		conRow++; // Rows below the cursor are still blank
+		return;
+	}
+
+	// Bottom reached: the oldest row becomes the new bottom row. It still
+	// holds old text, so the scroll is deferred until the row has content and
+	// is sent whole, together with the new scroll start.
+	conFirst = (conFirst + 1) % conRows;
+	scrollPending = true;
+}
+
+bool GFX_consoleInit(uint16_t topFixed, uint16_t bottomFixed, uint8_t size)
+{
+	if (LCD_getRotation() != 0)
+		return false;
+	if (size == 0)
+		size = 1;
+
+	uint16_t lineH = 8 * size;
+	if (topFixed + bottomFixed + 2 * lineH > ILI9341_TFTHEIGHT)
+		return false;
+
+	free(conLine);
+	conLine = malloc(GFX_getWidth() * lineH * sizeof(uint16_t));
+	if (conLine == NULL)
+		return false;
+
+	conSize = size;
+	conLineH = lineH;
+	conTop = topFixed;
+	conRows = (ILI9341_TFTHEIGHT - topFixed - bottomFixed) / lineH;
+	conCols = GFX_getWidth() / (6 * size);
+
+	// Grow the bottom area so the scroll area is a whole number of text rows
+	LCD_setScrollArea(conTop, ILI9341_TFTHEIGHT - conTop - conRows * conLineH);
+	conActive = true;
+	GFX_consoleClear();
+	return true;
+}
+
+void GFX_consoleEnd()
+{
+	if (!conActive)
+		return;
+
+	LCD_setScrollArea(0, 0);
+	LCD_setScrollStart(0);
+	free(conLine);
+	conLine = NULL;
+	conActive = false;
+}
+
+void GFX_consoleSetColor(uint16_t color, uint16_t bg)
+{
+	conColor = color;
+	conBg = bg;
+}
+
+void GFX_consoleClear()
+{
+	if (!conActive)
+		return;
+
+	conFirst = 0;
+	conRow = 0;
+	conCol = 0;
+	dirtyX0 = 1;
+	dirtyX1 = 0;
+	scrollPending = false;
+
+	conClearLine();
+	GFX_flushQueue();
+	for (uint16_t r = 0; r < conRows; r++)
+		LCD_WriteBitmap(0, conPanelRow(r), GFX_getWidth(), conLineH, conLine);
+	LCD_setScrollStart(conTop);
+}
+
+void GFX_consoleWrite(uint8_t c)
+{
+	if (!conActive)
+		return;
+
+	if (c == '\n')
+	{
+		conNewLine();
+		return;
+	}
+	if (c == '\r')
+	{
+		conCol = 0;
+		return;
+	}
+
+	if (conCol >= conCols)
+		conNewLine();
+
+	int16_t x = conCol * 6 * conSize;
+	GFX_renderChar(conLine + x, GFX_getWidth(), c, conColor, conBg, conSize,
+				   conSize);
+	conMarkDirty(x, x + 6 * conSize - 1);
+	conCol++;
+}
+
+void GFX_consolePrintf(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vsnprintf(conBuf, sizeof(conBuf), format, args);
+	va_end(args);
+
+	for (char *p = conBuf; *p; p++)
+		GFX_consoleWrite(*p);
+	GFX_consoleFlush();
+}
+
+void GFX_consoleFlush()
+{
+	if (!conActive || dirtyX0 > dirtyX1)
+		return;
+
+	if (scrollPending)
+	{
+		dirtyX0 = 0;
+		dirtyX1 = GFX_getWidth() - 1;
+	}
+
+	uint16_t y = conPanelRow(conRow);
+	uint16_t w = dirtyX1 - dirtyX0 + 1;
+
+	GFX_flushQueue(); // Unbuffered draws queued before this line go first
+
+	if (w == GFX_getWidth())
+		LCD_WriteBitmap(0, y, w, conLineH, conLine);
+	else
+	{
+		// conLine rows are not contiguous for a partial span: one window,
+		// rows streamed into it
+		LCD_beginPixels(dirtyX0, y, w, conLineH);
+		for (uint16_t j = 0; j < conLineH; j++)
+			LCD_writePixels(conLine + j * GFX_getWidth() + dirtyX0, w);
+		LCD_endPixels();
+	}
+	dirtyX0 = 1;
+	dirtyX1 = 0;
+
+	if (scrollPending)
+	{
+		LCD_setScrollStart(conPanelRow(0));
+		scrollPending = false;
+	}
+}
@@ -4,6 +4,11 @@
 
 #include "ili9341.h"
 
+#ifdef USE_PIO
+#undef USE_DMA
+#include "ili9341_pio.h"
+#endif
+
 uint16_t _width;  ///< Display width as modified by current rotation
 uint16_t _height; ///< Display height as modified by current rotation
 
@@ -76,6 +81,9 @@ void LCD_setSPIperiph(spi_inst_t *s)
 
 void initSPI()
 {
+#ifdef USE_PIO
+	ILI9341_pioInit();
+#else
 	spi_init(ili9341_spi, 1000 * 40000);
 	spi_set_format(ili9341_spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
 	gpio_set_function(ili9341_pinSCK, GPIO_FUNC_SPI);
@@ -88,6 +96,7 @@ void initSPI()
 	gpio_init(ili9341_pinDC);
 	gpio_set_dir(ili9341_pinDC, GPIO_OUT);
 	gpio_put(ili9341_pinDC, 1);
+#endif
 
 	if (ili9341_pinRST != -1)
 	{
@@ -115,38 +124,56 @@ void ILI9341_Reset()
 	}
 }
 
+// With USE_PIO the state machine owns CS and DC: every record it sends
+// carries its own DC flag, so these are no-ops.
 void ILI9341_Select()
 {
+#ifndef USE_PIO
 	gpio_put(ili9341_pinCS, 0);
+#endif
 }
 
 void ILI9341_DeSelect()
 {
+#ifndef USE_PIO
 	gpio_put(ili9341_pinCS, 1);
+#endif
 }
 
 void ILI9341_RegCommand()
 {
+#ifndef USE_PIO
 	gpio_put(ili9341_pinDC, 0);
+#endif
 }
 
 void ILI9341_RegData()
 {
+#ifndef USE_PIO
 	gpio_put(ili9341_pinDC, 1);
+#endif
 }
 
 void ILI9341_WriteCommand(uint8_t cmd)
 {
+#ifdef USE_PIO
+	ILI9341_pioWrite(false, &cmd, 1);
+#else
 	ILI9341_RegCommand();
 	spi_set_format(ili9341_spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
 	spi_write_blocking(ili9341_spi, &cmd, sizeof(cmd));
+#endif
 }
 
 void ILI9341_WriteData(uint8_t *buff, size_t buff_size)
 {
+#ifdef USE_PIO
+	ILI9341_pioWrite(true, buff, buff_size);
+#else
 	ILI9341_RegData();
 	spi_set_format(ili9341_spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
 	spi_write_blocking(ili9341_spi, buff, buff_size);
+#endif
 }
 
 void ILI9341_SendCommand(uint8_t commandByte, uint8_t *dataBytes,
@@ -249,6 +276,31 @@ void LCD_setRotation(uint8_t m)
 	ILI9341_SendCommand(ILI9341_MADCTL, &m, 1);
 }
 
+uint8_t LCD_getRotation()
+{
+	return rotation;
+}
+
+// Vertical scrolling runs along the 320 native rows of the panel, so it only
+// matches the logical Y axis in rotation 0.
+void LCD_setScrollArea(uint16_t tfa, uint16_t bfa)
+{
+	uint16_t vsa = ILI9341_TFTHEIGHT - tfa - bfa;
+	uint8_t data[6] = {
+		tfa >> 8, tfa & 0xFF,
+		vsa >> 8, vsa & 0xFF,
+		bfa >> 8, bfa & 0xFF};
+
+	ILI9341_SendCommand(ILI9341_VSCRDEF, data, 6);
+}
+
+void LCD_setScrollStart(uint16_t vsp)
+{
+	uint8_t data[2] = {vsp >> 8, vsp & 0xFF};
+
+	ILI9341_SendCommand(ILI9341_VSCRSADD, data, 2);
+}
+
 void LCD_setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
     uint16_t x0 = x;
     uint16_t x1 = x + w - 1;
@@ -279,6 +331,12 @@ void LCD_setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
 
 void LCD_WriteBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
 {
+#ifdef USE_PIO
+	LCD_beginBatch();
+	LCD_batchRect(x, y, w, h, bitmap, w);
+	LCD_endBatch();
+	LCD_waitBatch();
+#else
 	ILI9341_Select();
 	LCD_setAddrWindow(x, y, w, h); // Clipped area
 	ILI9341_RegData();
@@ -296,16 +354,66 @@ void LCD_WriteBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *b
 #endif
 
 	ILI9341_DeSelect();
+#endif
+}
+
+// Streamed window write: LCD_beginPixels opens the window, LCD_writePixels
+// sends consecutive chunks of it and LCD_endPixels closes it. With DMA a chunk
+// is sent in the background, so the caller may fill another buffer meanwhile;
+// the buffer passed in must stay untouched until the next call.
+void LCD_beginPixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	ILI9341_Select();
+	LCD_setAddrWindow(x, y, w, h);
+#ifndef USE_PIO
+	ILI9341_RegData();
+	spi_set_format(ili9341_spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+#endif
+}
+
+void LCD_writePixels(uint16_t *pixels, uint32_t n)
+{
+#if defined(USE_PIO)
+	ILI9341_pioWritePixels(pixels, n);
+#elif defined(USE_DMA)
+	waitForDMA();
+	dma_channel_configure(dma_tx, &dma_cfg,
+						  &spi_get_hw(ili9341_spi)->dr,
+						  pixels,
+						  n,
+						  true);
+#else
+	spi_write16_blocking(ili9341_spi, pixels, n);
+#endif
+}
+
+void LCD_endPixels()
+{
+#ifdef USE_PIO
+	ILI9341_pioWait();
+#else
+#ifdef USE_DMA
+	waitForDMA();
+#endif
+	while (spi_is_busy(ili9341_spi))
+		tight_loop_contents();
+	ILI9341_DeSelect();
+#endif
 }
 
 void LCD_WritePixel(int x, int y, uint16_t col)
 {
 	ILI9341_Select();
 	LCD_setAddrWindow(x, y, 1, 1); // Clipped area
+#ifdef USE_PIO
+	uint8_t data[2] = {col >> 8, col & 0xFF};
+	ILI9341_pioWrite(true, data, 2);
+#else
 	ILI9341_RegData();
 	spi_set_format(ili9341_spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
 	spi_write16_blocking(ili9341_spi, &col, 1);
 	ILI9341_DeSelect();
+#endif
 }
 
 void LCD_fillScreen(uint16_t color) {
@@ -313,6 +421,9 @@ void LCD_fillScreen(uint16_t color) {
     LCD_setAddrWindow(0, 0, _width, _height);
 
     ILI9341_WriteCommand(ILI9341_RAMWR);
+#ifdef USE_PIO
+    ILI9341_pioFill(color, (uint32_t)_width * _height);
+#else
     ILI9341_RegData();
 
     spi_set_format(ili9341_spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
@@ -329,4 +440,35 @@ void LCD_fillScreen(uint16_t color) {
     }
 
     ILI9341_DeSelect();
-}
\ No newline at end of file
+#endif
+}
+
+#ifndef USE_PIO
+// Without the PIO transport each rect is written as soon as it is queued
+void LCD_beginBatch()
+{
+}
+
+void LCD_batchRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *pixels, uint16_t stride)
+{
+	if (w == 0 || h == 0)
+		return;
+	if (stride == w)
+	{
+		LCD_WriteBitmap(x, y, w, h, pixels);
+		return;
+	}
+	LCD_beginPixels(x, y, w, h);
+	for (uint16_t j = 0; j < h; j++)
+		LCD_writePixels(pixels + (uint32_t)j * stride, w);
+	LCD_endPixels();
+}
+
+void LCD_endBatch()
+{
+}
+
+void LCD_waitBatch()
+{
+}
+#endif
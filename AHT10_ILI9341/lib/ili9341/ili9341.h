@@ -6,6 +6,23 @@
 // Use DMA?
 //#define USE_DMA 1
 
+// Use the PIO transport? A PIO state machine drives SCK, MOSI, DC and CS from
+// one DMA-fed stream, so commands, parameters and pixels go out without the
+// CPU toggling DC in between. Side-set drives CS and SCK, so SCK must be the
+// pin right after CS (default wiring: CS 17, SCK 18). The SPI peripheral is
+// not used; USE_DMA has no effect.
+//#define USE_PIO 1
+
+#ifndef ILI9341_PIO_HZ
+#define ILI9341_PIO_HZ 62500000 // Bit clock of the PIO transport
+#endif
+#ifndef LCD_BATCH_BLOCKS
+#define LCD_BATCH_BLOCKS 512 // DMA blocks per batch (a strided rect uses 2 per row)
+#endif
+#ifndef LCD_BATCH_WORDS
+#define LCD_BATCH_WORDS 512 // 16-bit words for window commands and headers
+#endif
+
 #define MADCTL_MY 0x80  ///< Bottom to top
 #define MADCTL_MX 0x40  ///< Right to left
 #define MADCTL_MV 0x20  ///< Reverse Mode
@@ -92,10 +109,19 @@ void LCD_initDisplay();
 void LCD_deinitDisplay();
 
 void LCD_setRotation(uint8_t m);
+uint8_t LCD_getRotation();
+
+// Hardware vertical scrolling (VSCRDEF / VSCRSADD)
+void LCD_setScrollArea(uint16_t tfa, uint16_t bfa);
+void LCD_setScrollStart(uint16_t vsp);
 
 void LCD_WritePixel(int x, int y, uint16_t col);
 void LCD_WriteBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *bitmap);
 
+void LCD_beginPixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void LCD_writePixels(uint16_t *pixels, uint32_t n);
+void LCD_endPixels();
+
 // ili9341.h - Adicione estas declarações
 void ILI9341_Select(void);
 void ILI9341_DeSelect(void);
@@ -105,6 +131,16 @@ void ILI9341_Reset(void);
 
 void LCD_setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 
+// Batched window writes. LCD_batchRect queues a window and its pixels, taken
+// from rows stride pixels apart; LCD_endBatch sends the queue and
+// LCD_waitBatch returns once the panel has received it. With USE_PIO the batch
+// is a single DMA chain that runs without the CPU, otherwise each rect is
+// written as it is queued. Pixels must stay untouched until LCD_waitBatch.
+void LCD_beginBatch();
+void LCD_batchRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *pixels, uint16_t stride);
+void LCD_endBatch();
+void LCD_waitBatch();
+
 void LCD_fillScreen(uint16_t color);
 
 #endif
\ No newline at end of file
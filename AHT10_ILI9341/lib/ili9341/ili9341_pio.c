@@ -0,0 +1,305 @@
+#include "pico/stdlib.h"
+#include "ili9341.h"
+
+#ifdef USE_PIO
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+
+#include "ili9341_pio.h"
+#include "ili9341.pio.h"
+
+extern uint16_t ili9341_pinCS;
+extern uint16_t ili9341_pinDC;
+extern uint16_t ili9341_pinSCK;
+extern uint16_t ili9341_pinTX;
+
+#define REC_DATA 0x8000
+#define REC_ODD 0x4000
+
+// Largest payload of one record: the bit count field is 16 bits wide
+#define REC_MAX_PIXELS 4096
+
+static PIO lcd_pio = pio0;
+static uint lcd_sm;
+static uint lcd_offset;
+
+// DMA chain: the control channel loads (count, read address) pairs from
+// blocks[] into the data channel, which streams them into the TX FIFO and
+// retriggers the control channel when done. A zero pair ends the chain.
+typedef struct
+{
+	uint32_t count;
+	const void *read;
+} pioBlock;
+
+static int dataChan, ctrlChan;
+static pioBlock blocks[LCD_BATCH_BLOCKS + 1];
+static uint16_t words[LCD_BATCH_WORDS]; // Record headers and command payloads
+static uint16_t numBlocks, numWords;
+static uint16_t *rowHeader; // Shared header for the rows of a strided rect
+static bool batchOpen = false;
+
+void ILI9341_pioInit()
+{
+	// CS and SCK are the two side-set pins, so SCK has to follow CS
+	lcd_offset = pio_add_program(lcd_pio, &ili9341_pio_program);
+	lcd_sm = pio_claim_unused_sm(lcd_pio, true);
+
+	float div = (float)clock_get_hz(clk_sys) / (2.0f * ILI9341_PIO_HZ);
+	if (div < 1.0f)
+		div = 1.0f;
+	ili9341_pio_program_init(lcd_pio, lcd_sm, lcd_offset, ili9341_pinCS,
+							 ili9341_pinTX, ili9341_pinDC, div);
+
+	dataChan = dma_claim_unused_channel(true);
+	ctrlChan = dma_claim_unused_channel(true);
+
+	dma_channel_config c = dma_channel_get_default_config(dataChan);
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, false);
+	channel_config_set_dreq(&c, pio_get_dreq(lcd_pio, lcd_sm, true));
+	channel_config_set_chain_to(&c, ctrlChan);
+	dma_channel_configure(dataChan, &c, &lcd_pio->txf[lcd_sm], NULL, 0, false);
+
+	c = dma_channel_get_default_config(ctrlChan);
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, true);
+	channel_config_set_ring(&c, true, 3); // Wrap on the 8 bytes count + read address
+	dma_channel_configure(ctrlChan, &c, &dma_hw->ch[dataChan].al3_transfer_count,
+						  blocks, 2, false);
+}
+
+// Waits until the DMA chain has handed everything to the state machine
+static void waitChain()
+{
+	while (dma_channel_is_busy(ctrlChan) || dma_channel_is_busy(dataChan))
+		tight_loop_contents();
+}
+
+// Waits until the last bit has left the state machine
+void ILI9341_pioWait()
+{
+	waitChain();
+	while (!pio_sm_is_tx_fifo_empty(lcd_pio, lcd_sm))
+		tight_loop_contents();
+	while (pio_sm_get_pc(lcd_pio, lcd_sm) != lcd_offset + ili9341_pio_offset_start)
+		tight_loop_contents();
+}
+
+static inline void put16(uint16_t w)
+{
+	pio_sm_put_blocking(lcd_pio, lcd_sm, (uint32_t)w << 16);
+}
+
+// Writes one record straight into the FIFO
+void ILI9341_pioWrite(bool data, const uint8_t *buff, size_t n)
+{
+	if (n == 0)
+		return;
+	waitChain();
+	put16((data ? REC_DATA : 0) | ((n & 1) ? REC_ODD : 0));
+	put16(n * 8 - 1);
+	for (size_t i = 0; i < n; i += 2)
+		put16((buff[i] << 8) | (i + 1 < n ? buff[i + 1] : 0));
+}
+
+void ILI9341_pioFill(uint16_t color, uint32_t n)
+{
+	waitChain();
+	while (n > 0)
+	{
+		uint32_t chunk = n > REC_MAX_PIXELS ? REC_MAX_PIXELS : n;
+		put16(REC_DATA);
+		put16(chunk * 16 - 1);
+		for (uint32_t i = 0; i < chunk; i++)
+			put16(color);
+		n -= chunk;
+	}
+}
+
+// ============================================================
+// Montagem da cadeia de DMA
+// ============================================================
+
+static void startChain()
+{
+	blocks[numBlocks].count = 0;
+	blocks[numBlocks].read = NULL;
+	dma_channel_set_read_addr(ctrlChan, blocks, true);
+}
+
+static void resetChain()
+{
+	numBlocks = 0;
+	numWords = 0;
+	rowHeader = NULL;
+}
+
+static bool hasRoom(uint16_t nWords, uint16_t nBlocks)
+{
+	return numWords + nWords <= LCD_BATCH_WORDS && numBlocks + nBlocks <= LCD_BATCH_BLOCKS;
+}
+
+// Appends a DMA block, merging it with the previous one when contiguous
+static void addBlock(const uint16_t *src, uint32_t n)
+{
+	if (numBlocks > 0)
+	{
+		pioBlock *last = &blocks[numBlocks - 1];
+		if ((const uint16_t *)last->read + last->count == src)
+		{
+			last->count += n;
+			return;
+		}
+	}
+	blocks[numBlocks].count = n;
+	blocks[numBlocks].read = src;
+	numBlocks++;
+}
+
+static uint16_t *addWords(uint16_t n)
+{
+	uint16_t *w = &words[numWords];
+	numWords += n;
+	addBlock(w, n);
+	return w;
+}
+
+static void addRecord(bool data, const uint8_t *buff, uint8_t n)
+{
+	uint16_t *w = addWords(2 + (n + 1) / 2);
+	*w++ = (data ? REC_DATA : 0) | ((n & 1) ? REC_ODD : 0);
+	*w++ = n * 8 - 1;
+	for (uint8_t i = 0; i < n; i += 2)
+		*w++ = (buff[i] << 8) | (i + 1 < n ? buff[i + 1] : 0);
+}
+
+static void addWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	uint8_t cmd, data[4];
+
+	cmd = ILI9341_CASET;
+	addRecord(false, &cmd, 1);
+	data[0] = x >> 8;
+	data[1] = x & 0xFF;
+	data[2] = (x + w - 1) >> 8;
+	data[3] = (x + w - 1) & 0xFF;
+	addRecord(true, data, 4);
+
+	cmd = ILI9341_PASET;
+	addRecord(false, &cmd, 1);
+	data[0] = y >> 8;
+	data[1] = y & 0xFF;
+	data[2] = (y + h - 1) >> 8;
+	data[3] = (y + h - 1) & 0xFF;
+	addRecord(true, data, 4);
+
+	cmd = ILI9341_RAMWR;
+	addRecord(false, &cmd, 1);
+}
+
+static void addPixels(uint16_t *pixels, uint32_t n)
+{
+	while (n > 0)
+	{
+		uint32_t chunk = n > REC_MAX_PIXELS ? REC_MAX_PIXELS : n;
+		uint16_t *w = addWords(2);
+		w[0] = REC_DATA;
+		w[1] = chunk * 16 - 1;
+		addBlock(pixels, chunk);
+		pixels += chunk;
+		n -= chunk;
+	}
+}
+
+void ILI9341_pioWritePixels(uint16_t *pixels, uint32_t n)
+{
+	waitChain();
+	resetChain();
+	addPixels(pixels, n);
+	startChain();
+}
+
+// ============================================================
+// Lotes (LCD_*Batch)
+// ============================================================
+
+void LCD_beginBatch()
+{
+	waitChain();
+	resetChain();
+	batchOpen = true;
+}
+
+// Sends what was queued so far and starts over with empty tables
+static void restartBatch()
+{
+	startChain();
+	waitChain();
+	resetChain();
+}
+
+void LCD_batchRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *pixels, uint16_t stride)
+{
+	if (w == 0 || h == 0)
+		return;
+
+	// Window (17 words in one block) plus the first pixel header
+	if (!hasRoom(17 + 2, 3))
+		restartBatch();
+	addWindow(x, y, w, h);
+
+	if (stride == w)
+	{
+		uint32_t total = (uint32_t)w * h;
+		while (total > 0)
+		{
+			uint32_t n = total > REC_MAX_PIXELS ? REC_MAX_PIXELS : total;
+			if (!hasRoom(2, 2))
+				restartBatch();
+			addPixels(pixels, n);
+			pixels += n;
+			total -= n;
+		}
+		return;
+	}
+
+	// Rows of a larger framebuffer: one record per row, all with the same header
+	rowHeader = NULL;
+	for (uint16_t j = 0; j < h; j++)
+	{
+		if (!hasRoom(rowHeader ? 0 : 2, 2))
+		{
+			restartBatch();
+			rowHeader = NULL;
+		}
+		if (rowHeader == NULL)
+		{
+			rowHeader = &words[numWords];
+			numWords += 2;
+			rowHeader[0] = REC_DATA;
+			rowHeader[1] = w * 16 - 1;
+		}
+		addBlock(rowHeader, 2);
+		addBlock(pixels + (uint32_t)j * stride, w);
+	}
+}
+
+void LCD_endBatch()
+{
+	if (!batchOpen)
+		return;
+	batchOpen = false;
+	if (numBlocks > 0)
+		startChain();
+}
+
+void LCD_waitBatch()
+{
+	ILI9341_pioWait();
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef ILI9341_PIO_H
+#define ILI9341_PIO_H
+#include "pico/stdlib.h"
+
+// PIO transport used by ili9341.c when USE_PIO is defined. Commands,
+// parameters and pixels are encoded as records (see ili9341.pio) and pushed
+// into one state machine, either by the CPU or by a chain of DMA transfers.
+
+void ILI9341_pioInit();
+void ILI9341_pioWrite(bool data, const uint8_t *buff, size_t n);
+void ILI9341_pioFill(uint16_t color, uint32_t n);
+
+// Pixel chunks sent by DMA in the background (LCD_writePixels)
+void ILI9341_pioWritePixels(uint16_t *pixels, uint32_t n);
+void ILI9341_pioWait();
+
+#endif
@@ -1,11 +1,75 @@
 #include <SPI.h>
 #include <LoRa.h>
+#include "lora_telemetry.h"
 
 //define the pins used by the transceiver module
 #define ss 5
 #define rst 14
 #define dio0 2
 
+// The Pico node (VL53L0X_RFM95_LORA) sleeps between transmissions and wakes
+// every NODE_WAKE_MS to listen for reports, on inverted I/Q like a LoRaWAN
+// downlink. Reports go out inverted, with a preamble that spans one wake
+// period at SF7/125 kHz (1.024 ms symbols), as lora_wake_preamble_length()
+#define NODE_WAKE_MS 50
+#define SYMBOL_US 1024
+#define WAKE_PREAMBLE ((NODE_WAKE_MS * 1000L + SYMBOL_US - 1) / SYMBOL_US + 8)
+#define DEFAULT_PREAMBLE 8
+
+// print one decoded reading of a binary telemetry packet
+void printReading(lora_sensor type, uint8_t index, int32_t value, void* ctx) {
+  Serial.print("  ");
+  Serial.print(lora_sensor_name(type));
+  Serial.print(" [");
+  Serial.print(index);
+  Serial.print("] ");
+  int scale = lora_sensor_scale(type);
+  if (scale == 1) {
+    Serial.print(value);
+  } else {
+    Serial.print((float)value / scale, scale >= 1000 ? 3 : scale >= 100 ? 2 : 1);
+  }
+  Serial.print(" ");
+  Serial.println(lora_sensor_unit(type));
+}
+
+// sequences received from each node, for duplicates and ACKs
+lora_ack_window windows[256];
+
+// predictive series (lora_series) of each node
+lora_series_rx series[256];
+
+// readings of a series that can't be rebuilt (lost packets)
+void printGap(lora_sensor type, uint8_t missing, void* ctx) {
+  Serial.print("  ");
+  Serial.print(lora_sensor_name(type));
+  Serial.print(": gap of ");
+  Serial.print(missing);
+  Serial.println(" readings");
+}
+
+// send the link report to the node: SNR and RSSI of the packet just
+// received (lora_adr.h) and the ACK of its recent sequences (lora_reliable.h)
+void sendLinkReport(const lora_frame_header& header, float snr, int rssi) {
+  const lora_ack_window& w = windows[header.node];
+  uint8_t report[32];
+  lora_frame frame;
+  lora_frame_begin(&frame, report, sizeof(report), header.node, header.seq, LORA_FLAG_CONTROL);
+  lora_frame_add(&frame, LORA_SENSOR_SNR, (int32_t)lroundf(snr * 4));
+  lora_frame_add(&frame, LORA_SENSOR_RSSI, rssi);
+  lora_frame_add(&frame, LORA_SENSOR_ACK, w.last);
+  lora_frame_add(&frame, LORA_SENSOR_ACK, (int32_t)w.bitmap);
+
+  LoRa.enableInvertIQ();
+  LoRa.setPreambleLength(WAKE_PREAMBLE);
+  LoRa.beginPacket();
+  LoRa.write(report, lora_frame_size(&frame));
+  LoRa.endPacket();
+  // back to normal I/Q and preamble for the uplinks
+  LoRa.setPreambleLength(DEFAULT_PREAMBLE);
+  LoRa.disableInvertIQ();
+}
+
 void setup() {
   //initialize Serial Monitor
   Serial.begin(115200);
@@ -34,17 +98,53 @@ void loop() {
   // try to parse packet
   int packetSize = LoRa.parsePacket();
   if (packetSize) {
-    // received a packet
-    Serial.print("Received packet '");
-
     // read packet
-    while (LoRa.available()) {
-      String LoRaData = LoRa.readString();
-      Serial.print(LoRaData); 
+    uint8_t packet[255];
+    int size = 0;
+    while (LoRa.available() && size < (int)sizeof(packet)) {
+      packet[size++] = LoRa.read();
+    }
+
+    // binary telemetry (lora_telemetry.h) or text from older nodes
+    lora_frame_header header;
+    int readings = lora_frame_decode(packet, size, &header, NULL, NULL);
+    bool duplicate = false;
+    if (readings >= 0 && !(header.flags & LORA_FLAG_CONTROL)) {
+      // retransmission of a packet whose ACK was lost: ACK again, print once
+      duplicate = !lora_ack_track(&windows[header.node], header.seq);
+    }
+    if (readings >= 0) {
+      Serial.print("Node ");
+      Serial.print(header.node);
+      Serial.print(" seq ");
+      Serial.print(header.seq);
+      if (header.flags & LORA_FLAG_ALERT) {
+        Serial.print(" ALERT");
+      }
+      if (duplicate) {
+        Serial.print(" (duplicate)");
+      }
+      Serial.print(": ");
+      Serial.print(readings);
+      Serial.print(" readings in ");
+      Serial.print(size);
+      Serial.print(" bytes");
+    } else {
+      Serial.print("Received packet '");
+      Serial.write(packet, size);
+      Serial.print("'");
     }
 
     // print RSSI of packet
-    Serial.print("' with RSSI ");
+    Serial.print(" with RSSI ");
     Serial.println(LoRa.packetRssi());
+    if (readings > 0 && !duplicate) {
+      lora_frame_decode_series(packet, size, &header, &series[header.node], printReading, printGap, NULL);
+    }
+
+    // answer binary uplinks with a link report (the node wakes to listen for it)
+    if (readings >= 0 && !(header.flags & LORA_FLAG_CONTROL)) {
+      sendLinkReport(header, LoRa.packetSnr(), LoRa.packetRssi());
+    }
   }
 }
\ No newline at end of file
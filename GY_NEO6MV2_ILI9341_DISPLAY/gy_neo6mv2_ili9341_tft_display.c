@@ -8,6 +8,7 @@
 
 #include "ili9341.h" // Para o display
 #include "gfx.h"     // Para as funções gráficas
+#include "gfx_widgets.h" // Campos redesenhados só quando mudam
 
 // --- Configurações da UART para o GPS ---
 #define UART_ID uart0
@@ -51,12 +52,19 @@ int main() {
     gpio_set_function(UART_TX_PIN, GPIO_FUNC_UART);
     gpio_set_function(UART_RX_PIN, GPIO_FUNC_UART);
 
+    // --- Campos da tela (fonte tamanho 2, uma linha a cada 32 px) ---
+    // Cada campo guarda o texto que está na tela e só redesenha os
+    // caracteres que mudaram.
+    GFX_Label lbl_status, lbl_hora, lbl_lat, lbl_lon, lbl_alt;
+    GFX_labelInit(&lbl_status, 0, 10, 26, 2, ILI9341_YELLOW, ILI9341_BLACK);
+    GFX_labelInit(&lbl_hora, 0, 42, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+    GFX_labelInit(&lbl_lat, 0, 74, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+    GFX_labelInit(&lbl_lon, 0, 106, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+    GFX_labelInit(&lbl_alt, 0, 138, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+
     // --- Mensagem inicial no display ---
-    GFX_setCursor(10, 10);
-    GFX_setTextSize(2); // Tamanho da fonte 2
-    GFX_setTextColor(ILI9341_YELLOW);
-    GFX_printf("Aguardando sinal GPS...");
-    GFX_flush(); // Envia o framebuffer para o display
+    GFX_labelSet(&lbl_status, " Aguardando sinal GPS...");
+    GFX_flushDamage(); // Envia só a área alterada para o display
 
     char gps_buffer[120];
     int buffer_index = 0;
@@ -99,29 +107,29 @@ int main() {
                     }
                     
                     // --- ATUALIZAÇÃO DO DISPLAY ---
-                    GFX_fillScreen(ILI9341_BLACK); // Limpa a tela para redesenhar
-                    GFX_setCursor(0, 10);
-                    GFX_setTextSize(2); // Fonte menor para caber tudo
-
+                    // Só os dígitos que mudaram são redesenhados e enviados
                     if (current_gps_data.has_fix) {
                         // Define a cor do texto para verde se tiver sinal
-                        GFX_setTextColor(ILI9341_GREEN);
-                        GFX_printf(" Sinal OK (%d satelites)\n\n", current_gps_data.num_sats);
+                        GFX_labelSetColor(&lbl_status, ILI9341_GREEN, ILI9341_BLACK);
+                        GFX_labelPrintf(&lbl_status, " Sinal OK (%d satelites)", current_gps_data.num_sats);
                         
                         // Mostra os dados formatados
-                        GFX_setTextColor(ILI9341_WHITE);
-                        GFX_printf(" Hora: %02d:%02d:%02d\n\n", current_gps_data.hour, current_gps_data.minute, current_gps_data.second);
-                        GFX_printf(" Lat:  %.5f\n\n", current_gps_data.latitude);
-                        GFX_printf(" Lon:  %.5f\n\n", current_gps_data.longitude);
-                        GFX_printf(" Alt:  %.1f m", current_gps_data.altitude);
+                        GFX_labelPrintf(&lbl_hora, " Hora: %02d:%02d:%02d", current_gps_data.hour, current_gps_data.minute, current_gps_data.second);
+                        GFX_labelPrintf(&lbl_lat, " Lat:  %.5f", current_gps_data.latitude);
+                        GFX_labelPrintf(&lbl_lon, " Lon:  %.5f", current_gps_data.longitude);
+                        GFX_labelPrintf(&lbl_alt, " Alt:  %.1f m", current_gps_data.altitude);
 
                     } else {
                         // Se não tiver sinal, mantém a mensagem de espera
-                        GFX_setTextColor(ILI9341_YELLOW);
-                        GFX_printf(" Aguardando sinal GPS...");
+                        GFX_labelSetColor(&lbl_status, ILI9341_YELLOW, ILI9341_BLACK);
+                        GFX_labelSet(&lbl_status, " Aguardando sinal GPS...");
+                        GFX_labelSet(&lbl_hora, "");
+                        GFX_labelSet(&lbl_lat, "");
+                        GFX_labelSet(&lbl_lon, "");
+                        GFX_labelSet(&lbl_alt, "");
                     }
                     
-                    GFX_flush(); // Envia as atualizações para o display
+                    GFX_flushDamage(); // Envia as atualizações para o display
                 }
 
                 buffer_index = 0; // Reseta o buffer da UART
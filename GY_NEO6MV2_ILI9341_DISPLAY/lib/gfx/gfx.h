@@ -9,10 +9,22 @@
 
 void GFX_createFramebuf();
 void GFX_destroyFramebuf();
+bool GFX_hasFramebuf();
+
+// Unbuffered mode: collect draws and send them as merged windows
+bool GFX_createQueue();
+void GFX_destroyQueue();
+void GFX_flushQueue();
+
+// 4/8 bpp framebuffer (38 KB / 77 KB at 320x240), expanded to RGB565 on flush
+bool GFX_createIndexedFramebuf(uint8_t bpp);
+void GFX_setPalette(const uint16_t *colors, uint16_t n);
 
 void GFX_drawPixel(int16_t x, int16_t y, uint16_t color);
 
 void GFX_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+void GFX_renderChar(uint16_t *buf, uint16_t stride, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+void GFX_clearGlyphCache();
 void GFX_write(uint8_t c);
 void GFX_setCursor(int16_t x, int16_t y);
 void GFX_setTextColor(uint16_t color);
@@ -35,6 +47,10 @@ void GFX_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
 
 void GFX_printf(const char *format, ...);
 void GFX_flush();
+void GFX_flushRows(int16_t y, int16_t h);
+void GFX_flushRect(int16_t x, int16_t y, int16_t w, int16_t h);
+void GFX_addDamage(int16_t x, int16_t y, int16_t w, int16_t h);
+void GFX_flushDamage();
 void GFX_Update();
 void GFX_scrollUp(int n);
 
@@ -0,0 +1,193 @@
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stdlib.h>
+
+#include "gfx.h"
+#include "gfx_chart.h"
+#include "ili9341.h"
+
+bool GFX_chartInit(GFX_Chart *c, int16_t x, int16_t y, int16_t w, int16_t h,
+				   float min, float max, uint16_t samplesPerColumn,
+				   uint16_t color, uint16_t bg, uint16_t grid)
+{
+	c->x = x;
+	c->y = y;
+	c->w = w;
+	c->h = h;
+	c->min = min;
+	c->max = max;
+	c->samplesPerColumn = (samplesPerColumn > 0) ? samplesPerColumn : 1;
+	c->color = color;
+	c->bg = bg;
+	c->grid = grid;
+
+	c->colMin = malloc(w * sizeof(int16_t));
+	c->colMax = malloc(w * sizeof(int16_t));
+	c->colLast = malloc(w * sizeof(int16_t));
+	if (!c->colMin || !c->colMax || !c->colLast)
+	{
+		GFX_chartFree(c);
+		return false;
+	}
+
+	c->written = 0;
+	c->drawn = 0;
+	c->accCount = 0;
+	c->valid = false;
+	return true;
+}
+
+void GFX_chartFree(GFX_Chart *c)
+{
+	free(c->colMin);
+	free(c->colMax);
+	free(c->colLast);
+	c->colMin = c->colMax = c->colLast = NULL;
+}
+
+void GFX_chartInvalidate(GFX_Chart *c)
+{
+	c->valid = false;
+}
+
+// Pixel row inside the chart, 0 at the top
+static int16_t chartRow(GFX_Chart *c, float value)
+{
+	float t = (value - c->min) / (c->max - c->min);
+	if (t < 0)
+		t = 0;
+	if (t > 1)
+		t = 1;
+	return (c->h - 1) - (int16_t)(t * (c->h - 1) + 0.5f);
+}
+
+void GFX_chartPush(GFX_Chart *c, float value)
+{
+	int16_t row = chartRow(c, value);
+
+	if (c->accCount == 0)
+		c->accMin = c->accMax = row;
+	else if (row < c->accMin)
+		c->accMin = row;
+	else if (row > c->accMax)
+		c->accMax = row;
+	c->accLast = row;
+
+	if (++c->accCount < c->samplesPerColumn)
+		return;
+
+	// Bucket complete: store it and publish it to GFX_chartUpdate
+	uint16_t col = c->written % c->w;
+	c->colMin[col] = c->accMin;
+	c->colMax[col] = c->accMax;
+	c->colLast[col] = c->accLast;
+	c->accCount = 0;
+	__dmb(); // Column stores land before the consumer can see the count
+	c->written++;
+}
+
+// Draws one column: background, grid dots at 1/4, 1/2 and 3/4 height, and a
+// vertical span from the bucket min to max, stretched to reach the previous
+// column's last sample so the trace stays connected.
+static void chartDrawColumn(GFX_Chart *c, int16_t px, int16_t top, int16_t bottom,
+							bool blank)
+{
+	static uint16_t colBuf[ILI9341_TFTHEIGHT];
+	bool buffered = GFX_hasFramebuf();
+
+	if (buffered)
+		GFX_fillRect(px, c->y, 1, c->h, c->bg);
+	else
+		for (int16_t j = 0; j < c->h; j++)
+			colBuf[j] = c->bg;
+
+	if (c->grid != c->bg)
+	{
+		for (int q = 1; q < 4; q++)
+		{
+			int16_t j = q * c->h / 4;
+			if (buffered)
+				GFX_drawPixel(px, c->y + j, c->grid);
+			else
+				colBuf[j] = c->grid;
+		}
+	}
+
+	if (!blank)
+	{
+		if (buffered)
+			GFX_fillRect(px, c->y + top, 1, bottom - top + 1, c->color);
+		else
+			for (int16_t j = top; j <= bottom; j++)
+				colBuf[j] = c->color;
+	}
+
+	if (!buffered)
+	{
+		GFX_flushQueue();
+		LCD_WriteBitmap(px, c->y, 1, c->h, colBuf);
+	}
+}
+
+uint16_t GFX_chartUpdate(GFX_Chart *c)
+{
+	uint32_t written = c->written;
+	__dmb(); // Pairs with GFX_chartPush(): columns are read after the count
+	uint32_t first = c->drawn;
+
+	if (!c->valid)
+	{
+		GFX_fillRect(c->x, c->y, c->w, c->h, c->bg);
+		GFX_addDamage(c->x, c->y, c->w, c->h);
+		first = 0;
+		c->valid = true;
+	}
+
+	// Columns that already wrapped out of the ring can't be drawn any more
+	if (written - first > (uint32_t)c->w)
+		first = written - c->w;
+	if (first == written)
+	{
+		c->drawn = written;
+		return 0;
+	}
+
+	// The column before the first one may be gone already (start or wrap)
+	int16_t prev = (first == 0 || written - first == (uint32_t)c->w)
+					   ? c->colMin[first % c->w]
+					   : c->colLast[(first - 1) % c->w];
+	int16_t x0 = c->w, x1 = -1;
+
+	for (uint32_t k = first; k < written; k++)
+	{
+		uint16_t col = k % c->w;
+		int16_t top = c->colMin[col], bottom = c->colMax[col];
+		if (prev < top)
+			top = prev;
+		if (prev > bottom)
+			bottom = prev;
+		prev = c->colLast[col];
+
+		chartDrawColumn(c, c->x + col, top, bottom, false);
+		if (col < x0)
+			x0 = col;
+		if (col > x1)
+			x1 = col;
+	}
+
+	// Blank column ahead of the sweep marks where the newest data is
+	uint16_t gap = written % c->w;
+	chartDrawColumn(c, c->x + gap, 0, 0, true);
+	if (gap < x0)
+		x0 = gap;
+	if (gap > x1)
+		x1 = gap;
+
+	// A batch that wrapped around the right edge touches both ends; one rect
+	// over the whole span is still cheaper than tracking two
+	GFX_addDamage(c->x + x0, c->y, x1 - x0 + 1, c->h);
+
+	uint16_t n = written - first;
+	c->drawn = written;
+	return n;
+}
@@ -0,0 +1,46 @@
+#ifndef gfx_chart_H
+#define gfx_chart_H
+
+#include "pico/stdlib.h"
+
+// Sweep-style strip chart for live sensor data. Samples are folded into
+// per-column min/max buckets (samplesPerColumn samples per pixel column) and
+// kept in a ring of w columns. GFX_chartPush() is O(1) and can run in the
+// acquisition loop or an IRQ; GFX_chartUpdate() draws only the columns
+// completed since the last call, plus one blank column ahead of the sweep,
+// and marks them as damaged for GFX_flushDamage(). Without a framebuffer the
+// columns are sent straight to the panel.
+//
+// Pushing from an IRQ (or the other core) while the main loop updates is
+// safe under two rules. There must be a single producer: the bucket being
+// filled (acc*) is not reentrant, so a chart is pushed from one context
+// only. The producer must not lap the consumer: GFX_chartUpdate() has to
+// run before w more columns complete, or the columns it is reading get
+// overwritten and are drawn torn (until the next sweep redraws them).
+
+typedef struct
+{
+	int16_t x, y, w, h;
+	float min, max;
+	uint16_t color, bg, grid;
+	uint16_t samplesPerColumn;
+
+	int16_t *colMin, *colMax, *colLast; // Ring of w columns, in pixel rows
+	volatile uint32_t written;			// Columns completed, published last
+	uint32_t drawn;						// Columns on screen
+
+	uint16_t accCount; // Bucket being filled
+	int16_t accMin, accMax, accLast;
+	bool valid;
+} GFX_Chart;
+
+bool GFX_chartInit(GFX_Chart *c, int16_t x, int16_t y, int16_t w, int16_t h,
+				   float min, float max, uint16_t samplesPerColumn,
+				   uint16_t color, uint16_t bg, uint16_t grid);
+void GFX_chartFree(GFX_Chart *c);
+
+void GFX_chartPush(GFX_Chart *c, float value);
+uint16_t GFX_chartUpdate(GFX_Chart *c);
+void GFX_chartInvalidate(GFX_Chart *c);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef gfx_console_H
+#define gfx_console_H
+
+#include "pico/stdlib.h"
+
+// Scrolling text console on top of the ILI9341 hardware vertical scroll.
+// New lines are rendered into a one-line buffer and only that line is sent to
+// the panel; older lines are moved by VSCRSADD instead of copying pixels.
+// Hardware scrolling follows the native panel rows, so the console needs
+// rotation 0. The topFixed / bottomFixed rows are left alone and can still be
+// drawn with the regular GFX_* calls and sent with GFX_flushRows().
+
+bool GFX_consoleInit(uint16_t topFixed, uint16_t bottomFixed, uint8_t size);
+void GFX_consoleEnd();
+
+void GFX_consoleSetColor(uint16_t color, uint16_t bg);
+void GFX_consoleClear();
+
+void GFX_consoleWrite(uint8_t c);
+void GFX_consolePrintf(const char *format, ...);
+void GFX_consoleFlush();
+
+#endif
@@ -30,6 +30,62 @@ static bool gfx_dma_init = false;
 uint16_t *gfxFramebuffer = NULL;
 static bool gfxFbUpdated = false;
 
+// Indexed framebuffer: 4 or 8 bits per pixel, expanded through gfxPalette
+// while flushing. In 4 bpp the even pixel is kept in the low nibble.
+#ifndef GFX_BAND_ROWS
+#define GFX_BAND_ROWS 8 // Rows expanded per SPI transfer when flushing
+#endif
+
+static uint8_t *gfxIndexed = NULL;
+static uint8_t gfxBpp = 16;
+static uint16_t gfxPalette[256];
+static uint16_t gfxPaletteSize = 0;
+static uint32_t *gfxPairLut = NULL; // 4 bpp: byte -> two RGB565 pixels
+static uint16_t *gfxBand[2] = {NULL, NULL};
+
+static uint16_t lastColor;
+static uint8_t lastIndex;
+static bool lastValid = false;
+
+#ifndef GFX_MAX_DAMAGE
+#define GFX_MAX_DAMAGE 16
+#endif
+
+typedef struct
+{
+	int16_t x0, y0, x1, y1; // Inclusive corners
+} gfxRect;
+
+static gfxRect damage[GFX_MAX_DAMAGE];
+static uint8_t damageCount = 0;
+static bool damageAll = false;
+
+// Draw queue for unbuffered mode (GFX_createQueue). Pixels are merged into
+// horizontal runs, vertical runs and rectangles, each sent as one window.
+// Runs of different colours keep their pixels in queuePool.
+#ifndef GFX_QUEUE_ENTRIES
+#define GFX_QUEUE_ENTRIES 64
+#endif
+#ifndef GFX_QUEUE_PIXELS
+#define GFX_QUEUE_PIXELS 512
+#endif
+#ifndef GFX_QUEUE_LOOKBACK
+#define GFX_QUEUE_LOOKBACK 8 // Entries queuePixel searches for a run to extend
+#endif
+
+typedef struct
+{
+	int16_t x, y, w, h;
+	uint16_t color;
+	int16_t pixels; // Offset in queuePool, -1 for a solid colour
+} gfxQueued;
+
+static gfxQueued *queue = NULL;
+static uint16_t *queuePool = NULL;
+static uint16_t queueCount = 0;
+static uint16_t poolUsed = 0;
+
+
 extern uint16_t _width;	 ///< Display width as modified by current rotation
 extern uint16_t _height; ///< Display height as modified by current rotation
 
@@ -69,15 +125,287 @@ void GFX_fillScreen(uint16_t color)
 	GFX_fillRect(0, 0, _width, _height, color);
 }
 
+static void updatePairLut(uint8_t first, uint8_t last)
+{
+	if (gfxPairLut == NULL)
+		return;
+	for (int b = 0; b < 256; b++)
+	{
+		uint8_t lo = b & 0x0F, hi = b >> 4;
+		if ((lo >= first && lo <= last) || (hi >= first && hi <= last))
+			gfxPairLut[b] = gfxPalette[lo] | ((uint32_t)gfxPalette[hi] << 16);
+	}
+}
+
+// Maps an RGB565 colour to a palette index. Unknown colours are appended
+// while there is room, otherwise the closest entry is used.
+static uint8_t colorIndex(uint16_t color)
+{
+	if (lastValid && lastColor == color)
+		return lastIndex;
+
+	uint16_t maxSize = 1 << gfxBpp;
+	uint16_t i;
+	for (i = 0; i < gfxPaletteSize; i++)
+		if (gfxPalette[i] == color)
+			break;
+
+	if (i == gfxPaletteSize)
+	{
+		if (gfxPaletteSize < maxSize)
+		{
+			gfxPalette[gfxPaletteSize++] = color;
+			updatePairLut(i, i);
+		}
+		else
+		{
+			uint32_t best = UINT32_MAX;
+			for (uint16_t k = 0; k < gfxPaletteSize; k++)
+			{
+				int32_t dr = ((gfxPalette[k] >> 11) & 0x1F) - ((color >> 11) & 0x1F);
+				int32_t dg = ((gfxPalette[k] >> 5) & 0x3F) - ((color >> 5) & 0x3F);
+				int32_t db = (gfxPalette[k] & 0x1F) - (color & 0x1F);
+				uint32_t d = 4 * dr * dr + dg * dg + 4 * db * db;
+				if (d < best)
+				{
+					best = d;
+					i = k;
+				}
+			}
+		}
+	}
+
+	lastColor = color;
+	lastIndex = i;
+	lastValid = true;
+	return i;
+}
+
+static inline void setIndexedPixel(int16_t x, int16_t y, uint8_t idx)
+{
+	if (gfxBpp == 8)
+		gfxIndexed[y * _width + x] = idx;
+	else
+	{
+		uint8_t *p = gfxIndexed + (y * _width + x) / 2;
+		if (x & 1)
+			*p = (*p & 0x0F) | (idx << 4);
+		else
+			*p = (*p & 0xF0) | idx;
+	}
+}
+
+static void fillIndexedRow(int16_t x, int16_t y, int16_t w, uint8_t idx)
+{
+	if (gfxBpp == 8)
+	{
+		memset(gfxIndexed + y * _width + x, idx, w);
+		return;
+	}
+
+	if (x & 1)
+	{
+		setIndexedPixel(x++, y, idx);
+		w--;
+	}
+	memset(gfxIndexed + (y * _width + x) / 2, idx | (idx << 4), w / 2);
+	if (w & 1)
+		setIndexedPixel(x + w - 1, y, idx);
+}
+
+// Fills a panel window with one colour
+static void lcdFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	uint16_t buf[32];
+	uint32_t n = (uint32_t)w * h;
+
+	for (int i = 0; i < 32; i++)
+		buf[i] = color;
+	LCD_beginPixels(x, y, w, h);
+	while (n > 0)
+	{
+		uint32_t chunk = n > 32 ? 32 : n;
+		LCD_writePixels(buf, chunk);
+		n -= chunk;
+	}
+	LCD_endPixels();
+}
+
+// Stacks the last entry onto the one before when they form a taller rectangle
+static void queueMergeLast()
+{
+	if (queueCount < 2)
+		return;
+	gfxQueued *a = &queue[queueCount - 2], *b = &queue[queueCount - 1];
+	if (a->pixels < 0 && b->pixels < 0 && a->color == b->color &&
+		a->x == b->x && a->w == b->w && a->y + a->h == b->y)
+	{
+		a->h += b->h;
+		queueCount--;
+	}
+}
+
+// Queues an already clipped rectangle
+static void queueFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	if (queueCount > 0)
+	{
+		gfxQueued *q = &queue[queueCount - 1];
+		if (q->pixels < 0 && q->color == color && q->x == x && q->w == w && q->y + q->h == y)
+		{
+			q->h += h;
+			return;
+		}
+	}
+
+	queueMergeLast();
+	if (queueCount == GFX_QUEUE_ENTRIES)
+		GFX_flushQueue();
+	queue[queueCount++] = (gfxQueued){x, y, w, h, color, -1};
+}
+
+// True when an entry from index first on covers (x, y)
+static bool queueCovers(uint16_t first, int16_t x, int16_t y)
+{
+	for (uint16_t i = first; i < queueCount; i++)
+	{
+		gfxQueued *q = &queue[i];
+		if (x >= q->x && x < q->x + q->w && y >= q->y && y < q->y + q->h)
+			return true;
+	}
+	return false;
+}
+
+static void queuePixel(int16_t x, int16_t y, uint16_t color)
+{
+	if (queueCount > 0)
+	{
+		gfxQueued *q = &queue[queueCount - 1];
+		if (q->h == 1 && q->y == y && q->x + q->w == x)
+		{
+			// Grow the run on the right
+			if (q->pixels < 0 && q->color == color)
+			{
+				q->w++;
+				return;
+			}
+			if (q->pixels >= 0 && q->pixels + q->w == poolUsed && poolUsed < GFX_QUEUE_PIXELS)
+			{
+				queuePool[poolUsed++] = color;
+				q->w++;
+				return;
+			}
+			// A short solid run is cheaper to extend with pixels than a new window
+			if (q->pixels < 0 && q->w <= 4 && poolUsed + q->w + 1 <= GFX_QUEUE_PIXELS)
+			{
+				q->pixels = poolUsed;
+				for (int16_t i = 0; i < q->w; i++)
+					queuePool[poolUsed++] = q->color;
+				queuePool[poolUsed++] = color;
+				q->w++;
+				return;
+			}
+		}
+	}
+
+	// Shapes like circles interleave several runs: look a few entries back for
+	// a solid run this pixel continues, unless a later entry overlaps it
+	int stop = queueCount > GFX_QUEUE_LOOKBACK ? queueCount - GFX_QUEUE_LOOKBACK : 0;
+	for (int i = queueCount - 2; i >= stop; i--)
+	{
+		gfxQueued *q = &queue[i];
+		if (q->pixels >= 0 || q->color != color)
+			continue;
+		bool right = q->h == 1 && q->y == y && (q->x + q->w == x || q->x == x + 1);
+		bool below = q->w == 1 && q->x == x && (q->y + q->h == y || q->y == y + 1);
+		if ((right || below) && !queueCovers(i + 1, x, y))
+		{
+			if (right)
+			{
+				if (q->x == x + 1)
+					q->x = x;
+				q->w++;
+			}
+			else
+			{
+				if (q->y == y + 1)
+					q->y = y;
+				q->h++;
+			}
+			return;
+		}
+	}
+	queueFill(x, y, 1, 1, color);
+}
+
+// Allocates the draw queue. Until GFX_destroyQueue, drawing without a
+// framebuffer is collected and reaches the panel on GFX_flush() (or when
+// the queue fills up).
+bool GFX_createQueue()
+{
+	if (queue != NULL)
+		return true;
+	queue = malloc(GFX_QUEUE_ENTRIES * sizeof(gfxQueued));
+	queuePool = malloc(GFX_QUEUE_PIXELS * sizeof(uint16_t));
+	if (queue == NULL || queuePool == NULL)
+	{
+		free(queue);
+		free(queuePool);
+		queue = NULL;
+		queuePool = NULL;
+		return false;
+	}
+	queueCount = poolUsed = 0;
+	return true;
+}
+
+void GFX_destroyQueue()
+{
+	GFX_flushQueue();
+	free(queue);
+	free(queuePool);
+	queue = NULL;
+	queuePool = NULL;
+}
+
+// Sends the queued draws, one window each
+void GFX_flushQueue()
+{
+	if (queue == NULL)
+		return;
+	for (uint16_t i = 0; i < queueCount; i++)
+	{
+		gfxQueued *q = &queue[i];
+		if (q->pixels >= 0)
+			LCD_WriteBitmap(q->x, q->y, q->w, 1, queuePool + q->pixels);
+		else
+			lcdFill(q->x, q->y, q->w, q->h, q->color);
+	}
+	queueCount = poolUsed = 0;
+}
+
 void GFX_drawPixel(int16_t x, int16_t y, uint16_t color)
 {
-	if (gfxFramebuffer != NULL)
+	if (gfxIndexed != NULL)
+	{
+		if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+			return;
+		setIndexedPixel(x, y, colorIndex(color));
+		gfxFbUpdated = true;
+	}
+	else if (gfxFramebuffer != NULL)
 	{
 		if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
 			return;
 		gfxFramebuffer[x + y * _width] = color; //(color >> 8) | (color << 8);
 		gfxFbUpdated = true;
 	}
+	else if (queue != NULL)
+	{
+		if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+			return;
+		queuePixel(x, y, color);
+	}
 	else
 		LCD_WritePixel(x, y, color);
 }
@@ -135,20 +463,66 @@ void GFX_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color
 
 void GFX_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 {
-	GFX_drawLine(x, y, x, y + h - 1, color);
+	if (h > 0)
+		GFX_fillRect(x, y, 1, h, color);
+	else
+		GFX_drawLine(x, y, x, y + h - 1, color);
 }
 
 void GFX_drawFastHLine(int16_t x, int16_t y, int16_t l, uint16_t color)
 {
-	GFX_drawLine(x, y, x + l - 1, y, color);
+	if (l > 0)
+		GFX_fillRect(x, y, l, 1, color);
+	else
+		GFX_drawLine(x, y, x + l - 1, y, color);
 }
 
 void GFX_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
-	for (int16_t i = x; i < x + w; i++)
+	if (x < 0)
+	{
+		w += x;
+		x = 0;
+	}
+	if (y < 0)
+	{
+		h += y;
+		y = 0;
+	}
+	if (x + w > _width)
+		w = _width - x;
+	if (y + h > _height)
+		h = _height - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (gfxIndexed != NULL)
 	{
-		GFX_drawFastVLine(i, y, h, color);
+		// Fill the framebuffer rows directly
+		uint8_t idx = colorIndex(color);
+		for (int16_t j = 0; j < h; j++)
+			fillIndexedRow(x, y + j, w, idx);
+		gfxFbUpdated = true;
 	}
+	else if (gfxFramebuffer != NULL)
+	{
+		for (int16_t j = 0; j < h; j++)
+		{
+			uint16_t *p = gfxFramebuffer + (y + j) * _width + x;
+			for (int16_t i = 0; i < w; i++)
+				p[i] = color;
+		}
+		gfxFbUpdated = true;
+	}
+	else if (queue != NULL)
+	{
+		// Whatever is still queued would be painted over anyway
+		if (w == _width && h == _height)
+			queueCount = poolUsed = 0;
+		queueFill(x, y, w, h, color);
+	}
+	else
+		lcdFill(x, y, w, h, color);
 }
 
 void GFX_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
@@ -159,6 +533,137 @@ void GFX_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 	GFX_drawFastVLine(x + w - 1, y, h, color);
 }
 
+// Expands a classic-font glyph into an RGB565 block of (6 * size_x) x
+// (8 * size_y) pixels. stride is the row pitch of buf in pixels.
+void GFX_renderChar(uint16_t *buf, uint16_t stride, unsigned char c,
+					uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y)
+{
+	if (c >= 176)
+		c++; // Handle 'classic' charset behavior
+
+	for (int8_t i = 0; i < 6; i++)
+	{
+		uint8_t line = (i < 5) ? font[c * 5 + i] : 0;
+		for (int8_t j = 0; j < 8; j++, line >>= 1)
+		{
+			uint16_t px = (line & 1) ? color : bg;
+			uint16_t *p = buf + (j * size_y) * stride + i * size_x;
+			for (uint8_t sy = 0; sy < size_y; sy++, p += stride)
+				for (uint8_t sx = 0; sx < size_x; sx++)
+					p[sx] = px;
+		}
+	}
+}
+
+#ifndef GFX_GLYPH_CACHE_SLOTS
+#define GFX_GLYPH_CACHE_SLOTS 8
+#endif
+#ifndef GFX_GLYPH_CACHE_MAX_SIZE
+#define GFX_GLYPH_CACHE_MAX_SIZE 4 // Largest text size kept in the cache
+#endif
+
+#define GLYPH_SLOT_PIXELS (6 * 8 * GFX_GLYPH_CACHE_MAX_SIZE * GFX_GLYPH_CACHE_MAX_SIZE)
+
+typedef struct
+{
+	uint16_t color, bg;
+	uint8_t c, size_x, size_y;
+	bool valid;
+	uint32_t lastUse;
+} glyphSlot;
+
+static glyphSlot glyphSlots[GFX_GLYPH_CACHE_SLOTS];
+static uint16_t *glyphPool = NULL; // Allocated on first scaled opaque glyph
+static uint32_t glyphTick = 0;
+
+void GFX_clearGlyphCache()
+{
+	free(glyphPool);
+	glyphPool = NULL;
+	for (int i = 0; i < GFX_GLYPH_CACHE_SLOTS; i++)
+		glyphSlots[i].valid = false;
+}
+
+// Returns the pre-rasterized block for the glyph, expanding it into the least
+// recently used slot on a miss.
+static uint16_t *glyphLookup(unsigned char c, uint16_t color, uint16_t bg,
+							 uint8_t size_x, uint8_t size_y)
+{
+	if (glyphPool == NULL)
+	{
+		glyphPool = malloc(GFX_GLYPH_CACHE_SLOTS * GLYPH_SLOT_PIXELS * sizeof(uint16_t));
+		if (glyphPool == NULL)
+			return NULL;
+	}
+
+	int victim = 0;
+	for (int i = 0; i < GFX_GLYPH_CACHE_SLOTS; i++)
+	{
+		glyphSlot *s = &glyphSlots[i];
+		if (s->valid && s->c == c && s->color == color && s->bg == bg &&
+			s->size_x == size_x && s->size_y == size_y)
+		{
+			s->lastUse = ++glyphTick;
+			return glyphPool + i * GLYPH_SLOT_PIXELS;
+		}
+		if (!s->valid)
+			victim = i;
+		else if (glyphSlots[victim].valid && s->lastUse < glyphSlots[victim].lastUse)
+			victim = i;
+	}
+
+	glyphSlot *s = &glyphSlots[victim];
+	uint16_t *block = glyphPool + victim * GLYPH_SLOT_PIXELS;
+	GFX_renderChar(block, 6 * size_x, c, color, bg, size_x, size_y);
+	s->c = c;
+	s->color = color;
+	s->bg = bg;
+	s->size_x = size_x;
+	s->size_y = size_y;
+	s->valid = true;
+	s->lastUse = ++glyphTick;
+	return block;
+}
+
+// Blits a scaled opaque classic glyph from the cache. Returns false when the
+// glyph can't be cached and has to be drawn the slow way.
+static bool drawCachedChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+						   uint16_t bg, uint8_t size_x, uint8_t size_y)
+{
+	if (size_x > GFX_GLYPH_CACHE_MAX_SIZE || size_y > GFX_GLYPH_CACHE_MAX_SIZE)
+		return false;
+	if (gfxIndexed != NULL)
+		return false; // GFX_fillRect is already a plain memset there
+
+	int16_t w = 6 * size_x, h = 8 * size_y;
+	bool inside = x >= 0 && y >= 0 && x + w <= _width && y + h <= _height;
+
+	if (gfxFramebuffer == NULL && !inside)
+		return false; // The panel can't clip a window write
+
+	uint16_t *block = glyphLookup(c, color, bg, size_x, size_y);
+	if (block == NULL)
+		return false;
+
+	if (gfxFramebuffer == NULL)
+	{
+		GFX_flushQueue(); // Keep the drawing order
+		LCD_WriteBitmap(x, y, w, h, block);
+		return true;
+	}
+
+	int16_t x0 = (x < 0) ? -x : 0;
+	int16_t y0 = (y < 0) ? -y : 0;
+	int16_t x1 = (x + w > _width) ? _width - x : w;
+	int16_t y1 = (y + h > _height) ? _height - y : h;
+
+	for (int16_t j = y0; j < y1; j++)
+		memcpy(gfxFramebuffer + (y + j) * _width + x + x0, block + j * w + x0,
+			   (x1 - x0) * sizeof(uint16_t));
+	gfxFbUpdated = true;
+	return true;
+}
+
 void GFX_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
 				  uint16_t bg, uint8_t size_x, uint8_t size_y)
 {
@@ -170,6 +675,10 @@ void GFX_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
 			((y + 8 * size_y - 1) < 0))	  // Clip top
 			return;
 
+		if ((size_x > 1 || size_y > 1) && bg != color &&
+			drawCachedChar(x, y, c, color, bg, size_x, size_y))
+			return;
+
 		if (c >= 176)
 			c++; // Handle 'classic' charset behavior
 
@@ -451,25 +960,274 @@ void GFX_printf(const char *format, ...)
 	va_end(args);
 }
 
+bool GFX_hasFramebuf()
+{
+	return gfxFramebuffer != NULL || gfxIndexed != NULL;
+}
+
 void GFX_createFramebuf()
 {
+	GFX_destroyFramebuf();
 	gfxFramebuffer = malloc(_width * _height * sizeof(uint16_t));
 }
+
+// bpp is 4 or 8. The palette starts with the ILI9341_* colours; other
+// colours are added as they are drawn, up to 16 or 256 entries.
+bool GFX_createIndexedFramebuf(uint8_t bpp)
+{
+	if (bpp != 4 && bpp != 8)
+		return false;
+
+	GFX_destroyFramebuf();
+	gfxIndexed = calloc((uint32_t)_width * _height * bpp / 8, 1);
+	gfxBand[0] = malloc(_width * GFX_BAND_ROWS * sizeof(uint16_t));
+	gfxBand[1] = malloc(_width * GFX_BAND_ROWS * sizeof(uint16_t));
+	if (bpp == 4)
+		gfxPairLut = malloc(256 * sizeof(uint32_t));
+
+	if (!gfxIndexed || !gfxBand[0] || !gfxBand[1] || (bpp == 4 && !gfxPairLut))
+	{
+		GFX_destroyFramebuf();
+		return false;
+	}
+
+	static const uint16_t defaultPalette[] = {
+		ILI9341_BLACK, ILI9341_WHITE, ILI9341_RED, ILI9341_GREEN, ILI9341_BLUE,
+		ILI9341_CYAN, ILI9341_MAGENTA, ILI9341_YELLOW, ILI9341_ORANGE};
+
+	gfxBpp = bpp;
+	GFX_setPalette(defaultPalette, sizeof(defaultPalette) / sizeof(defaultPalette[0]));
+	return true;
+}
+
+// Replaces the palette. Pixels already drawn keep their index, so this can
+// also be used to recolour the whole screen without redrawing it.
+void GFX_setPalette(const uint16_t *colors, uint16_t n)
+{
+	uint16_t maxSize = 1 << gfxBpp;
+	if (gfxBpp == 16)
+		return;
+	if (n > maxSize)
+		n = maxSize;
+
+	memcpy(gfxPalette, colors, n * sizeof(uint16_t));
+	for (uint16_t i = n; i < maxSize; i++)
+		gfxPalette[i] = 0;
+	gfxPaletteSize = n;
+	lastValid = false;
+	updatePairLut(0, 15);
+	gfxFbUpdated = true;
+}
+
 void GFX_destroyFramebuf()
 {
+	GFX_flushQueue(); // Draws queued so far belong on the panel
 	free(gfxFramebuffer);
 	gfxFramebuffer = NULL;
+
+	free(gfxIndexed);
+	free(gfxPairLut);
+	free(gfxBand[0]);
+	free(gfxBand[1]);
+	gfxIndexed = NULL;
+	gfxPairLut = NULL;
+	gfxBand[0] = gfxBand[1] = NULL;
+	gfxBpp = 16;
+	lastValid = false;
+}
+
+// Expands w indexed pixels of row y, starting at x, into RGB565
+static void expandSpan(uint16_t *dst, int16_t x, int16_t y, int16_t w)
+{
+	if (gfxBpp == 8)
+	{
+		const uint8_t *src = gfxIndexed + y * _width + x;
+		for (int16_t i = 0; i < w; i++)
+			dst[i] = gfxPalette[src[i]];
+	}
+	else if (!(x & 1) && !(w & 1))
+	{
+		// Whole bytes: one LUT lookup per pixel pair
+		const uint8_t *src = gfxIndexed + (y * _width + x) / 2;
+		uint32_t *d = (uint32_t *)dst;
+		for (int16_t i = 0; i < w / 2; i++)
+			d[i] = gfxPairLut[src[i]];
+	}
+	else
+	{
+		const uint8_t *row = gfxIndexed + y * _width / 2;
+		for (int16_t i = 0; i < w; i++)
+		{
+			uint8_t b = row[(x + i) / 2];
+			dst[i] = gfxPalette[((x + i) & 1) ? b >> 4 : b & 0x0F];
+		}
+	}
+}
+
+// Expands the indexed rect band by band into two RGB565 buffers, so one band
+// is converted while the previous one is still being sent.
+static void flushIndexed(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	int16_t bandRows = (_width * GFX_BAND_ROWS) / w;
+	int band = 0;
+
+	LCD_beginPixels(x, y, w, h);
+	while (h > 0)
+	{
+		int16_t n = (h > bandRows) ? bandRows : h;
+		for (int16_t j = 0; j < n; j++)
+			expandSpan(gfxBand[band] + j * w, x, y + j, w);
+		LCD_writePixels(gfxBand[band], (uint32_t)w * n);
+		band ^= 1;
+		y += n;
+		h -= n;
+	}
+	LCD_endPixels();
 }
 
 void GFX_flush()
 {
-	if (gfxFramebuffer != NULL)
+	damageCount = 0;
+	damageAll = false;
+	GFX_flushQueue();
+
+	if (gfxIndexed != NULL)
+	{
+		flushIndexed(0, 0, _width, _height);
+		gfxFbUpdated = false;
+	}
+	else if (gfxFramebuffer != NULL)
 	{
 		LCD_WriteBitmap(0, 0, _width, _height, gfxFramebuffer);
 		gfxFbUpdated = false;
 	}
 }
 
+// Sends only rows [y, y + h) of the framebuffer to the display
+void GFX_flushRows(int16_t y, int16_t h)
+{
+	if (gfxFramebuffer == NULL && gfxIndexed == NULL)
+		return;
+	if (y < 0)
+	{
+		h += y;
+		y = 0;
+	}
+	if (y + h > _height)
+		h = _height - y;
+	if (h <= 0)
+		return;
+
+	if (gfxIndexed != NULL)
+		flushIndexed(0, y, _width, h);
+	else
+		LCD_WriteBitmap(0, y, _width, h, gfxFramebuffer + y * _width);
+}
+
+// Clips a framebuffer rectangle and queues it on the current LCD batch.
+// Indexed framebuffers are expanded and sent right away, outside any batch.
+static void queueRect(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (x < 0)
+	{
+		w += x;
+		x = 0;
+	}
+	if (y < 0)
+	{
+		h += y;
+		y = 0;
+	}
+	if (x + w > _width)
+		w = _width - x;
+	if (y + h > _height)
+		h = _height - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (gfxIndexed != NULL)
+	{
+		flushIndexed(x, y, w, h);
+		return;
+	}
+
+	LCD_batchRect(x, y, w, h, gfxFramebuffer + y * _width + x, _width);
+}
+
+// Sends a rectangle of the framebuffer as one window write
+void GFX_flushRect(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (gfxIndexed != NULL)
+		queueRect(x, y, w, h);
+	if (gfxFramebuffer == NULL)
+		return;
+
+	LCD_beginBatch();
+	queueRect(x, y, w, h);
+	LCD_endBatch();
+	LCD_waitBatch();
+}
+
+// Marks a framebuffer area as changed. Touching or overlapping areas are
+// merged; when the list is full the next GFX_flushDamage sends everything.
+void GFX_addDamage(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if ((gfxFramebuffer == NULL && gfxIndexed == NULL) || damageAll)
+		return;
+	if (w <= 0 || h <= 0)
+		return;
+
+	gfxRect r = {x, y, x + w - 1, y + h - 1};
+	for (uint8_t i = 0; i < damageCount; i++)
+	{
+		gfxRect *d = &damage[i];
+		if (r.x0 <= d->x1 + 1 && r.x1 >= d->x0 - 1 &&
+			r.y0 <= d->y1 + 1 && r.y1 >= d->y0 - 1)
+		{
+			if (r.x0 < d->x0)
+				d->x0 = r.x0;
+			if (r.y0 < d->y0)
+				d->y0 = r.y0;
+			if (r.x1 > d->x1)
+				d->x1 = r.x1;
+			if (r.y1 > d->y1)
+				d->y1 = r.y1;
+			return;
+		}
+	}
+
+	if (damageCount == GFX_MAX_DAMAGE)
+		damageAll = true;
+	else
+		damage[damageCount++] = r;
+}
+
+void GFX_flushDamage()
+{
+	if (damageAll)
+		GFX_flush();
+	else if (gfxIndexed != NULL)
+	{
+		for (uint8_t i = 0; i < damageCount; i++)
+			queueRect(damage[i].x0, damage[i].y0,
+					  damage[i].x1 - damage[i].x0 + 1,
+					  damage[i].y1 - damage[i].y0 + 1);
+	}
+	else if (gfxFramebuffer != NULL && damageCount > 0)
+	{
+		// All rects go out as one batch (a single DMA chain with USE_PIO)
+		LCD_beginBatch();
+		for (uint8_t i = 0; i < damageCount; i++)
+			queueRect(damage[i].x0, damage[i].y0,
+					  damage[i].x1 - damage[i].x0 + 1,
+					  damage[i].y1 - damage[i].y0 + 1);
+		LCD_endBatch();
+		LCD_waitBatch();
+	}
+	damageCount = 0;
+	damageAll = false;
+}
+
 void GFX_Update()
 {
 	if(gfxFbUpdated)
@@ -547,6 +1305,17 @@ void GFX_scrollUp(int n)
 		dma_memset(gfxFramebuffer+linesCopy, 0, 2* linesFill);
 
 	}
+	else if (gfxIndexed)
+	{
+		if(n > _height)
+			n = _height;
+		size_t rowBytes = _width * gfxBpp / 8;
+		size_t bytesCopy = rowBytes * (_height - n);
+
+		dma_memcpy(gfxIndexed, gfxIndexed + rowBytes * n, bytesCopy);
+		dma_memset(gfxIndexed + bytesCopy, 0, rowBytes * n);
+		gfxFbUpdated = true;
+	}
 }
 
 void GFX_setTextSize(uint8_t size)
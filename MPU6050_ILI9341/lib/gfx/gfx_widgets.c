@@ -0,0 +1,286 @@
+#include "pico/stdlib.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "gfx.h"
+#include "gfx_widgets.h"
+
+// --- Label -------------------------------------------------------------------
+
+void GFX_labelInit(GFX_Label *l, int16_t x, int16_t y, uint8_t width, uint8_t size,
+				   uint16_t color, uint16_t bg)
+{
+	l->x = x;
+	l->y = y;
+	l->width = (width > GFX_LABEL_MAX) ? GFX_LABEL_MAX : width;
+	l->size = (size > 0) ? size : 1;
+	l->color = color;
+	l->bg = bg;
+	l->len = 0;
+	l->valid = false;
+}
+
+void GFX_labelSetColor(GFX_Label *l, uint16_t color, uint16_t bg)
+{
+	if (l->color == color && l->bg == bg)
+		return;
+	l->color = color;
+	l->bg = bg;
+	l->valid = false;
+}
+
+void GFX_labelInvalidate(GFX_Label *l)
+{
+	l->valid = false;
+}
+
+bool GFX_labelSet(GFX_Label *l, const char *text)
+{
+	uint8_t n = strnlen(text, GFX_LABEL_MAX);
+	if (l->width && n > l->width)
+		n = l->width;
+
+	// Cells past the new text are blanked until the old text is gone or the
+	// field width is reached
+	uint8_t cells = n;
+	if (l->width)
+		cells = l->width;
+	else if (l->valid && l->len > cells)
+		cells = l->len;
+
+	int16_t first = -1, last = -1;
+	for (uint8_t i = 0; i < cells; i++)
+	{
+		char c = (i < n) ? text[i] : ' ';
+		if (l->valid && i < l->len && l->cells[i] == c)
+			continue;
+
+		GFX_drawChar(l->x + i * 6 * l->size, l->y, c, l->color, l->bg,
+					 l->size, l->size);
+		l->cells[i] = c;
+		if (first < 0)
+			first = i;
+		last = i;
+	}
+
+	if (cells > l->len || !l->valid)
+		l->len = cells;
+	l->valid = true;
+
+	if (first < 0)
+		return false;
+
+	GFX_addDamage(l->x + first * 6 * l->size, l->y,
+				  (last - first + 1) * 6 * l->size, 8 * l->size);
+	return true;
+}
+
+bool GFX_labelPrintf(GFX_Label *l, const char *format, ...)
+{
+	char buf[GFX_LABEL_MAX + 1];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+	return GFX_labelSet(l, buf);
+}
+
+// --- Value -------------------------------------------------------------------
+
+void GFX_valueInit(GFX_Value *v, int16_t x, int16_t y, uint8_t width, uint8_t size,
+				   uint16_t color, uint16_t bg, const char *format)
+{
+	GFX_labelInit(&v->label, x, y, width, size, color, bg);
+	v->format = format;
+	v->value = 0;
+}
+
+bool GFX_valueSet(GFX_Value *v, float value)
+{
+	if (v->label.valid && value == v->value)
+		return false;
+	v->value = value;
+	// Values that differ only past the shown precision leave the text as is
+	return GFX_labelPrintf(&v->label, v->format, value);
+}
+
+void GFX_valueInvalidate(GFX_Value *v)
+{
+	GFX_labelInvalidate(&v->label);
+}
+
+// --- Bar ---------------------------------------------------------------------
+
+void GFX_barInit(GFX_Bar *b, int16_t x, int16_t y, int16_t w, int16_t h,
+				 float min, float max, uint16_t color, uint16_t bg, uint16_t border)
+{
+	b->x = x;
+	b->y = y;
+	b->w = w;
+	b->h = h;
+	b->min = min;
+	b->max = max;
+	b->color = color;
+	b->bg = bg;
+	b->border = border;
+	b->fill = 0;
+	b->valid = false;
+}
+
+void GFX_barInvalidate(GFX_Bar *b)
+{
+	b->valid = false;
+}
+
+bool GFX_barSet(GFX_Bar *b, float value)
+{
+	int16_t inner = b->w - 2;
+	float t = (value - b->min) / (b->max - b->min);
+	if (t < 0)
+		t = 0;
+	if (t > 1)
+		t = 1;
+	int16_t fill = (int16_t)(t * inner + 0.5f);
+
+	if (!b->valid)
+	{
+		GFX_drawRect(b->x, b->y, b->w, b->h, b->border);
+		GFX_fillRect(b->x + 1, b->y + 1, fill, b->h - 2, b->color);
+		GFX_fillRect(b->x + 1 + fill, b->y + 1, inner - fill, b->h - 2, b->bg);
+		GFX_addDamage(b->x, b->y, b->w, b->h);
+		b->fill = fill;
+		b->valid = true;
+		return true;
+	}
+
+	if (fill == b->fill)
+		return false;
+
+	// Only the strip between the old and the new end changes
+	int16_t x0 = (fill < b->fill) ? fill : b->fill;
+	int16_t x1 = (fill < b->fill) ? b->fill : fill;
+	GFX_fillRect(b->x + 1 + x0, b->y + 1, x1 - x0, b->h - 2,
+				 (fill > b->fill) ? b->color : b->bg);
+	GFX_addDamage(b->x + 1 + x0, b->y + 1, x1 - x0, b->h - 2);
+	b->fill = fill;
+	return true;
+}
+
+// --- Gauge -------------------------------------------------------------------
+
+void GFX_gaugeInit(GFX_Gauge *g, int16_t cx, int16_t cy, int16_t r, float min, float max,
+				   uint16_t dial, uint16_t needle, uint16_t bg)
+{
+	g->cx = cx;
+	g->cy = cy;
+	g->r = r;
+	g->min = min;
+	g->max = max;
+	g->dial = dial;
+	g->needle = needle;
+	g->bg = bg;
+	g->valid = false;
+}
+
+void GFX_gaugeInvalidate(GFX_Gauge *g)
+{
+	g->valid = false;
+}
+
+static void gaugeDrawDial(GFX_Gauge *g)
+{
+	GFX_fillRect(g->cx - g->r, g->cy - g->r, 2 * g->r + 1, g->r + 1, g->bg);
+
+	int16_t steps = 4 * g->r;
+	for (int16_t i = 0; i <= steps; i++)
+	{
+		float a = (float)M_PI * i / steps;
+		GFX_drawPixel(g->cx + (int16_t)lroundf(g->r * cosf(a)),
+					  g->cy - (int16_t)lroundf(g->r * sinf(a)), g->dial);
+	}
+
+	// Ticks at 0, 25, 50, 75 and 100 %
+	for (int i = 0; i <= 4; i++)
+	{
+		float a = (float)M_PI * i / 4;
+		float c = cosf(a), s = sinf(a);
+		GFX_drawLine(g->cx + (int16_t)lroundf((g->r - 4) * c), g->cy - (int16_t)lroundf((g->r - 4) * s),
+					 g->cx + (int16_t)lroundf(g->r * c), g->cy - (int16_t)lroundf(g->r * s), g->dial);
+	}
+}
+
+bool GFX_gaugeSet(GFX_Gauge *g, float value)
+{
+	float t = (value - g->min) / (g->max - g->min);
+	if (t < 0)
+		t = 0;
+	if (t > 1)
+		t = 1;
+
+	float a = (float)M_PI * (1.0f - t);
+	int16_t len = g->r - 6;
+	int16_t nx = g->cx + (int16_t)lroundf(len * cosf(a));
+	int16_t ny = g->cy - (int16_t)lroundf(len * sinf(a));
+
+	if (!g->valid)
+	{
+		gaugeDrawDial(g);
+		GFX_addDamage(g->cx - g->r, g->cy - g->r, 2 * g->r + 1, g->r + 1);
+	}
+	else if (nx == g->nx && ny == g->ny)
+		return false;
+	else
+	{
+		GFX_drawLine(g->cx, g->cy, g->nx, g->ny, g->bg);
+		int16_t x0 = (g->nx < g->cx) ? g->nx : g->cx;
+		int16_t x1 = (g->nx > g->cx) ? g->nx : g->cx;
+		GFX_addDamage(x0, g->ny, x1 - x0 + 1, g->cy - g->ny + 1);
+	}
+
+	GFX_drawLine(g->cx, g->cy, nx, ny, g->needle);
+	int16_t x0 = (nx < g->cx) ? nx : g->cx;
+	int16_t x1 = (nx > g->cx) ? nx : g->cx;
+	GFX_addDamage(x0, ny, x1 - x0 + 1, g->cy - ny + 1);
+
+	g->nx = nx;
+	g->ny = ny;
+	g->valid = true;
+	return true;
+}
+
+// --- Status icon -------------------------------------------------------------
+
+void GFX_statusInit(GFX_StatusIcon *s, int16_t x, int16_t y, int16_t r,
+					const uint16_t *colors, uint8_t numStates)
+{
+	s->x = x;
+	s->y = y;
+	s->r = r;
+	s->colors = colors;
+	s->numStates = numStates;
+	s->state = 0;
+	s->valid = false;
+}
+
+void GFX_statusInvalidate(GFX_StatusIcon *s)
+{
+	s->valid = false;
+}
+
+bool GFX_statusSet(GFX_StatusIcon *s, uint8_t state)
+{
+	if (s->numStates == 0)
+		return false; // No colors to draw with
+	if (state >= s->numStates)
+		state = s->numStates - 1;
+	if (s->valid && state == s->state)
+		return false;
+
+	GFX_fillCircle(s->x, s->y, s->r, s->colors[state]);
+	GFX_addDamage(s->x - s->r, s->y - s->r, 2 * s->r + 1, 2 * s->r + 1);
+	s->state = state;
+	s->valid = true;
+	return true;
+}
@@ -6,6 +6,8 @@
 #include "pico/binary_info.h"
 #include "ili9341.h"
 #include "gfx.h"
+#include "gfx_widgets.h"
+#include "gfx_chart.h"
 
 #define ANGULO_ALERTA 45.0f
 
@@ -59,6 +61,23 @@ int main() {
 
     int16_t acceleration_raw[3];
 
+    // --- Campos da tela ---
+    // Os valores só são redesenhados quando o texto formatado muda; a tela
+    // inteira só é redesenhada na troca entre estado normal e alerta.
+    GFX_Value val_acc_x, val_acc_y, val_acc_z, val_angulo, val_angulo_alerta;
+    GFX_valueInit(&val_acc_x, 0, 20, 14, 3, ILI9341_WHITE, ILI9341_BLACK, "Acc X: %.2f g");
+    GFX_valueInit(&val_acc_y, 0, 44, 14, 3, ILI9341_WHITE, ILI9341_BLACK, "Acc Y: %.2f g");
+    GFX_valueInit(&val_acc_z, 0, 68, 14, 3, ILI9341_WHITE, ILI9341_BLACK, "Acc Z: %.2f g");
+    GFX_valueInit(&val_angulo, 0, 116, 15, 3, ILI9341_WHITE, ILI9341_BLACK, "Angulo: %.1f\xF7");
+    GFX_valueInit(&val_angulo_alerta, 0, 122, 18, 2, ILI9341_WHITE, ILI9341_RED, "  Angulo: %.1f\xF7"); // 0xF7 (247) é o caractere de grau (°)
+    int estado_anterior = -1; // 0 = normal, 1 = alerta, -1 = tela ainda não desenhada
+
+    // Gráfico do ângulo (-90° a 90°) na parte de baixo da tela, uma amostra
+    // por coluna; só as colunas novas são desenhadas a cada ciclo
+    GFX_Chart grafico_angulo;
+    GFX_chartInit(&grafico_angulo, 0, 150, 320, 86, -90.0f, 90.0f, 1,
+                  ILI9341_CYAN, ILI9341_BLACK, GFX_RGB565(60, 60, 60));
+
     while (true) {
         // 1. Ler e converter dados do acelerômetro
         mpu6050_read_raw(acceleration_raw);
@@ -71,31 +90,47 @@ int main() {
 
         // 3. Lógica de Alerta Visual
         // A função fabs() calcula o valor absoluto (ignora se o ângulo é positivo ou negativo)
-        if (fabs(roll_angle) > ANGULO_ALERTA) {
-            // --- ESTADO DE ALERTA ---
-            GFX_setClearColor(ILI9341_RED);
+        int estado = fabs(roll_angle) > ANGULO_ALERTA;
+        if (estado != estado_anterior) {
+            // Troca de estado: redesenha o fundo e força os campos a redesenhar
+            GFX_setClearColor(estado ? ILI9341_RED : ILI9341_BLACK);
             GFX_clearScreen();
-            GFX_setCursor(20, 50);
-            GFX_setTextSize(3);
-            GFX_setTextColor(ILI9341_WHITE);
-            GFX_printf("ALERTA DE\nINCLINACAO!\n\n");
-            GFX_setTextSize(2);
-            GFX_printf("  Angulo: %.1f%c", roll_angle, 247); // 247 é o caractere de grau (°)
+            GFX_valueInvalidate(&val_acc_x);
+            GFX_valueInvalidate(&val_acc_y);
+            GFX_valueInvalidate(&val_acc_z);
+            GFX_valueInvalidate(&val_angulo);
+            GFX_valueInvalidate(&val_angulo_alerta);
+            GFX_chartInvalidate(&grafico_angulo);
+
+            if (estado) {
+                GFX_setCursor(20, 50);
+                GFX_setTextSize(3);
+                GFX_setTextColor(ILI9341_WHITE);
+                GFX_setTextBack(ILI9341_RED);
+                GFX_printf("ALERTA DE\nINCLINACAO!");
+            }
+        }
+
+        GFX_chartPush(&grafico_angulo, roll_angle);
+
+        if (estado) {
+            // --- ESTADO DE ALERTA ---
+            GFX_valueSet(&val_angulo_alerta, roll_angle);
         } else {
             // --- ESTADO NORMAL ---
-            GFX_setClearColor(ILI9341_BLACK);
-            GFX_clearScreen();
-            GFX_setCursor(0, 20);
-            GFX_setTextSize(3);
-            GFX_setTextColor(ILI9341_WHITE);
-            GFX_printf("Acc X: %.2f g\n", acc_x);
-            GFX_printf("Acc Y: %.2f g\n", acc_y);
-            GFX_printf("Acc Z: %.2f g\n", acc_z);
-            GFX_printf("\nAngulo: %.1f%c", roll_angle, 247);
+            GFX_valueSet(&val_acc_x, acc_x);
+            GFX_valueSet(&val_acc_y, acc_y);
+            GFX_valueSet(&val_acc_z, acc_z);
+            GFX_valueSet(&val_angulo, roll_angle);
+            GFX_chartUpdate(&grafico_angulo);
         }
 
-        // 4. Atualizar o display com o conteúdo do buffer
-        GFX_flush();
+        // 4. Atualizar o display: a tela toda na troca de estado, senão só o que mudou
+        if (estado != estado_anterior)
+            GFX_flush();
+        else
+            GFX_flushDamage();
+        estado_anterior = estado;
 
         sleep_ms(100);
     }
@@ -0,0 +1,68 @@
+#include "ramdisk.h"
+#include <stdlib.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio.h"
+
+static uint8_t* image;
+static uint32_t image_sectors;
+static ramdisk_stats stats;
+
+void ramdisk_init(uint32_t sectors) {
+    free(image);
+    image = calloc(sectors, FF_MAX_SS);
+    image_sectors = sectors;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void ramdisk_free(void) {
+    free(image);
+    image = NULL;
+    image_sectors = 0;
+}
+
+void ramdisk_get_stats(ramdisk_stats* out) {
+    *out = stats;
+}
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return pdrv == 0 && image ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || !image) return RES_NOTRDY;
+    if (sector + count > image_sectors) return RES_PARERR;
+    memcpy(buff, image + (size_t)sector * FF_MAX_SS, (size_t)count * FF_MAX_SS);
+    stats.reads += count;
+    stats.read_ops++;
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count) {
+    if (pdrv != 0 || !image) return RES_NOTRDY;
+    if (sector + count > image_sectors) return RES_PARERR;
+    memcpy(image + (size_t)sector * FF_MAX_SS, buff, (size_t)count * FF_MAX_SS);
+    stats.writes += count;
+    stats.write_ops++;
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
+    if (pdrv != 0 || !image) return RES_NOTRDY;
+    switch (cmd) {
+    case CTRL_SYNC: return RES_OK;
+    case GET_SECTOR_COUNT: *(LBA_t*)buff = image_sectors; return RES_OK;
+    case GET_SECTOR_SIZE: *(WORD*)buff = FF_MAX_SS; return RES_OK;
+    case GET_BLOCK_SIZE: *(DWORD*)buff = 1; return RES_OK;
+    default: return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void) {
+    // 2025-01-01 00:00
+    return ((DWORD)(2025 - 1980) << 25) | (1 << 21) | (1 << 16);
+}
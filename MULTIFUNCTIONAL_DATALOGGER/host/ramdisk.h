@@ -0,0 +1,20 @@
+#ifndef RAMDISK_H
+#define RAMDISK_H
+
+#include <stdint.h>
+
+// Cartão SD simulado em memória para o FatFs (disk_* de diskio.h), com a
+// contagem de setores lidos e escritos
+
+typedef struct {
+    uint64_t reads;                 // setores
+    uint64_t writes;
+    uint64_t read_ops;              // chamadas de disk_read
+    uint64_t write_ops;
+} ramdisk_stats;
+
+void ramdisk_init(uint32_t sectors);
+void ramdisk_free(void);
+void ramdisk_get_stats(ramdisk_stats* out);
+
+#endif
@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ff.h"
+#include "ramdisk.h"
+#include "uid_table.h"
+
+// Custo de lib/uid_table no datalogger, com o FatFs do projeto sobre um
+// cartão SD simulado em memória:
+//
+//   ./build-host/uid_table_bench                 20000 UIDs cadastrados
+//   ./build-host/uid_table_bench -n 100000 -b 12500000
+//
+// Monta a tabela a partir de uma lista de texto, mede as consultas e confere
+// a troca atômica entre gerações (inclusive uma montagem interrompida). Para
+// cada tipo de consulta:
+//   set/cons  setores lidos do SD por consulta
+//   cache%    setores encontrados no cache de RAM
+//   us SD     tempo de transferência desses setores no SPI a -b baud
+//   ns host   tempo de CPU no Linux (só a parte de processamento)
+// Tipos: "cadastrados" (UID aleatório da lista), "desconhecidos" (fora da
+// lista) e "repetidos" (os mesmos 8 cartões, como numa porta).
+//
+// Opções:
+//   -n n        UIDs cadastrados (20000)
+//   -c n        consultas de cada tipo (20000)
+//   -b baud     SPI do cartão SD (1000000, como em hw_config.c)
+//   -w setores  buffer de trabalho da montagem (36, como no datalogger)
+//   -s semente  (1)
+//
+// Na montagem, "s SD" é o tempo de transferência dos setores lidos e
+// escritos no SPI a -b baud, sem a espera de gravação do cartão.
+
+// Bytes no SPI por setor lido: comando, resposta, token, dados e CRC
+#define SD_BYTES_PER_SECTOR (6 + 2 + 1 + 512 + 2)
+
+typedef struct {
+    uint8_t size;
+    uint8_t bytes[10];
+    bool deny;
+} test_uid;
+
+static uint32_t rng_state = 1;
+static double spi_baud = 1000000;
+static uint8_t* build_work;
+static uint32_t work_sectors = 36;
+
+static uint32_t random32() {
+    rng_state = rng_state * 1664525 + 1013904223;
+    return rng_state;
+}
+
+// Bits altos: os baixos do LCG têm período curto
+static uint32_t random_below(uint32_t n) {
+    return (uint32_t)(((uint64_t)random32() * n) >> 32);
+}
+
+// Bijetora: UIDs distintos para índices distintos
+static uint32_t mix(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/* UID de índice i: 4 bytes (70%), 7 (28%) ou 10 (2%); os 4 primeiros
+   bytes vêm de i, o resto é aleatório */
+static void make_uid(test_uid* u, uint32_t i) {
+    uint32_t r = random_below(100);
+    u->size = r < 70 ? 4 : r < 98 ? 7 : 10;
+    uint32_t h = mix(i);
+    for (int b = 0; b < u->size; b++)
+        u->bytes[b] = b < 4 ? (uint8_t)(h >> (8 * b)) : (uint8_t)(random32() >> 24);
+    u->deny = false;
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static bool write_list(const char* path, const test_uid* uids, int count) {
+    FIL f;
+    if (f_open(&f, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+        return false;
+    f_printf(&f, "# lista de acesso gerada pelo uid_table_bench\n");
+    for (int i = 0; i < count; i++) {
+        char line[40];
+        int len = 0;
+        if (uids[i].deny)
+            line[len++] = '!';
+        for (int b = 0; b < uids[i].size; b++)
+            len += sprintf(line + len, b ? ":%02X" : "%02X", uids[i].bytes[b]);
+        line[len++] = '\n';
+        line[len] = 0;
+        f_puts(line, &f);
+    }
+    return f_close(&f) == FR_OK;
+}
+
+/* Confere a tabela contra a lista; devolve o número de respostas erradas */
+static uint32_t verify(uid_table* t, const test_uid* uids, int count, const test_uid* absent,
+                       int absent_count) {
+    uint32_t errors = 0;
+    for (int i = 0; i < count; i++) {
+        uid_table_result want = uids[i].deny ? UID_TABLE_DENY : UID_TABLE_ALLOW;
+        errors += uid_table_lookup(t, uids[i].bytes, uids[i].size) != want;
+    }
+    for (int i = 0; i < absent_count; i++)
+        errors += uid_table_lookup(t, absent[i].bytes, absent[i].size) != UID_TABLE_UNKNOWN;
+    return errors;
+}
+
+static uint32_t build(const char* list, uint32_t expected) {
+    ramdisk_stats before, after;
+    ramdisk_get_stats(&before);
+    double t0 = now_ns();
+    uint32_t entries;
+    FRESULT fr = uid_table_build("acesso", list, build_work, work_sectors, &entries);
+    double t1 = now_ns();
+    ramdisk_get_stats(&after);
+    if (fr != FR_OK) {
+        fprintf(stderr, "uid_table_build: erro %d\n", fr);
+        exit(1);
+    }
+    uint64_t reads = after.reads - before.reads, writes = after.writes - before.writes;
+    printf("montagem de %s: %u UIDs, %llu setores lidos e %llu escritos (%.3f por UID), "
+           "%.1f s SD, %.0f ms no host\n",
+           list, entries, (unsigned long long)reads, (unsigned long long)writes,
+           (double)(reads + writes) / (entries ? entries : 1),
+           (reads + writes) * SD_BYTES_PER_SECTOR * 8 / spi_baud, (t1 - t0) / 1e6);
+    return entries != expected;
+}
+
+int main(int argc, char** argv) {
+    int count = 20000, queries = 20000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:b:w:s:")) != -1) {
+        switch (opt) {
+        case 'n': count = atoi(optarg); break;
+        case 'c': queries = atoi(optarg); break;
+        case 'b': spi_baud = atof(optarg); break;
+        case 'w': work_sectors = (uint32_t)atoi(optarg); break;
+        case 's': rng_state = (uint32_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "uso: %s [-n uids] [-c consultas] [-b baud_spi] [-w setores] [-s semente]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (count < 8 || count > 1000000 || queries < 1 || spi_baud <= 0 || work_sectors < 4 ||
+        work_sectors > 4096) {
+        fprintf(stderr, "uid_table_bench: parâmetros inválidos\n");
+        return 1;
+    }
+    double baud = spi_baud;
+    build_work = malloc(work_sectors * UID_TABLE_SECTOR);
+
+    // Lista (~25 bytes por UID) e duas cópias da tabela (~20-30 bytes por UID)
+    ramdisk_init(16384 + (uint32_t)count / 4);
+    static FATFS fs;
+    static uint8_t work[FF_MAX_SS * 4];
+    MKFS_PARM fmt = { FM_ANY, 0, 0, 0, 0 };
+    if (f_mkfs("0:", &fmt, work, sizeof(work)) != FR_OK || f_mount(&fs, "0:", 1) != FR_OK) {
+        fprintf(stderr, "uid_table_bench: falha ao formatar o disco simulado\n");
+        return 1;
+    }
+
+    test_uid* uids = malloc(count * sizeof(test_uid));
+    test_uid* absent = malloc(count * sizeof(test_uid));
+    for (int i = 0; i < count; i++) {
+        make_uid(&uids[i], (uint32_t)i);
+        uids[i].deny = i % 20 == 0;
+        make_uid(&absent[i], 0x80000000u + i);
+    }
+
+    uint32_t errors = 0;
+    write_list("acesso.txt", uids, count);
+    errors += build("acesso.txt", count);
+
+    static uid_table table;
+    if (uid_table_open(&table, "acesso") != FR_OK) {
+        fprintf(stderr, "uid_table_open falhou\n");
+        return 1;
+    }
+    FSIZE_t file_size = f_size(&table.file[table.active]);
+    printf("tabela: %u buckets de %d entradas, ocupacao %.0f%%, %.1f bytes por UID no SD\n",
+           table.buckets, UID_TABLE_SLOTS, 100.0 * count / (table.buckets * UID_TABLE_SLOTS),
+           (double)file_size / count);
+    size_t ram = sizeof(uid_table) + UID_TABLE_STATIC_RAM;
+    printf("RAM: %zu bytes fixos (tabela %zu com cache de %d setores, estaticos %zu), "
+           "%.3f bytes por UID cadastrado; montagem: %u bytes de trabalho\n\n",
+           ram, sizeof(uid_table), UID_TABLE_CACHE, (size_t)UID_TABLE_STATIC_RAM,
+           (double)ram / count, work_sectors * UID_TABLE_SECTOR);
+
+    // Consultas
+    printf("%-14s %8s %8s %8s %8s\n", "consultas", "set/cons", "cache%", "us SD", "ns host");
+    test_uid frequent[8];
+    for (int i = 0; i < 8; i++)
+        frequent[i] = uids[random_below(count)];
+    const char* kinds[] = { "cadastrados", "desconhecidos", "repetidos" };
+    for (int k = 0; k < 3; k++) {
+        uid_table_stats before, after;
+        uid_table_get_stats(&table, &before);
+        double t0 = now_ns();
+        for (int q = 0; q < queries; q++) {
+            const test_uid* u = k == 0 ? &uids[random_below(count)]
+                              : k == 1 ? &absent[random_below(count)] : &frequent[random_below(8)];
+            uid_table_result want = k == 1 ? UID_TABLE_UNKNOWN : u->deny ? UID_TABLE_DENY : UID_TABLE_ALLOW;
+            errors += uid_table_lookup(&table, u->bytes, u->size) != want;
+        }
+        double t1 = now_ns();
+        uid_table_get_stats(&table, &after);
+        uint32_t reads = after.sector_reads - before.sector_reads;
+        uint32_t hits = after.cache_hits - before.cache_hits;
+        double per_query = (double)reads / queries;
+        printf("%-14s %8.3f %8.1f %8.0f %8.0f\n", kinds[k], per_query,
+               100.0 * hits / (hits + reads ? hits + reads : 1),
+               per_query * SD_BYTES_PER_SECTOR * 8 / baud * 1e6, (t1 - t0) / queries);
+    }
+    uid_table_stats st;
+    uid_table_get_stats(&table, &st);
+    printf("no maximo %u setores numa consulta\n\n", st.max_probes);
+
+    // Troca de geração: a tabela aberta só muda no uid_table_reload
+    int removed = count / 10;
+    test_uid* next = uids + removed;
+    for (int i = 0; i < count - removed; i += 7)
+        next[i].deny = !next[i].deny;
+    write_list("acesso2.txt", next, count - removed);
+    errors += build("acesso2.txt", count - removed);
+    uint32_t stale = 0;
+    for (int i = removed; i < count; i += 7)
+        stale += uid_table_lookup(&table, uids[i].bytes, uids[i].size) !=
+                 (uids[i].deny ? UID_TABLE_ALLOW : UID_TABLE_DENY);
+    errors += stale;
+    errors += uid_table_reload(&table) != FR_OK;
+    uint32_t wrong = verify(&table, next, count - removed, uids, removed) +
+                     verify(&table, NULL, 0, absent, count);
+    errors += wrong;
+    printf("geracao %u: %u respostas erradas (a anterior respondeu ate o reload: %s)\n",
+           table.generation, wrong, stale ? "nao" : "sim");
+
+    // Montagem interrompida: cabeçalho não gravado
+    errors += build("acesso.txt", count);
+    FIL f;
+    static uint8_t zero[UID_TABLE_SECTOR];
+    UINT n;
+    char path[UID_TABLE_PATH_MAX];
+    snprintf(path, sizeof(path), "acesso_%c.uid", 'a' + (1 - table.copy));
+    if (f_open(&f, path, FA_WRITE) == FR_OK) {
+        f_write(&f, zero, sizeof(zero), &n);
+        f_close(&f);
+    }
+    uint32_t generation = table.generation;
+    FRESULT fr = uid_table_reload(&table);
+    wrong = verify(&table, next, count - removed, uids, removed);
+    errors += wrong + (fr != FR_OK) + (table.generation != generation);
+    printf("montagem interrompida: continua na geracao %u, %u respostas erradas\n",
+           table.generation, wrong);
+
+    uid_table_close(&table);
+    free(uids);
+    free(absent);
+    free(build_work);
+    ramdisk_free();
+    printf("\n%u erros\n", errors);
+    return errors ? 1 : 0;
+}
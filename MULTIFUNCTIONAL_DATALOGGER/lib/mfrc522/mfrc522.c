@@ -9,6 +9,9 @@
 // ADT object allocation counter
 static int MFRC_Instance_Counter = 0;
 
+// GPIOs of the readers' IRQ lines, served by PCD_IrqHandler()
+static uint32_t PCD_IrqPinMask = 0;
+
 /**
  * Set up the data structures of an MFRC522 ADT object and return a pointer
  */
@@ -27,6 +30,13 @@ MFRC522Ptr_t MFRC522_Init() {
 	}
 
 	mfrc_Instances[MFRC_Instance_Counter]._chipSelectPin = cs_pin;
+#ifdef IRQ_PIN
+	// Only the first reader gets the default line, see PCD_SetIrqPin()
+	mfrc_Instances[MFRC_Instance_Counter]._irqPin =
+		MFRC_Instance_Counter == 0 ? IRQ_PIN : -1;
+#else
+	mfrc_Instances[MFRC_Instance_Counter]._irqPin = -1;
+#endif
 
 	// update instance counter
 	MFRC_Instance_Counter++;
@@ -153,6 +163,92 @@ void PCD_ClearRegisterBitMask(
 	PCD_WriteRegister(mfrc, reg, tmp & (~mask)); // clear bit mask
 } // End PCD_ClearRegisterBitMask()
 
+/**
+ * GPIO interrupt of the readers' IRQ lines. It only has to wake the core out
+ * of PCD_WaitForIrq(): the state is read back from the pin level.
+ */
+static void PCD_IrqHandler(void) {
+	for (uint pin = 0; pin < 32; pin++) {
+		if ((PCD_IrqPinMask & (1u << pin)) &&
+			(gpio_get_irq_event_mask(pin) & GPIO_IRQ_EDGE_FALL)) {
+			gpio_acknowledge_irq(pin, GPIO_IRQ_EDGE_FALL);
+		}
+	}
+} // End PCD_IrqHandler()
+
+/**
+ * Sets up an IRQ line as a falling-edge wake-up. The shared handler is
+ * registered once for all lines, so calling PCD_Init() again or for a
+ * second reader does not stack handlers.
+ */
+static void PCD_IrqPinInit(uint pin) {
+	gpio_init(pin);
+	gpio_set_dir(pin, GPIO_IN);
+	gpio_pull_up(pin);
+	if (!(PCD_IrqPinMask & (1u << pin))) {
+		if (PCD_IrqPinMask) {
+			gpio_remove_raw_irq_handler_masked(PCD_IrqPinMask, PCD_IrqHandler);
+		}
+		PCD_IrqPinMask |= 1u << pin;
+		gpio_add_raw_irq_handler_masked(PCD_IrqPinMask, PCD_IrqHandler);
+	}
+	gpio_set_irq_enabled(pin, GPIO_IRQ_EDGE_FALL, true);
+	irq_set_enabled(IO_IRQ_BANK0, true);
+} // End PCD_IrqPinInit()
+
+/**
+ * Selects the interrupt requests that drive the IRQ pin. Only the requests
+ * being waited for are enabled, so the pin goes low exactly when the wait is
+ * over. The registers are cached to save SPI writes between commands.
+ */
+static void PCD_SetIrqMask(
+	MFRC522Ptr_t mfrc,
+	uint8_t comIEn, ///< ComIEnReg enable bits. IRqInv (pin active low) is added.
+	uint8_t divIEn  ///< DivIEnReg enable bits. IRQPushPull is added.
+	) {
+	comIEn |= 0x80;
+	divIEn |= 0x80;
+	if (mfrc->_comIEn != comIEn) {
+		PCD_WriteRegister(mfrc, ComIEnReg, comIEn);
+		mfrc->_comIEn = comIEn;
+	}
+	if (mfrc->_divIEn != divIEn) {
+		PCD_WriteRegister(mfrc, DivIEnReg, divIEn);
+		mfrc->_divIEn = divIEn;
+	}
+} // End PCD_SetIrqMask()
+
+/**
+ * Waits until one of the bits in mask is set in irqReg (ComIrqReg or
+ * DivIrqReg). With an IRQ line the SPI bus is left alone until the pin goes
+ * low and the core sleeps in the meantime, or runs the wait hook if one is
+ * set. Without it the register is polled.
+ *
+ * @return The value of irqReg, or 0 after timeoutMs.
+ */
+static uint8_t PCD_WaitForIrq(MFRC522Ptr_t mfrc, uint8_t irqReg, uint8_t mask,
+							  uint32_t timeoutMs) {
+	absolute_time_t deadline = make_timeout_time_ms(timeoutMs);
+	uint8_t n;
+	while (1) {
+		if (mfrc->_irqPin < 0 || !gpio_get(mfrc->_irqPin)) {
+			n = PCD_ReadRegister(mfrc, irqReg);
+			if (n & mask) {
+				return n;
+			}
+		}
+		if (time_reached(deadline)) {
+			return 0;
+		}
+		if (mfrc->waitHook) {
+			mfrc->waitHook();
+		} else if (mfrc->_irqPin >= 0) {
+			// Woken by PCD_IrqHandler() or at the deadline
+			best_effort_wfe_or_timeout(deadline);
+		}
+	}
+} // End PCD_WaitForIrq()
+
 /**
  * Use the CRC coprocessor in the MFRC522 to calculate a CRC_A.
  *
@@ -167,6 +263,7 @@ PCD_CalculateCRC(MFRC522Ptr_t mfrc,
 								 ///written to result[0..1], low uint8_t first.
 				 ) {
 	PCD_WriteRegister(mfrc, CommandReg, PCD_Idle); // Stop any active command.
+	PCD_SetIrqMask(mfrc, 0x00, 0x04); // IRQ on CRCIRq only
 	PCD_WriteRegister(mfrc, DivIrqReg,
 					  0x04); // Clear the CRCIRq interrupt request bit
 	PCD_SetRegisterBitMask(mfrc, FIFOLevelReg,
@@ -175,23 +272,12 @@ PCD_CalculateCRC(MFRC522Ptr_t mfrc,
 					   data);						  // Write data to the FIFO
 	PCD_WriteRegister(mfrc, CommandReg, PCD_CalcCRC); // Start the calculation
 
-	// Wait for the CRC calculation to complete. Each iteration of the
-	// while-loop takes 17.73�s.
-	uint16_t i = 5000;
-	uint8_t n;
-	while (1) {
-		n = PCD_ReadRegister(mfrc, DivIrqReg); // DivIrqReg[7..0] bits are: Set2
-											   // reserved reserved MfinActIRq
-											   // reserved CRCIRq reserved
-											   // reserved
-		if (n & 0x04) { // CRCIRq bit set - calculation done
-			break;
-		}
-		if (--i == 0) { // The emergency break. We will eventually terminate on
-						// this one after 89ms. Communication with the MFRC522
-						// might be down.
-			return STATUS_TIMEOUT;
-		}
+	// Wait for the CRC calculation to complete. DivIrqReg[7..0] bits are:
+	// Set2 reserved reserved MfinActIRq reserved CRCIRq reserved reserved
+	if (!(PCD_WaitForIrq(mfrc, DivIrqReg, 0x04, MFRC522_CRC_TIMEOUT_MS) &
+		  0x04)) { // The emergency break. Communication with the MFRC522 might
+				   // be down.
+		return STATUS_TIMEOUT;
 	}
 	PCD_WriteRegister(
 		mfrc, CommandReg,
@@ -232,6 +318,14 @@ void PCD_Init(MFRC522Ptr_t mfrc, spi_inst_t *spi) {
 
 	PCD_WriteRegister(mfrc, CommandReg, PCD_SoftReset);
 
+	// IRQ mirrors only the requests being waited for, see PCD_SetIrqMask()
+	mfrc->_comIEn = 0;
+	mfrc->_divIEn = 0;
+	PCD_SetIrqMask(mfrc, 0x00, 0x00);
+	if (mfrc->_irqPin >= 0) {
+		PCD_IrqPinInit(mfrc->_irqPin);
+	}
+
 	// When communicating with a PICC we need a timeout if something goes wrong.
 	// f_timer = 13.56 MHz / (2*TPreScaler+1) where TPreScaler =
 	// [TPrescaler_Hi:TPrescaler_Lo].
@@ -262,12 +356,33 @@ void PCD_Init(MFRC522Ptr_t mfrc, spi_inst_t *spi) {
 						 // were disabled by the reset)
 } // End PCD_Init()
 
+/**
+ * Sets a function to run while waiting for the MFRC522 to finish a command,
+ * e.g. to poll other peripherals or yield to another task. NULL (default)
+ * sleeps the core until the IRQ pin or the timeout wakes it, or keeps
+ * polling when the reader has no IRQ line.
+ */
+void PCD_SetWaitHook(MFRC522Ptr_t mfrc, void (*hook)(void)) {
+	mfrc->waitHook = hook;
+} // End PCD_SetWaitHook()
+
+/**
+ * Sets the GPIO wired to this reader's IRQ pin, or -1 to poll the interrupt
+ * registers over SPI. Call before PCD_Init(). Each reader needs its own
+ * line: the pins are push-pull and cannot share one.
+ */
+void PCD_SetIrqPin(MFRC522Ptr_t mfrc, int pin) {
+	mfrc->_irqPin = pin;
+} // End PCD_SetIrqPin()
+
 /**
  * Performs a soft reset on the MFRC522 chip and waits for it to be ready again.
  */
 void PCD_Reset(MFRC522Ptr_t mfrc) {
 	PCD_WriteRegister(mfrc, CommandReg,
 					  PCD_SoftReset); // Issue the SoftReset command.
+	mfrc->_comIEn = 0; // ComIEnReg and DivIEnReg are back to reset values
+	mfrc->_divIEn = 0;
 	// The datasheet does not mention how long the SoftRest command takes to
 	// complete.
 	// But the MFRC522 might have been in soft power-down mode (triggered by bit
@@ -336,6 +451,8 @@ uint8_t PCD_SelfTest(MFRC522Ptr_t mfrc) {
 
     //Perform a soft reset
     PCD_WriteRegister(mfrc, CommandReg, PCD_SoftReset);
+    mfrc->_comIEn = 0; // IRQ masks are back to reset values
+    mfrc->_divIEn = 0;
     sleep_ms(50); //Allow the chip to reset
     //printf("Soft reset complete\n\r");
 
@@ -468,7 +585,6 @@ StatusCode PCD_CommunicateWithPICC(
 	//		checkCRC=false;
 
 	uint8_t n, _validBits;
-	unsigned int i;
 
 	// Prepare values for BitFramingReg
 	uint8_t txLastBits = validBits ? *validBits : 0;
@@ -477,6 +593,7 @@ StatusCode PCD_CommunicateWithPICC(
 									 // TxLastBits = BitFramingReg[2..0]
 
 	PCD_WriteRegister(mfrc, CommandReg, PCD_Idle); // Stop any active command.
+	PCD_SetIrqMask(mfrc, waitIRq | 0x01, 0x00); // IRQ on completion or timer
 	PCD_WriteRegister(mfrc, ComIrqReg,
 					  0x7F); // Clear all seven interrupt request bits
 	PCD_SetRegisterBitMask(mfrc, FIFOLevelReg,
@@ -494,24 +611,14 @@ StatusCode PCD_CommunicateWithPICC(
 	// Wait for the command to complete.
 	// In PCD_Init() we set the TAuto flag in TModeReg. This means the timer
 	// automatically starts when the PCD stops transmitting.
-	// Each iteration of the do-while-loop takes 17.86�s.
-	i = 2000;
-	while (1) {
-		n = PCD_ReadRegister(mfrc, ComIrqReg); // ComIrqReg[7..0] bits are: Set1
-											   // TxIRq RxIRq IdleIRq HiAlertIRq
-											   // LoAlertIRq ErrIRq TimerIRq
-		if (n & waitIRq) { // One of the interrupts that signal success has been
-						   // set.
-			break;
-		}
-		if (n & 0x01) { // Timer interrupt - nothing received in 25ms
-			return STATUS_TIMEOUT;
-		}
-		if (--i == 0) { // The emergency break. If all other conditions fail we
-						// will eventually terminate on this one after 35.7ms.
-						// Communication with the MFRC522 might be down.
-			return STATUS_TIMEOUT;
-		}
+	// ComIrqReg[7..0] bits are: Set1 TxIRq RxIRq IdleIRq HiAlertIRq
+	// LoAlertIRq ErrIRq TimerIRq
+	n = PCD_WaitForIrq(mfrc, ComIrqReg, waitIRq | 0x01,
+					   MFRC522_COMMAND_TIMEOUT_MS);
+	if (!(n & waitIRq)) { // Timer interrupt - nothing received in 25ms, or
+						  // the emergency break. Communication with the
+						  // MFRC522 might be down.
+		return STATUS_TIMEOUT;
 	}
 
 	// Stop now if any errors except collisions were detected.
@@ -2264,6 +2371,332 @@ bool PICC_ReadCardSerial(MFRC522Ptr_t mfrc) {
 	return (result == STATUS_OK);
 } // End
 
+/*******************************************************************************
+* Low-power card detection
+*
+* PICC_IsNewCardPresent() keeps the antenna on all the time and a REQA with no
+* card waits for the full 25ms timer. Here the antenna (and optionally the
+* whole MFRC522) is off between polls. Each poll is a short field burst: the
+* guard time for a card to power up, then a REQA that only waits for the ATQA.
+* Anticollision (PICC_Select) only runs when something answers. The interval
+* drops to fastIntervalMs after activity and grows back to idleIntervalMs.
+*******************************************************************************/
+
+/**
+ * Sets the MFRC522 timer reload value, in 25us ticks (see PCD_Init()).
+ */
+static void PCD_SetTimerReload(MFRC522Ptr_t mfrc, uint16_t ticks) {
+	PCD_WriteRegister(mfrc, TReloadRegH, ticks >> 8);
+	PCD_WriteRegister(mfrc, TReloadRegL, ticks & 0xFF);
+} // End PCD_SetTimerReload()
+
+/**
+ * Leaves soft power-down (CommandReg bit 4). Registers are kept while
+ * powered down; only the oscillator has to start again.
+ */
+static void PCD_WakeUp(MFRC522Ptr_t mfrc) {
+	PCD_WriteRegister(mfrc, CommandReg, PCD_Idle);
+	absolute_time_t deadline = make_timeout_time_ms(5);
+	while ((PCD_ReadRegister(mfrc, CommandReg) & (1 << 4)) &&
+		   !time_reached(deadline)) {
+		sleep_us(50);
+	}
+} // End PCD_WakeUp()
+
+/**
+ * Switches the field off, ending a burst or the field left on after a
+ * detection, and powers the MFRC522 down if configured.
+ */
+static void PICC_PollFieldOff(MFRC522Ptr_t mfrc, PICC_Poller *poller) {
+	if (!poller->fieldOnUs) {
+		return;
+	}
+	PCD_AntennaOff(mfrc);
+	poller->fieldUs += time_us_64() - poller->fieldOnUs;
+	poller->fieldOnUs = 0;
+	if (poller->powerDown) {
+		PCD_WriteRegister(mfrc, CommandReg, 1 << 4); // PowerDown=1
+		poller->asleep = true;
+	}
+} // End PICC_PollFieldOff()
+
+/**
+ * Sets default configuration, clears the statistics and switches the field
+ * off. The first poll happens on the next call to PICC_Poll(). Other
+ * functions of this library only work between a detection and the next
+ * PICC_Poll() call, while the field is on.
+ */
+void PICC_PollInit(MFRC522Ptr_t mfrc, PICC_Poller *poller) {
+	memset(poller, 0, sizeof(*poller));
+	poller->fastIntervalMs = 50;
+	poller->idleIntervalMs = 500;
+	poller->fieldGuardUs = 5000;
+	poller->probeTimeoutUs = 500;
+	poller->powerDown = true;
+	poller->intervalMs = poller->fastIntervalMs;
+	poller->nextPoll = get_absolute_time();
+	poller->startUs = time_us_64();
+	PCD_AntennaOff(mfrc); // PCD_Init() leaves it on
+	if (poller->powerDown) {
+		PCD_WriteRegister(mfrc, CommandReg, 1 << 4);
+		poller->asleep = true;
+	}
+} // End PICC_PollInit()
+
+/**
+ * Runs a field burst if the poll interval has elapsed. Returns immediately,
+ * without touching the MFRC522, otherwise.
+ * On detection the UID is in mfrc->uid (as with PICC_ReadCardSerial()) and
+ * the field stays on, so the card can be read and halted, until the next
+ * call.
+ * Switching the field off resets a halted card, so a card left on the reader
+ * is selected again by every poll. It is reported once: polls that select the
+ * last reported UID return false, until a poll finds the field empty. Those
+ * polls back off to idleIntervalMs like empty ones.
+ *
+ * @return true if a new card was selected.
+ */
+bool PICC_Poll(MFRC522Ptr_t mfrc, PICC_Poller *poller) {
+	PICC_PollFieldOff(mfrc, poller);
+	if (!time_reached(poller->nextPoll)) {
+		return false;
+	}
+
+	uint64_t start = time_us_64();
+	if (poller->asleep) { // Even if powerDown was cleared since
+		PCD_WakeUp(mfrc);
+		poller->asleep = false;
+	}
+	PCD_AntennaOn(mfrc);
+	poller->fieldOnUs = time_us_64();
+	poller->polls++;
+	sleep_us(poller->fieldGuardUs);
+
+	// REQA with the timer cut down to the ATQA window
+	uint32_t ticks = (poller->probeTimeoutUs + 24) / 25;
+	PCD_SetTimerReload(mfrc, ticks > 0xFFFF ? 0xFFFF : ticks);
+	uint8_t bufferATQA[2];
+	uint8_t bufferSize = sizeof(bufferATQA);
+	StatusCode result = PICC_RequestA(mfrc, bufferATQA, &bufferSize);
+	PCD_SetTimerReload(mfrc, 0x3E8);
+
+	bool found = false;
+	uint64_t now = time_us_64();
+	bool answered = result == STATUS_OK || result == STATUS_COLLISION;
+	bool repeated = false;
+	if (answered) {
+		poller->responses++;
+		found = PICC_Select(mfrc, &(mfrc->uid), 0) == STATUS_OK;
+		repeated = found && poller->lastPresent &&
+				   mfrc->uid.size == poller->lastUid.size &&
+				   memcmp(mfrc->uid.uidByte, poller->lastUid.uidByte,
+						  mfrc->uid.size) == 0;
+	} else {
+		poller->lastPresent = false;
+	}
+	if (repeated) {
+		poller->repeats++;
+		found = false;
+	}
+	if (answered && !repeated) {
+		poller->intervalMs = poller->fastIntervalMs;
+	} else {
+		poller->intervalMs += poller->intervalMs / 2;
+		if (poller->intervalMs > poller->idleIntervalMs) {
+			poller->intervalMs = poller->idleIntervalMs;
+		}
+	}
+
+	if (found) {
+		// The card arrived after the last poll that reported nothing
+		uint64_t latency = poller->lastPollUs ? now - poller->lastPollUs : 0;
+		poller->detections++;
+		poller->latencyUs += latency;
+		if (latency > poller->maxLatencyUs) {
+			poller->maxLatencyUs = latency;
+		}
+		poller->lastUid = mfrc->uid;
+		poller->lastPresent = true;
+	} else {
+		poller->lastPollUs = now;
+		PICC_PollFieldOff(mfrc, poller);
+	}
+	poller->busyUs += time_us_64() - start;
+	poller->nextPoll = make_timeout_time_ms(poller->intervalMs);
+	return found;
+} // End PICC_Poll()
+
+/**
+ * Returns the time until the next poll, e.g. to sleep in between.
+ */
+uint32_t PICC_PollWaitMs(PICC_Poller *poller) {
+	int64_t us = absolute_time_diff_us(get_absolute_time(), poller->nextPoll);
+	return us > 0 ? (uint32_t)((us + 999) / 1000) : 0;
+} // End PICC_PollWaitMs()
+
+/**
+ * Dumps the average cost of a poll and the detection latency to serial.
+ * The latency is an upper bound: the time since the last poll that found
+ * nothing.
+ */
+void PICC_DumpPollStatsToSerial(PICC_Poller *poller) {
+	uint32_t polls = poller->polls ? poller->polls : 1;
+	uint64_t elapsed = time_us_64() - poller->startUs;
+	printf("Polls: %lu, answered: %lu, cards: %lu, same card again: %lu, interval now: %lu ms\r\n",
+		   (unsigned long)poller->polls, (unsigned long)poller->responses,
+		   (unsigned long)poller->detections, (unsigned long)poller->repeats,
+		   (unsigned long)poller->intervalMs);
+	printf("Per poll: %lu us busy, %lu us field on (field on %.2f%% of the time)\r\n",
+		   (unsigned long)(poller->busyUs / polls),
+		   (unsigned long)(poller->fieldUs / polls),
+		   elapsed ? 100.0 * poller->fieldUs / elapsed : 0.0);
+	if (poller->detections) {
+		printf("Detection latency: avg %lu ms, max %lu ms\r\n",
+			   (unsigned long)(poller->latencyUs / poller->detections / 1000),
+			   (unsigned long)(poller->maxLatencyUs / 1000));
+	}
+} // End PICC_DumpPollStatsToSerial()
+
+/*******************************************************************************
+* Multi-tag inventory
+*
+* Every tag in the field answers REQA at once. PICC_Select() walks the
+* collisions down to one of them, which is then halted so it stays quiet,
+* and the next REQA finds the remaining tags. Replies come ~90us after a
+* command, so the MFRC522 timer is cut to 1ms for the sweep (the HLTA
+* window of ISO/IEC 14443-3) instead of waiting 25ms on every HLTA and on
+* the final, unanswered REQA.
+*******************************************************************************/
+
+// Timer reload during the sweep: 40 * 25us = 1ms
+#define INVENTORY_TIMER_TICKS 40
+// REQA left unanswered this many times in a row ends the sweep
+#define INVENTORY_QUIET_REQUESTS 2
+// Consecutive failed selects that end the sweep with STATUS_ERROR
+#define INVENTORY_MAX_FAILURES 8
+
+/**
+ * Sends HLTA. Same as PICC_HaltA() with the CRC_A of the fixed frame
+ * precomputed, saving a round trip through the CRC coprocessor.
+ */
+static StatusCode PICC_HaltAFast(MFRC522Ptr_t mfrc) {
+	uint8_t buffer[4] = {PICC_CMD_HLTA, 0x00, 0x57, 0xCD};
+	StatusCode result = PCD_TransceiveData(mfrc, buffer, sizeof(buffer), NULL,
+										   0, NULL, 0, false);
+	if (result == STATUS_TIMEOUT) { // Only a timeout is a success
+		return STATUS_OK;
+	}
+	return result == STATUS_OK ? STATUS_ERROR : result;
+} // End PICC_HaltAFast()
+
+/**
+ * Reads every tag in the field: REQA, select and halt until no tag answers.
+ * Tags already halted (e.g. after PICC_Poll()) do not answer REQA and are
+ * not listed; tags that fail to halt are listed once. Pass a tag that was
+ * read before the sweep in the first `known` entries of uids, so that it is
+ * not listed again if its HLTA was lost.
+ * The MFRC522 is left with the field on and the usual 25ms timer.
+ *
+ * @return STATUS_OK when the field went quiet, STATUS_NO_ROOM if uids[] filled
+ * up, STATUS_TIMEOUT if timeoutMs elapsed first, STATUS_ERROR if tags kept
+ * failing to select.
+ */
+StatusCode PICC_Inventory(
+	MFRC522Ptr_t mfrc,
+	Uid *uids,		   ///< Out: The UIDs found, in selection order.
+	uint8_t *count,	///< In: Size of uids. Out: Number of UIDs in uids, known ones included.
+	uint8_t known,	 ///< In: UIDs already in uids[0..known-1], e.g. the tag selected by PICC_Poll().
+	uint32_t timeoutMs, ///< In: Time budget for the whole sweep, 0 for none.
+	PICC_InventoryStats *stats ///< Out: NULL or timing of the sweep.
+	) {
+	PICC_InventoryStats st;
+	memset(&st, 0, sizeof(st));
+	uint8_t maxCount = *count;
+	if (known > maxCount) {
+		known = maxCount;
+	}
+	uint8_t quiet = 0, failures = 0;
+	absolute_time_t deadline = make_timeout_time_ms(timeoutMs);
+	uint64_t start = time_us_64();
+	uint64_t tagStart = start;
+	StatusCode status = STATUS_OK;
+
+	*count = known;
+	PCD_AntennaOn(mfrc);
+	PCD_SetTimerReload(mfrc, INVENTORY_TIMER_TICKS);
+	while (1) {
+		if (timeoutMs && time_reached(deadline)) {
+			status = STATUS_TIMEOUT;
+			break;
+		}
+		if (*count >= maxCount) {
+			status = STATUS_NO_ROOM;
+			break;
+		}
+
+		uint8_t bufferATQA[2];
+		uint8_t bufferSize = sizeof(bufferATQA);
+		StatusCode result = PICC_RequestA(mfrc, bufferATQA, &bufferSize);
+		st.requests++;
+		if (result == STATUS_TIMEOUT) {
+			if (++quiet >= INVENTORY_QUIET_REQUESTS) {
+				break; // Every tag is halted
+			}
+			continue;
+		}
+		quiet = 0;
+		if (result == STATUS_COLLISION) {
+			st.collisions++;
+		} else if (result != STATUS_OK) {
+			// Garbled ATQA, most likely two tags slightly out of step
+			st.failures++;
+			if (++failures >= INVENTORY_MAX_FAILURES) {
+				status = STATUS_ERROR;
+				break;
+			}
+			continue;
+		}
+
+		Uid *uid = &uids[*count];
+		result = PICC_Select(mfrc, uid, 0);
+		bool duplicate = false;
+		for (uint8_t i = 0; result == STATUS_OK && i < *count; i++) {
+			if (uids[i].size == uid->size &&
+				memcmp(uids[i].uidByte, uid->uidByte, uid->size) == 0) {
+				duplicate = true;
+			}
+		}
+		if (result != STATUS_OK || duplicate) {
+			// Halt anyway: harmless if nothing is selected
+			PICC_HaltAFast(mfrc);
+			st.failures++;
+			if (++failures >= INVENTORY_MAX_FAILURES) {
+				status = STATUS_ERROR;
+				break;
+			}
+			continue;
+		}
+		PICC_HaltAFast(mfrc);
+		failures = 0;
+		(*count)++;
+
+		uint64_t now = time_us_64();
+		if (now - tagStart > st.maxTagUs) {
+			st.maxTagUs = now - tagStart;
+		}
+		tagStart = now;
+	}
+	PCD_SetTimerReload(mfrc, 0x3E8);
+
+	st.elapsedUs = time_us_64() - start;
+	uint8_t found = *count - known;
+	st.perTagUs = found ? st.elapsedUs / found : 0;
+	if (stats) {
+		*stats = st;
+	}
+	return status;
+} // End PICC_Inventory()
+
 static inline void cs_select(const uint cs) {
     asm volatile("nop \n nop \n nop");
     gpio_put(cs, 0); // Active low
@@ -0,0 +1,514 @@
+// lib/uid_table/uid_table.c
+
+#include "uid_table.h"
+#include <stdio.h>
+#include <string.h>
+
+// Cabeçalho no setor 0 (little-endian); os setores 1.. são os buckets:
+//   0  "UIDT"
+//   4  versão, tamanho da entrada, 2 bytes reservados
+//   8  buckets, 12 entradas, 16 geração
+//   20 FNV-1a dos bytes 0..19
+// Entrada: tamanho do UID (0 = livre), flags, 10 bytes de UID. As entradas de
+// um bucket são ocupadas em ordem; bucket cheio continua no seguinte.
+#define HEADER_SIZE 24
+#define VERSION 1
+#define FLAG_DENY 0x01
+
+// Ocupação máxima ao dimensionar a tabela (3/4)
+#define LOAD_NUM 3
+#define LOAD_DEN 4
+
+typedef struct {
+    uint32_t buckets;
+    uint32_t entries;
+    uint32_t generation;
+} table_header;
+
+// Montagem em faixas: a tabela é dividida em faixas de buckets que cabem no
+// buffer de trabalho. Uma leitura da lista distribui as entradas por faixa em
+// <base>.tmp, em setores de UID_TABLE_SLOTS entradas encadeados de trás para
+// frente por faixa; depois cada faixa é montada na RAM com as suas entradas e
+// gravada uma vez, em ordem. Entradas que passam do fim da faixa (bucket
+// cheio) seguem para o começo da próxima; as que passam do último bucket
+// voltam ao bucket 0, regravado. O buffer de trabalho tem, em setores:
+//   0  início da cadeia de cada faixa (uint16, 0xFFFF = vazia)
+//   1  entradas que transbordaram da faixa anterior
+//   2  setor lido de <base>.tmp
+//   3.. a faixa
+// Na distribuição os setores 1.. guardam o setor em montagem de cada faixa.
+#define CHAIN_END 0xFFFF
+#define MAX_RANGES (UID_TABLE_SECTOR / 2)
+#define CARRY_MAX UID_TABLE_SLOTS
+// Setor de <base>.tmp: UID_TABLE_SLOTS entradas, o setor anterior da mesma
+// faixa e quantas entradas estão ocupadas
+#define PART_PREV (UID_TABLE_SLOTS * UID_TABLE_SLOT)
+#define PART_COUNT (PART_PREV + 2)
+
+// Descritores fora da pilha (cada FIL tem um setor)
+static FIL peek_file, build_files[2];
+
+// Função interna: FNV-1a
+static uint32_t fnv1a(const uint8_t* data, uint32_t len, uint32_t h) {
+    for (uint32_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Função interna: bucket inicial de um UID
+static uint32_t uid_hash(const uint8_t* uid, uint8_t size) {
+    uint32_t h = fnv1a(&size, 1, 2166136261u);
+    h = fnv1a(uid, size, h);
+    // Mistura final (MurmurHash3) para os bits baixos usados como índice
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = v; p[1] = v >> 8;
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool valid_size(uint8_t size) {
+    return size == 4 || size == 7 || size == 10;
+}
+
+static void copy_path(char* out, const char* base, int copy) {
+    snprintf(out, UID_TABLE_PATH_MAX, "%s_%c.uid", base, 'a' + copy);
+}
+
+// Função interna: lê e valida o cabeçalho de um arquivo aberto
+static bool read_header(FIL* f, table_header* h) {
+    uint8_t buf[HEADER_SIZE];
+    UINT n;
+    if (f_lseek(f, 0) != FR_OK || f_read(f, buf, sizeof(buf), &n) != FR_OK || n != sizeof(buf)) {
+        return false;
+    }
+    if (memcmp(buf, "UIDT", 4) != 0 || buf[4] != VERSION || buf[5] != UID_TABLE_SLOT ||
+        get_u32(buf + 20) != fnv1a(buf, 20, 2166136261u)) {
+        return false;
+    }
+    h->buckets = get_u32(buf + 8);
+    h->entries = get_u32(buf + 12);
+    h->generation = get_u32(buf + 16);
+    // Potência de 2 e o arquivo inteiro presente
+    return h->buckets && !(h->buckets & (h->buckets - 1)) &&
+           f_size(f) == (FSIZE_t)(h->buckets + 1) * UID_TABLE_SECTOR;
+}
+
+// Função interna: cabeçalho de uma cópia, sem mantê-la aberta
+static bool peek_copy(const char* base, int copy, table_header* h) {
+    char path[UID_TABLE_PATH_MAX];
+    copy_path(path, base, copy);
+    if (f_open(&peek_file, path, FA_READ) != FR_OK) {
+        return false;
+    }
+    bool ok = read_header(&peek_file, h);
+    f_close(&peek_file);
+    return ok;
+}
+
+// Função interna: cópia mais nova (-1 se nenhuma válida)
+static int newest_copy(const char* base, table_header h[2]) {
+    bool ok0 = peek_copy(base, 0, &h[0]);
+    bool ok1 = peek_copy(base, 1, &h[1]);
+    if (!ok0 && !ok1) return -1;
+    if (!ok0) return 1;
+    if (!ok1) return 0;
+    return (int32_t)(h[1].generation - h[0].generation) > 0 ? 1 : 0;
+}
+
+// Função interna: setor de um bucket, do cache ou do SD
+static const uint8_t* read_bucket(uid_table* t, uint32_t bucket) {
+    uid_table_cache_entry* victim = &t->cache[0];
+    t->clock++;
+    for (int i = 0; i < UID_TABLE_CACHE; i++) {
+        uid_table_cache_entry* c = &t->cache[i];
+        if (c->bucket == bucket + 1) {
+            c->used = t->clock;
+            t->stats.cache_hits++;
+            return c->data;
+        }
+        if (c->used < victim->used) {
+            victim = c;
+        }
+    }
+
+    // Setor inteiro e alinhado: o FatFs lê direto para o cache
+    FIL* f = &t->file[t->active];
+    UINT n;
+    victim->bucket = 0;
+    if (f_lseek(f, (FSIZE_t)(bucket + 1) * UID_TABLE_SECTOR) != FR_OK ||
+        f_read(f, victim->data, UID_TABLE_SECTOR, &n) != FR_OK || n != UID_TABLE_SECTOR) {
+        return NULL;
+    }
+    victim->bucket = bucket + 1;
+    victim->used = t->clock;
+    t->stats.sector_reads++;
+    return victim->data;
+}
+
+// Função interna: UID de uma linha da lista; false para linhas sem UID
+static bool parse_line(const char* line, uint8_t* uid, uint8_t* size, bool* deny) {
+    while (*line == ' ' || *line == '\t') line++;
+    *deny = *line == '!';
+    if (*deny) line++;
+
+    int digits = 0;
+    *size = 0;
+    for (; *line && *line != '#' && *line != ',' && *line != '\r' && *line != '\n'; line++) {
+        char c = *line;
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else if (c == ':' || c == '-' || c == ' ') continue;
+        else return false;
+        if (*size >= 10) return false;
+        if (digits++ & 1) {
+            uid[(*size)++] |= v;
+        } else {
+            uid[*size] = v << 4;
+        }
+    }
+    return !(digits & 1) && valid_size(*size);
+}
+
+// Função interna: entrada (12 bytes, como no bucket) de uma linha da lista
+static bool parse_entry(const char* line, uint8_t* e) {
+    uint8_t size;
+    bool deny;
+    memset(e, 0, UID_TABLE_SLOT);
+    if (!parse_line(line, e + 2, &size, &deny)) {
+        return false;
+    }
+    e[0] = size;
+    e[1] = deny ? FLAG_DENY : 0;
+    return true;
+}
+
+// Função interna: insere a entrada na faixa (buckets first.. de nb setores)
+// a partir do bucket home. Um UID repetido fica com a primeira inserção.
+// Retorna false se a entrada passar do fim da faixa
+static bool insert_entry(uint8_t* range, uint32_t first, uint32_t nb, uint32_t home,
+                         const uint8_t* entry, uint32_t* entries) {
+    for (uint32_t b = home - first; b < nb; b++) {
+        uint8_t* sector = range + b * UID_TABLE_SECTOR;
+        for (int i = 0; i < UID_TABLE_SLOTS; i++) {
+            uint8_t* e = sector + i * UID_TABLE_SLOT;
+            if (e[0] == 0) {
+                memcpy(e, entry, UID_TABLE_SLOT);
+                (*entries)++;
+                return true;
+            }
+            if (e[0] == entry[0] && memcmp(e + 2, entry + 2, entry[0]) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Função interna: insere no começo da faixa as entradas que transbordaram;
+// as que não couberem continuam em carry
+static void insert_carry(uint8_t* range, uint32_t first, uint32_t nb,
+                         uint8_t* carry, uint32_t* carried, uint32_t* entries) {
+    uint32_t left = 0;
+    for (uint32_t i = 0; i < *carried; i++) {
+        uint8_t* e = carry + i * UID_TABLE_SLOT;
+        if (!insert_entry(range, first, nb, first, e, entries)) {
+            memmove(carry + left++ * UID_TABLE_SLOT, e, UID_TABLE_SLOT);
+        }
+    }
+    *carried = left;
+}
+
+// Função interna: grava o setor de uma faixa no fim de <base>.tmp
+static FRESULT flush_part(FIL* temp, uint8_t* part, uint8_t* head, uint32_t* temp_sectors) {
+    if (*temp_sectors >= CHAIN_END) {
+        return FR_NOT_ENOUGH_CORE;
+    }
+    UINT n;
+    put_u16(part + PART_PREV, get_u16(head));
+    FRESULT fr = f_write(temp, part, UID_TABLE_SECTOR, &n);
+    if (fr == FR_OK && n != UID_TABLE_SECTOR) fr = FR_DENIED;      // disco cheio
+    put_u16(head, (uint16_t)(*temp_sectors)++);
+    part[PART_COUNT] = 0;
+    return fr;
+}
+
+// ============================================================================
+// Funções públicas
+// ============================================================================
+
+FRESULT uid_table_open(uid_table* t, const char* base) {
+    memset(t, 0, sizeof(*t));
+    snprintf(t->base, sizeof(t->base), "%s", base);
+    t->active = -1;
+    return uid_table_reload(t);
+}
+
+FRESULT uid_table_reload(uid_table* t) {
+    table_header h[2];
+    int copy = newest_copy(t->base, h);
+    if (copy < 0) {
+        return FR_NO_FILE;
+    }
+    if (t->active >= 0 && copy == t->copy && h[copy].generation == t->generation) {
+        return FR_OK;               // já é a atual
+    }
+
+    // Abre no descritor livre; a ativa segue em uso até a nova ser validada
+    int slot = t->active < 0 ? 0 : 1 - t->active;
+    FIL* f = &t->file[slot];
+    char path[UID_TABLE_PATH_MAX];
+    copy_path(path, t->base, copy);
+    FRESULT fr = f_open(f, path, FA_READ);
+    if (fr != FR_OK) {
+        return fr;
+    }
+    table_header hdr;
+    if (!read_header(f, &hdr)) {
+        f_close(f);
+        return FR_NO_FILE;
+    }
+    // Mapa de clusters para que o f_lseek não percorra a FAT; se o arquivo
+    // estiver fragmentado demais, segue sem ele
+    f->cltbl = t->link_map[slot];
+    t->link_map[slot][0] = UID_TABLE_LINK_MAP;
+    if (f_lseek(f, CREATE_LINKMAP) != FR_OK) {
+        f->cltbl = NULL;
+    }
+
+    if (t->active >= 0) {
+        f_close(&t->file[t->active]);
+    }
+    t->active = slot;
+    t->copy = copy;
+    t->buckets = hdr.buckets;
+    t->entries = hdr.entries;
+    t->generation = hdr.generation;
+    memset(t->cache, 0, sizeof(t->cache));
+    t->stats.reloads++;
+    return FR_OK;
+}
+
+void uid_table_close(uid_table* t) {
+    if (t->active >= 0) {
+        f_close(&t->file[t->active]);
+    }
+    t->active = -1;
+}
+
+uid_table_result uid_table_lookup(uid_table* t, const uint8_t* uid, uint8_t size) {
+    if (t->active < 0 || !valid_size(size)) {
+        return UID_TABLE_UNKNOWN;
+    }
+    t->stats.lookups++;
+
+    uint32_t mask = t->buckets - 1;
+    uint32_t bucket = uid_hash(uid, size) & mask;
+    for (uint32_t probes = 1; probes <= t->buckets; probes++) {
+        const uint8_t* sector = read_bucket(t, bucket);
+        if (!sector) {
+            return UID_TABLE_UNKNOWN;
+        }
+        if (probes > t->stats.max_probes) {
+            t->stats.max_probes = probes;
+        }
+        for (int i = 0; i < UID_TABLE_SLOTS; i++) {
+            const uint8_t* e = sector + i * UID_TABLE_SLOT;
+            if (e[0] == 0) {
+                return UID_TABLE_UNKNOWN;   // fim do bucket
+            }
+            if (e[0] == size && memcmp(e + 2, uid, size) == 0) {
+                return e[1] & FLAG_DENY ? UID_TABLE_DENY : UID_TABLE_ALLOW;
+            }
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    return UID_TABLE_UNKNOWN;
+}
+
+FRESULT uid_table_build(const char* base, const char* list_path, uint8_t* work,
+                        uint32_t work_sectors, uint32_t* entries) {
+    char line[64];
+    uint8_t entry[UID_TABLE_SLOT];
+    *entries = 0;
+    if (work_sectors < 4) {
+        return FR_INVALID_PARAMETER;
+    }
+    uint8_t* heads = work;
+    uint8_t* carry = work + UID_TABLE_SECTOR;
+    uint8_t* input = work + 2 * UID_TABLE_SECTOR;
+    uint8_t* range = work + 3 * UID_TABLE_SECTOR;
+
+    // Escreve sobre a cópia mais antiga (ou inválida)
+    table_header h[2];
+    int newest = newest_copy(base, h);
+    int copy = newest < 0 ? 0 : 1 - newest;
+    uint32_t generation = newest < 0 ? 1 : h[newest].generation + 1;
+
+    // 1ª leitura da lista: dimensiona a tabela e as faixas
+    FIL* list = &build_files[0];
+    FIL* temp = &build_files[1];
+    FRESULT fr = f_open(list, list_path, FA_READ);
+    if (fr != FR_OK) {
+        return fr;
+    }
+    uint32_t count = 0;
+    while (f_gets(line, sizeof(line), list)) {
+        count += parse_entry(line, entry);
+    }
+    uint32_t buckets = 1;
+    while ((uint64_t)buckets * UID_TABLE_SLOTS * LOAD_NUM < (uint64_t)count * LOAD_DEN) {
+        buckets <<= 1;
+    }
+    uint32_t mask = buckets - 1;
+    uint32_t per_range = work_sectors - 3;
+    if (per_range > buckets) per_range = buckets;
+    uint32_t ranges = (buckets + per_range - 1) / per_range;
+    if (ranges > MAX_RANGES) {
+        f_close(list);
+        return FR_NOT_ENOUGH_CORE;
+    }
+
+    // 2ª: distribui as entradas por faixa em <base>.tmp, tantas faixas por
+    // leitura quantos setores de trabalho houver
+    char temp_path[UID_TABLE_PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", base);
+    fr = f_open(temp, temp_path, FA_CREATE_ALWAYS | FA_WRITE | FA_READ);
+    if (fr != FR_OK) {
+        f_close(list);
+        return fr;
+    }
+    memset(heads, 0xFF, UID_TABLE_SECTOR);
+    uint32_t temp_sectors = 0;
+    uint32_t per_scan = work_sectors - 1;
+    for (uint32_t r0 = 0; r0 < ranges && fr == FR_OK; r0 += per_scan) {
+        uint32_t r1 = r0 + per_scan < ranges ? r0 + per_scan : ranges;
+        for (uint32_t r = r0; r < r1; r++) {
+            work[(1 + r - r0) * UID_TABLE_SECTOR + PART_COUNT] = 0;
+        }
+        fr = f_lseek(list, 0);
+        while (fr == FR_OK && f_gets(line, sizeof(line), list)) {
+            if (!parse_entry(line, entry)) {
+                continue;
+            }
+            uint32_t r = (uid_hash(entry + 2, entry[0]) & mask) / per_range;
+            if (r < r0 || r >= r1) {
+                continue;
+            }
+            uint8_t* part = work + (1 + r - r0) * UID_TABLE_SECTOR;
+            memcpy(part + part[PART_COUNT]++ * UID_TABLE_SLOT, entry, UID_TABLE_SLOT);
+            if (part[PART_COUNT] == UID_TABLE_SLOTS) {
+                fr = flush_part(temp, part, heads + 2 * r, &temp_sectors);
+            }
+        }
+        for (uint32_t r = r0; r < r1 && fr == FR_OK; r++) {
+            uint8_t* part = work + (1 + r - r0) * UID_TABLE_SECTOR;
+            if (part[PART_COUNT]) {
+                fr = flush_part(temp, part, heads + 2 * r, &temp_sectors);
+            }
+        }
+    }
+    f_close(list);
+
+    // 3ª: monta a tabela faixa a faixa, gravando em ordem. O cabeçalho fica
+    // zerado (inválido) até o fim
+    FIL* out = &build_files[0];
+    char path[UID_TABLE_PATH_MAX];
+    copy_path(path, base, copy);
+    if (fr == FR_OK) fr = f_open(out, path, FA_CREATE_ALWAYS | FA_WRITE | FA_READ);
+    if (fr != FR_OK) {
+        f_close(temp);
+        f_unlink(temp_path);
+        return fr;
+    }
+    f_expand(out, (FSIZE_t)(buckets + 1) * UID_TABLE_SECTOR, 1);
+    UINT n;
+    memset(input, 0, UID_TABLE_SECTOR);
+    fr = f_write(out, input, UID_TABLE_SECTOR, &n);
+    uint32_t carried = 0;
+    for (uint32_t r = 0; r < ranges && fr == FR_OK; r++) {
+        uint32_t first = r * per_range;
+        uint32_t nb = buckets - first < per_range ? buckets - first : per_range;
+        memset(range, 0, nb * UID_TABLE_SECTOR);
+        insert_carry(range, first, nb, carry, &carried, entries);
+
+        // Cadeia do fim para o começo: a última linha da lista vem primeiro
+        for (uint16_t s = get_u16(heads + 2 * r); s != CHAIN_END && fr == FR_OK;
+             s = get_u16(input + PART_PREV)) {
+            fr = f_lseek(temp, (FSIZE_t)s * UID_TABLE_SECTOR);
+            if (fr == FR_OK) fr = f_read(temp, input, UID_TABLE_SECTOR, &n);
+            if (fr == FR_OK && n != UID_TABLE_SECTOR) fr = FR_INT_ERR;
+            for (int i = input[PART_COUNT] - 1; i >= 0 && fr == FR_OK; i--) {
+                const uint8_t* e = input + i * UID_TABLE_SLOT;
+                uint32_t home = uid_hash(e + 2, e[0]) & mask;
+                if (insert_entry(range, first, nb, home, e, entries)) {
+                    continue;
+                }
+                if (carried == CARRY_MAX) {
+                    fr = FR_NOT_ENOUGH_CORE;    // faixa inteira cheia
+                } else {
+                    memcpy(carry + carried++ * UID_TABLE_SLOT, e, UID_TABLE_SLOT);
+                }
+            }
+        }
+        if (fr == FR_OK) fr = f_write(out, range, nb * UID_TABLE_SECTOR, &n);
+        if (fr == FR_OK && n != nb * UID_TABLE_SECTOR) fr = FR_DENIED;
+    }
+    f_close(temp);
+    f_unlink(temp_path);
+
+    // Transbordou do último bucket: continua no bucket 0, já gravado
+    for (uint32_t first = 0; fr == FR_OK && carried; first += per_range) {
+        uint32_t nb = buckets - first < per_range ? buckets - first : per_range;
+        if (first >= buckets) {
+            fr = FR_INT_ERR;                    // tabela cheia: não acontece a 3/4
+            break;
+        }
+        fr = f_lseek(out, (FSIZE_t)(first + 1) * UID_TABLE_SECTOR);
+        if (fr == FR_OK) fr = f_read(out, range, nb * UID_TABLE_SECTOR, &n);
+        insert_carry(range, first, nb, carry, &carried, entries);
+        if (fr == FR_OK) fr = f_lseek(out, (FSIZE_t)(first + 1) * UID_TABLE_SECTOR);
+        if (fr == FR_OK) fr = f_write(out, range, nb * UID_TABLE_SECTOR, &n);
+    }
+
+    // Cabeçalho por último: até aqui a cópia é inválida
+    if (fr == FR_OK) fr = f_sync(out);
+    if (fr == FR_OK) {
+        memset(input, 0, UID_TABLE_SECTOR);
+        memcpy(input, "UIDT", 4);
+        input[4] = VERSION;
+        input[5] = UID_TABLE_SLOT;
+        put_u32(input + 8, buckets);
+        put_u32(input + 12, *entries);
+        put_u32(input + 16, generation);
+        put_u32(input + 20, fnv1a(input, 20, 2166136261u));
+        fr = f_lseek(out, 0);
+        if (fr == FR_OK) fr = f_write(out, input, UID_TABLE_SECTOR, &n);
+    }
+    FRESULT close = f_close(out);
+    return fr != FR_OK ? fr : close;
+}
+
+void uid_table_get_stats(const uid_table* t, uid_table_stats* out) {
+    *out = t->stats;
+}
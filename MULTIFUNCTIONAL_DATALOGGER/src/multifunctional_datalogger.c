@@ -10,6 +10,7 @@
 #include "dht.h"
 #include "tcs34725.h"
 #include "max30102.h"
+#include "uid_table.h"
 #include "ff.h"
 #include "diskio.h"
 
@@ -42,6 +43,20 @@ int led_state = 0;
 absolute_time_t next_dht_read_time;
 absolute_time_t next_color_read_time;
 
+// Detecção de cartões com a antena do RC522 desligada entre as varreduras
+PICC_Poller rfid_poller;
+
+// Lista de acesso no SD (lib/uid_table): acesso_a.uid / acesso_b.uid. Um
+// acesso.txt novo no cartão (um UID por linha, '!' para bloquear) é
+// convertido e carregado sem reiniciar
+uid_table acesso;
+bool acesso_carregado = false;
+absolute_time_t next_acesso_check_time;
+// Buffer da conversão (uid_table_build): com 36 setores (18 KB) a lista é
+// lida duas vezes até ~32 mil UIDs; listas maiores são lidas mais vezes
+#define ACESSO_SETORES_TRABALHO 36
+static uint8_t acesso_trabalho[ACESSO_SETORES_TRABALHO * UID_TABLE_SECTOR];
+
 // ---> NOVAS VARIÁVEIS DE ESTADO para o Oxímetro
 typedef enum {
     OXIMETER_STATE_IDLE,      // 1. Aguardando dedo
@@ -175,21 +190,67 @@ void task_dht22_reader() {
     }
 }
 
-void task_rfid_reader(MFRC522Ptr_t rfid) {
-    if (PICC_IsNewCardPresent(rfid) && PICC_ReadCardSerial(rfid)) {
-        beep();
-        sleep_ms(50);
-        beep();
+// Converte um acesso.txt novo e passa para a geração mais nova da lista
+void task_access_list_update() {
+    if (!sd_initialized || !time_reached(next_acesso_check_time)) return;
+    next_acesso_check_time = make_timeout_time_ms(60000);
+
+    mutex_enter_blocking(&sd_card_mutex);
+    FILINFO info;
+    if (f_stat("acesso.txt", &info) == FR_OK) {
+        uint32_t uids;
+        FRESULT fr = uid_table_build("acesso", "acesso.txt", acesso_trabalho,
+                                     ACESSO_SETORES_TRABALHO, &uids);
+        if (fr == FR_OK) {
+            // Guarda a lista já carregada para não convertê-la de novo
+            f_unlink("acesso_carregado.txt");
+            f_rename("acesso.txt", "acesso_carregado.txt");
+            printf("[ACESSO] Lista convertida: %lu UIDs\n", (unsigned long)uids);
+        } else {
+            printf("[ACESSO] Falha ao converter acesso.txt (%d)\n", fr);
+        }
+    }
+    uint32_t geracao = acesso.generation;
+    FRESULT fr = acesso_carregado ? uid_table_reload(&acesso) : uid_table_open(&acesso, "acesso");
+    if (fr == FR_OK && (!acesso_carregado || acesso.generation != geracao)) {
+        printf("[ACESSO] Lista geracao %lu: %lu UIDs\n",
+               (unsigned long)acesso.generation, (unsigned long)acesso.entries);
+    }
+    acesso_carregado = acesso_carregado || fr == FR_OK;
+    mutex_exit(&sd_card_mutex);
+}
 
+void task_rfid_reader(MFRC522Ptr_t rfid) {
+    if (PICC_Poll(rfid, &rfid_poller)) {
         char uid_str[30] = {0};
         for (int i = 0; i < rfid->uid.size; i++) {
             sprintf(uid_str + strlen(uid_str), "%02X", rfid->uid.uidByte[i]);
         }
-        printf("[RFID] Cartao detectado! UID: %s\n", uid_str);
+
+        // Autorização pela lista do SD: no máximo um setor lido
+        const char* decisao = "sem lista";
+        uint32_t consulta_us = 0;
+        if (acesso_carregado) {
+            mutex_enter_blocking(&sd_card_mutex);
+            uint32_t inicio = time_us_32();
+            uid_table_result r = uid_table_lookup(&acesso, rfid->uid.uidByte, rfid->uid.size);
+            consulta_us = time_us_32() - inicio;
+            mutex_exit(&sd_card_mutex);
+            decisao = r == UID_TABLE_ALLOW ? "permitido" : r == UID_TABLE_DENY ? "negado" : "desconhecido";
+        }
+        if (!acesso_carregado || strcmp(decisao, "permitido") == 0) {
+            beep();
+            sleep_ms(50);
+            beep();
+        } else {
+            three_beeps();
+        }
+        printf("[RFID] Cartao detectado! UID: %s, %s (consulta em %lu us)\n",
+               uid_str, decisao, (unsigned long)consulta_us);
 
         char buffer[128];
-        snprintf(buffer, sizeof(buffer), "[RFID],Cartao lido: %s,%lu\n", 
-            uid_str, to_ms_since_boot(get_absolute_time()));
+        snprintf(buffer, sizeof(buffer), "[RFID],Cartao lido: %s %s,%lu\n", 
+            uid_str, decisao, to_ms_since_boot(get_absolute_time()));
         log_to_sd(buffer);
 
         PICC_HaltA(rfid);
@@ -315,20 +376,26 @@ int main() {
         set_led_color_pwm(1); while(1);
     }
 
+    // Com o IRQ do RC522 ligado a um GPIO livre (IRQ_PIN em mfrc522.h ou
+    // PCD_SetIrqPin; o GP22 é o detector do cartão SD em hw_config.c, hoje
+    // desativado), a espera pelo cartão não ocupa o SPI nem o processador
     MFRC522Ptr_t rfid = MFRC522_Init();
     PCD_Init(rfid, spi0);
+    PICC_PollInit(rfid, &rfid_poller);
     
     printf("\nSistema pronto e operacional. Aguardando eventos...\n");
 
     // Agenda as primeiras leituras
     next_dht_read_time = get_absolute_time();
     next_color_read_time = get_absolute_time();
+    next_acesso_check_time = get_absolute_time();
 
     // Loop principal não-bloqueante
     while (1) {
         cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
         
         task_dht22_reader();
+        task_access_list_update();
         task_rfid_reader(rfid);
         task_color_sensor_reader();
         task_button_handler();
@@ -21,6 +21,8 @@
 #include <string.h> //some functions need NULL to be defined
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
 
 /*******************************************************************************
  * Types/enumerations/variables
@@ -33,6 +35,19 @@
 #define MFRC_MAX_INSTANCES 2	 
 // Reset pin to MFRC522
 #define RESET_PIN 20
+// IRQ pin of the MFRC522 (active low, push-pull). When a reader has one,
+// commands and CRC calculations wait on it instead of polling
+// ComIrqReg/DivIrqReg over SPI, and the core sleeps meanwhile. Wire the
+// module's IRQ pad to a free GPIO first: an unconnected, pulled-up pin never
+// goes low and every command would time out. Defining IRQ_PIN gives it to
+// the first reader from MFRC522_Init(); each reader needs its own line, set
+// with PCD_SetIrqPin() before PCD_Init(). Left undefined, registers are
+// polled as before.
+//#define IRQ_PIN 22
+// Emergency breaks for a command or CRC calculation that never signals.
+// Transceive normally ends on the MFRC522 timer (TimerIRq) after 25ms.
+#define MFRC522_COMMAND_TIMEOUT_MS 36
+#define MFRC522_CRC_TIMEOUT_MS 90
 
 static const uint8_t FIFO_SIZE = 64; // Size of the MFRC522 FIFO
 
@@ -306,11 +321,54 @@ struct MFRC522_T {
 	uint _chipSelectPin; // = {1, 8}; // As default example use GPIO1[8]= P1_5
 	uint8_t Tx_Buf[BUFFER_SIZE];
 	uint8_t Rx_Buf[BUFFER_SIZE];
+	uint8_t _comIEn; // Last values written to ComIEnReg and DivIEnReg
+	uint8_t _divIEn;
+	int _irqPin; // GPIO wired to the IRQ pin, -1 to poll the registers
+	void (*waitHook)(void); // Called while waiting for the MFRC522, see PCD_SetWaitHook()
 };
 
 // Pointer to a MFRC5222 ADT object
 typedef struct MFRC522_T *MFRC522Ptr_t;
 
+// State of the low-power card detection, see PICC_Poll()
+typedef struct {
+	// Configuration, set by PICC_PollInit() and adjustable afterwards
+	uint32_t fastIntervalMs; // Interval between polls right after activity
+	uint32_t idleIntervalMs; // Longest interval, reached after idle polls
+	uint32_t fieldGuardUs;   // Unmodulated field before REQA so a card can
+							 // power up (5ms in ISO/IEC 14443-3)
+	uint32_t probeTimeoutUs; // Wait for the ATQA (sent ~90us after REQA)
+	bool powerDown;			 // Soft power-down of the MFRC522 between polls
+	// State
+	uint32_t intervalMs;
+	absolute_time_t nextPoll;
+	uint64_t lastPollUs;  // Last poll that reported no card
+	uint64_t fieldOnUs;   // Antenna switched on at, 0 if off
+	bool asleep;		  // Powered down by the poller, woken by the next poll
+	Uid lastUid;		  // Last card reported
+	bool lastPresent;	  // lastUid answered every poll since it was reported
+	// Statistics
+	uint32_t polls;		  // Field bursts
+	uint32_t responses;   // Bursts answered with an ATQA
+	uint32_t detections;  // Cards selected
+	uint32_t repeats;	  // Polls that found the last card still there
+	uint64_t busyUs;	  // Time spent inside PICC_Poll() bursts
+	uint64_t fieldUs;	  // Time with the antenna on
+	uint64_t latencyUs;   // Sum of detection latency bounds
+	uint32_t maxLatencyUs;
+	uint64_t startUs;	  // Statistics cleared at
+} PICC_Poller;
+
+// Timing of a PICC_Inventory() sweep
+typedef struct {
+	uint32_t elapsedUs;	// Whole sweep
+	uint32_t perTagUs;	 // elapsedUs / tags found in the sweep
+	uint32_t maxTagUs;	 // Slowest tag (REQA to HLTA)
+	uint16_t requests;	 // REQA sent
+	uint16_t collisions;   // ATQA collisions (more than one tag answered)
+	uint16_t failures;	 // Selects that failed or returned a tag twice
+} PICC_InventoryStats;
+
 /**
  * Function to setup a MFRC522 ADT object
  * @return an initialized  ADT object
@@ -340,6 +398,8 @@ static inline void cs_deselect(const uint cs);
 * Functions for manipulating the MFRC522
 *******************************************************************************/
 void PCD_Init(MFRC522Ptr_t mfrc, spi_inst_t *spi);
+void PCD_SetIrqPin(MFRC522Ptr_t mfrc, int pin);
+void PCD_SetWaitHook(MFRC522Ptr_t mfrc, void (*hook)(void));
 void PCD_Reset(MFRC522Ptr_t mfrc);
 void PCD_AntennaOn(MFRC522Ptr_t mfrc);
 void PCD_AntennaOff(MFRC522Ptr_t mfrc);
@@ -423,4 +483,19 @@ bool MIFARE_UnbrickUidSector(MFRC522Ptr_t mfrc, bool logErrors);
 bool PICC_IsNewCardPresent(MFRC522Ptr_t mfrc);
 bool PICC_ReadCardSerial(MFRC522Ptr_t mfrc);
 
+/*******************************************************************************
+* Low-power card detection
+*******************************************************************************/
+void PICC_PollInit(MFRC522Ptr_t mfrc, PICC_Poller *poller);
+bool PICC_Poll(MFRC522Ptr_t mfrc, PICC_Poller *poller);
+uint32_t PICC_PollWaitMs(PICC_Poller *poller);
+void PICC_DumpPollStatsToSerial(PICC_Poller *poller);
+
+/*******************************************************************************
+* Multi-tag inventory
+*******************************************************************************/
+StatusCode PICC_Inventory(MFRC522Ptr_t mfrc, Uid *uids, uint8_t *count,
+						  uint8_t known, uint32_t timeoutMs,
+						  PICC_InventoryStats *stats);
+
 #endif
\ No newline at end of file
@@ -7,6 +7,15 @@
 
 const uint BUZZER_PIN = 21;
 
+// Intervalo entre os relatórios da detecção de cartões
+#define RELATORIO_MS 30000
+
+// 1 = lê todas as tags do campo a cada detecção (bandejas, portais), em vez
+// de só a primeira
+#define MODO_INVENTARIO 0
+#define INVENTARIO_MAX 32
+#define INVENTARIO_TEMPO_MS 500
+
 void beep() {
     // Busca a "fatia" (slice) do hardware PWM correspondente ao nosso pino
     uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
@@ -18,6 +27,39 @@ void beep() {
     pwm_set_enabled(slice_num, false);
 }
 
+void imprime_uid(const Uid* uid) {
+    for (uint8_t i = 0; i < uid->size; i++) {
+        printf("%02X", uid->uidByte[i]);
+        if (i < uid->size - 1) {
+            printf(":");
+        }
+    }
+    printf("\n");
+}
+
+#if MODO_INVENTARIO
+// A varredura já selecionou uma tag (rfid->uid); PICC_Inventory lê as demais.
+// Ela vai como conhecida em uids[0], para não ser listada de novo se o HaltA
+// não chegar até ela
+void inventario(MFRC522Ptr_t rfid) {
+    static Uid uids[INVENTARIO_MAX];
+    uids[0] = rfid->uid;
+    PICC_HaltA(rfid);
+
+    uint8_t n = INVENTARIO_MAX;
+    PICC_InventoryStats st;
+    StatusCode status = PICC_Inventory(rfid, uids, &n, 1, INVENTARIO_TEMPO_MS, &st);
+
+    printf("Inventario: %u tags em %lu us (%lu us por tag, max %lu us), %u REQA, %u colisoes, %u falhas: %s\n",
+           n, (unsigned long)st.elapsedUs, (unsigned long)st.perTagUs, (unsigned long)st.maxTagUs,
+           st.requests, st.collisions, st.failures, GetStatusCodeName(status));
+    for (uint8_t i = 0; i < n; i++) {
+        printf("  %2u: ", i + 1);
+        imprime_uid(&uids[i]);
+    }
+}
+#endif
+
 int main() {
     // Inicializa a saída serial via USB
     stdio_init_all();
@@ -44,36 +86,45 @@ int main() {
     pwm_set_enabled(slice_num, false);
     // --- Fim da configuração do PWM ---
 
-    // Inicialização do leitor RFID
+    // Inicialização do leitor RFID. Com o IRQ do RC522 ligado a um GPIO
+    // livre (IRQ_PIN em mfrc522.h ou PCD_SetIrqPin), o processador dorme
+    // enquanto espera a resposta do cartão; sem ele, os registradores são lidos
     MFRC522Ptr_t rfid = MFRC522_Init();
     PCD_Init(rfid, spi0);
     
+    // Detecção de baixo consumo: antena desligada entre as varreduras, que
+    // ficam mais espaçadas enquanto nenhum cartão aparece. Um cartão deixado
+    // sobre o leitor é informado uma vez só, até ser retirado
+    PICC_Poller poller;
+    PICC_PollInit(rfid, &poller);
+    absolute_time_t proximo_relatorio = make_timeout_time_ms(RELATORIO_MS);
+
     printf("Leitor pronto! Aproxime um cartao ou tag.\n");
 
     while (1) {
-        if (PICC_IsNewCardPresent(rfid)) {
-            
-            if (PICC_ReadCardSerial(rfid)) {
-                
-                // NOVO: Chama a função de beep duas vezes
-                beep();
-                sleep_ms(100); // Uma pequena pausa entre os bipes
-                beep();
-
-                // Imprime o UID do cartão no monitor serial
-                printf("Cartao detectado! UID: ");
-                for (uint8_t i = 0; i < rfid->uid.size; i++) {
-                    printf("%02X", rfid->uid.uidByte[i]);
-                    if (i < rfid->uid.size - 1) {
-                        printf(":");
-                    }
-                }
-                printf("\n");
-
-                PICC_HaltA(rfid);
-            }
+        if (PICC_Poll(rfid, &poller)) {
+            // NOVO: Chama a função de beep duas vezes
+            beep();
+            sleep_ms(100); // Uma pequena pausa entre os bipes
+            beep();
+
+#if MODO_INVENTARIO
+            inventario(rfid);
+#else
+            // Imprime o UID do cartão no monitor serial
+            printf("Cartao detectado! UID: ");
+            imprime_uid(&rfid->uid);
+
+            PICC_HaltA(rfid);
+#endif
+        }
+
+        // Custo médio das varreduras e latência de detecção
+        if (time_reached(proximo_relatorio)) {
+            PICC_DumpPollStatsToSerial(&poller);
+            proximo_relatorio = make_timeout_time_ms(RELATORIO_MS);
         }
-        sleep_ms(100);
+        sleep_ms(PICC_PollWaitMs(&poller));
     }
     return 0;
 }
\ No newline at end of file
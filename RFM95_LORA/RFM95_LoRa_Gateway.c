@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "rfm95_lora.h"
+#include "lora_gateway.h"
+#include "lora_queue.h"
+#include "lora_relay.h"
+#include "lora_telemetry.h"
+
+// Gateway LoRa no Pico (substitui o ESP32_LoRa_Receiver): recebe os pacotes
+// dos nós em recepção contínua, imprime pela USB e responde com o relatório
+// de enlace (SNR para o ADR e ACK para a entrega confirmada). Pacotes que
+// chegam por relés (RFM95_LoRa_Relay) são respondidos pelo mesmo caminho.
+
+// Intervalo entre as estatísticas impressas
+#define ESTATISTICAS_MS 10000
+
+// Despertar da recepção dos nós (LORA_DESPERTAR_MS no nó): o preâmbulo das
+// respostas precisa cobri-lo
+#define NOS_DESPERTAR_MS 50
+
+// 1 = rede com relés: os relés ouvem os dois sentidos, então as respostas
+// saem com I/Q normal (LORA_ROTEADO nos nós)
+#define REDE_COM_RELES 0
+
+// Canais do plano de saltos dos nós (LORA_CANAIS no nó); 1 = canal fixo.
+// Com mais de um, o rádio varre os canais por CAD, VARREDURA_MS em cada, e
+// responde no canal que lora_frame_channel dá ao pacote
+#define LORA_CANAIS 1
+#define VARREDURA_MS 3
+
+// Sequências recebidas de cada nó, para duplicatas e ACKs
+static lora_ack_window janelas[256];
+
+// Séries preditivas (lora_series) de cada nó
+static lora_series_rx series[256];
+
+/* Imprime uma leitura decodificada de um pacote binário */
+static void imprime_leitura(lora_sensor type, uint8_t index, int32_t value, void* ctx) {
+    int scale = lora_sensor_scale(type);
+    if (scale == 1) {
+        printf("  %s [%u] %ld %s\n", lora_sensor_name(type), index, (long)value, lora_sensor_unit(type));
+    } else {
+        printf("  %s [%u] %.*f %s\n", lora_sensor_name(type), index,
+               scale >= 1000 ? 3 : scale >= 100 ? 2 : 1, (double)value / scale, lora_sensor_unit(type));
+    }
+}
+
+/* Leituras de uma série que não podem ser reconstruídas (pacotes perdidos) */
+static void imprime_lacuna(lora_sensor type, uint8_t missing, void* ctx) {
+    printf("  %s: lacuna de %u leituras\n", lora_sensor_name(type), missing);
+}
+
+/* Responde ao nó com SNR, RSSI e o ACK das sequências recentes */
+static void envia_relatorio(const lora_frame_header* header, const lora_gateway_packet* p) {
+    const lora_ack_window* w = &janelas[header->node];
+    uint8_t buf[32];
+    lora_frame f;
+    lora_frame_begin(&f, buf, sizeof(buf), header->node, header->seq,
+                     LORA_FLAG_CONTROL | (header->flags & LORA_FLAG_ROUTED));
+    lora_frame_add(&f, LORA_SENSOR_SNR, (int32_t)(p->snr * 4));
+    lora_frame_add(&f, LORA_SENSOR_RSSI, p->rssi);
+    lora_frame_add(&f, LORA_SENSOR_ACK, w->last);
+    lora_frame_add(&f, LORA_SENSOR_ACK, (int32_t)w->bitmap);
+    lora_relay_prepare(buf, lora_frame_size(&f));    // volta pelo relé que o trouxe
+    lora_queue_send(buf, lora_frame_size(&f), LORA_PRIORITY_HIGH);
+}
+
+static void trata_pacote(const lora_gateway_packet* p) {
+    // Cópias de um pacote roteado que chegam por mais de um caminho
+    if (!lora_relay_receive(p->data, p->size, p->rssi)) {
+        return;
+    }
+    printf("[%10.3f s] RSSI %d dBm, SNR %.1f dB: ", p->timestamp_us / 1e6, p->rssi, p->snr);
+
+    lora_frame_header header;
+    int leituras = lora_frame_decode(p->data, p->size, &header, NULL, NULL);
+    if (leituras < 0) {
+        // Texto de nós antigos
+        printf("'%.*s'\n", p->size, (const char*)p->data);
+        return;
+    }
+    if (header.flags & LORA_FLAG_CONTROL) {
+        printf("controle para o no %u (ignorado)\n", header.node);
+        return;
+    }
+
+    bool duplicado = !lora_ack_track(&janelas[header.node], header.seq);
+    printf("no %u seq %u%s%s: %d leituras em %u bytes", header.node, header.seq,
+           header.flags & LORA_FLAG_ALERT ? " ALERTA" : "", duplicado ? " (duplicado)" : "",
+           leituras, p->size);
+    if (header.route.hops > 0) {
+        printf(" (%u saltos, ultimo pelo rele %u)", header.route.hops, header.route.sender);
+    }
+    printf("\n");
+    if (!duplicado) {
+        lora_frame_decode_series(p->data, p->size, &header, &series[header.node],
+                                 imprime_leitura, imprime_lacuna, NULL);
+    }
+    // Duplicatas são retransmissões cujo ACK se perdeu: confirma de novo
+    envia_relatorio(&header, p);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+    printf("Iniciando Gateway LoRa (RX)...\n");
+
+    if (!lora_init()) {
+        printf("Falha na comunicacao com o RFM95. Travando. ❌\n");
+        while(1);
+    }
+    printf("Comunicacao com RFM95 OK! ✅\n");
+
+    lora_set_power(17);
+#if REDE_COM_RELES
+    lora_set_invert_iq(false, false);
+#else
+    // Respostas com I/Q invertido (só os nós as ouvem) e preâmbulo longo; o
+    // LBT adia uma resposta enquanto outro nó transmite
+    lora_set_invert_iq(true, false);
+    lora_set_preamble_length(lora_wake_preamble_length(NOS_DESPERTAR_MS));
+#endif
+    lora_set_listen_before_talk(4);
+    lora_relay_config relay_cfg;
+    lora_relay_default_config(&relay_cfg, LORA_ROUTE_GATEWAY);
+    lora_relay_init(&relay_cfg);
+    lora_queue_init(1.0f, 0);       // respostas sem limite de ciclo de trabalho
+#if LORA_CANAIS > 1
+    long canais[LORA_CANAIS];
+    for (int i = 0; i < LORA_CANAIS; i++)
+        canais[i] = (long)LORA_FREQUENCY_HZ + i * LORA_CHANNEL_SPACING_HZ;
+    lora_set_channel_plan(canais, LORA_CANAIS, lora_frame_channel);
+#endif
+    lora_gateway_start();
+#if LORA_CANAIS > 1
+    lora_receive_scan(VARREDURA_MS);
+#endif
+
+    absolute_time_t proximas_estatisticas = make_timeout_time_ms(ESTATISTICAS_MS);
+    lora_gateway_packet pacote;
+
+    while (1) {
+        while (lora_gateway_pop(&pacote)) {
+            trata_pacote(&pacote);
+        }
+
+        if (time_reached(proximas_estatisticas)) {
+            lora_gateway_stats st;
+            lora_gateway_get_stats(&st);
+            printf("Gateway: %lu recebidos, %lu erros de CRC, %lu perdidos (buffer cheio), ocupacao max %u/%u\n",
+                   (unsigned long)st.received, (unsigned long)st.crc_errors,
+                   (unsigned long)st.overflows, st.max_pending, LORA_GATEWAY_SLOTS);
+            proximas_estatisticas = make_timeout_time_ms(ESTATISTICAS_MS);
+        }
+        sleep_ms(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "rfm95_lora.h"
+#include "lora_gateway.h"
+#include "lora_queue.h"
+#include "lora_relay.h"
+
+// Relé LoRa no Pico: fica em recepção contínua entre o gateway e os nós fora
+// do alcance dele e encaminha os pacotes roteados (lora_relay.h) nos dois
+// sentidos. Nós e gateway precisam de LORA_ROTEADO / REDE_COM_RELES.
+
+// Id do relé nos pacotes; não pode coincidir com o de um nó
+#define RELE_ID 200
+
+// Intervalo entre as estatísticas impressas
+#define ESTATISTICAS_MS 10000
+
+static void imprime_estatisticas() {
+    lora_relay_stats rs;
+    lora_queue_stats qs;
+    lora_gateway_stats gs;
+    lora_relay_get_stats(&rs);
+    lora_queue_get_stats(&qs);
+    lora_gateway_get_stats(&gs);
+
+    printf("Rele: %lu recebidos, %lu encaminhados (%lu alertas, %lu bytes), %lu duplicatas, "
+           "%lu no limite de saltos, %lu recusados pela fila\n",
+           (unsigned long)rs.received, (unsigned long)rs.forwarded, (unsigned long)rs.forwarded_alerts,
+           (unsigned long)rs.forwarded_bytes, (unsigned long)rs.duplicates,
+           (unsigned long)rs.hop_limit, (unsigned long)rs.queue_full);
+    printf("Rota: %u saltos ate o gateway, proximo salto %u, %u vizinhos, %u rotas de volta\n",
+           rs.distance, rs.next_hop, rs.neighbors, rs.routes);
+    printf("Fila: %u (max %u), espera media %.1f ms, max %.1f ms, %lu descartados, %lu perdidos no buffer\n",
+           qs.depth, qs.max_depth, qs.sent ? qs.wait_us / 1e3 / qs.sent : 0.0, qs.max_wait_us / 1e3,
+           (unsigned long)qs.dropped, (unsigned long)gs.overflows);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+    printf("Iniciando Rele LoRa...\n");
+
+    if (!lora_init()) {
+        printf("Falha na comunicacao com o RFM95. Travando. ❌\n");
+        while(1);
+    }
+    printf("Comunicacao com RFM95 OK! ✅\n");
+
+    lora_set_power(17);
+    lora_set_invert_iq(false, false);   // ouve uplinks e respostas do gateway
+    lora_set_listen_before_talk(4);
+    lora_queue_init(1.0f, 0);           // alimentado pela rede, como o gateway
+
+    lora_relay_config relay_cfg;
+    lora_relay_default_config(&relay_cfg, RELE_ID);
+    relay_cfg.forward = true;
+    lora_relay_init(&relay_cfg);
+    lora_gateway_start();
+
+    absolute_time_t proximas_estatisticas = make_timeout_time_ms(ESTATISTICAS_MS);
+    lora_gateway_packet pacote;
+
+    while (1) {
+        while (lora_gateway_pop(&pacote)) {
+            lora_relay_receive(pacote.data, pacote.size, pacote.rssi);
+        }
+
+        if (time_reached(proximas_estatisticas)) {
+            imprime_estatisticas();
+            proximas_estatisticas = make_timeout_time_ms(ESTATISTICAS_MS);
+        }
+        sleep_ms(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef SIM_HARDWARE_DMA_H
+#define SIM_HARDWARE_DMA_H
+
+#include "pico/stdlib.h"
+
+// DMA entre memória e o registrador de dados do SPI simulado. Os canais
+// rodam na hora em que são disparados: os que escrevem no SPI trocam os
+// bytes com o rádio e guardam as respostas, que os canais que leem do SPI
+// recolhem em seguida (dma_start_channel_mask dispara as escritas primeiro).
+
+typedef struct {
+    uint8_t size;
+    bool read_inc, write_inc;
+} dma_channel_config;
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config* c, bool incr);
+void channel_config_set_write_increment(dma_channel_config* c, bool incr);
+void channel_config_set_dreq(dma_channel_config* c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_FUNC_SPI 1
+
+#define GPIO_IRQ_LEVEL_LOW  0x1u
+#define GPIO_IRQ_LEVEL_HIGH 0x2u
+#define GPIO_IRQ_EDGE_FALL  0x4u
+#define GPIO_IRQ_EDGE_RISE  0x8u
+
+typedef void (*irq_handler_t)(void);
+
+void gpio_init(unsigned int gpio);
+void gpio_set_dir(unsigned int gpio, bool out);
+void gpio_put(unsigned int gpio, bool value);
+bool gpio_get(unsigned int gpio);
+void gpio_set_function(unsigned int gpio, unsigned int fn);
+void gpio_pull_up(unsigned int gpio);
+
+void gpio_set_irq_enabled(unsigned int gpio, uint32_t events, bool enabled);
+void gpio_add_raw_irq_handler(unsigned int gpio, irq_handler_t handler);
+uint32_t gpio_get_irq_event_mask(unsigned int gpio);
+void gpio_acknowledge_irq(unsigned int gpio, uint32_t events);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef SIM_HARDWARE_IRQ_H
+#define SIM_HARDWARE_IRQ_H
+
+#include <stdbool.h>
+
+#define IO_IRQ_BANK0 13
+
+void irq_set_enabled(unsigned int num, bool enabled);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef SIM_HARDWARE_SPI_H
+#define SIM_HARDWARE_SPI_H
+
+#include "pico/stdlib.h"
+
+typedef struct spi_inst spi_inst_t;
+typedef struct {
+    volatile uint32_t dr;           // endereço usado pelos canais de DMA
+} spi_hw_t;
+
+extern spi_inst_t sim_spi_inst;
+#define spi0 (&sim_spi_inst)
+#define spi1 (&sim_spi_inst)
+
+typedef enum { SPI_CPOL_0, SPI_CPOL_1 } spi_cpol_t;
+typedef enum { SPI_CPHA_0, SPI_CPHA_1 } spi_cpha_t;
+typedef enum { SPI_LSB_FIRST, SPI_MSB_FIRST } spi_order_t;
+
+uint spi_init(spi_inst_t* spi, uint baudrate);
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len);
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len);
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len);
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx);
+spi_hw_t* spi_get_hw(spi_inst_t* spi);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+// O simulador é de uma thread só e entrega as interrupções entre as chamadas
+// ao código dos nós, então desativar interrupções não precisa fazer nada
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+static inline void __dmb(void) {}
+
+#endif
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lora_telemetry.h"
+
+// Bits por leitura de cada codificação de lib/lora_telemetry.h em séries de
+// sensores, e a reconstrução no gateway com pacotes perdidos:
+//
+//   ./build-host/lora_codec_bench                   séries de host/traces
+//   ./build-host/lora_codec_bench -l 20 -p 0.2 captura.csv
+//
+// Arquivo de série: um valor por linha em ponto fixo do tipo (lora_sensor_scale),
+// linhas com # são comentários, "# sensor <nome>" dá o tipo e "# passo <n>" a
+// resolução do sensor nessa unidade (lora_series.step). Conta só os
+// bytes dos blocos (o cabeçalho do pacote é o mesmo em todas). Colunas:
+//   abs32   valor inteiro de 32 bits por leitura
+//   delta   bloco simples: primeiro valor e diferenças, recomeçando a cada pacote
+//   o0..o3  bloco preditivo de ordem fixa (o0 = valor, o2 = diferença da diferença)
+//   auto    ordem escolhida pelo codificador
+// Com perdas (-p), o decodificador com lora_series_rx recebe só os pacotes
+// que chegaram: rec% das leituras reconstruídas, lac% avisadas como lacuna e
+// erros (valor reconstruído diferente do original, deve ser 0).
+//
+// Opções:
+//   -l n        leituras por pacote (10)
+//   -k n        blocos por quadro-chave (8)
+//   -p fração   pacotes perdidos (0.1)
+//   -s semente  (1)
+
+#ifndef TRACE_DIR
+#define TRACE_DIR "traces"
+#endif
+
+#define MAX_SAMPLES 100000
+
+static const char* default_traces[] = {
+    "vl53l0x_distancia.csv", "ina219_corrente.csv", "ina219_tensao.csv",
+    "dht22_temperatura.csv", "dht22_umidade.csv",
+};
+
+typedef struct {
+    lora_sensor type;
+    int32_t step;
+    int32_t* values;
+    int count;
+} trace;
+
+// Conferência da decodificação
+typedef struct {
+    const trace* t;
+    int base;                       // primeira leitura do pacote
+    uint32_t decoded, gaps, errors;
+} check_ctx;
+
+static uint32_t rng_state = 1;
+
+static double random01() {
+    rng_state = rng_state * 1664525 + 1013904223;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static bool load_trace(const char* path, trace* t) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    t->type = 0;
+    t->step = 1;
+    t->count = 0;
+    t->values = malloc(MAX_SAMPLES * sizeof(int32_t));
+    char line[256];
+    while (fgets(line, sizeof(line), f) && t->count < MAX_SAMPLES) {
+        char name[32];
+        if (line[0] == '#') {
+            sscanf(line, "# passo %d", &t->step);
+            if (sscanf(line, "# sensor %31s", name) == 1) {
+                for (int s = 1; s < LORA_SENSOR_COUNT; s++) {
+                    if (strcmp(lora_sensor_name(s), name) == 0)
+                        t->type = s;
+                }
+            }
+            continue;
+        }
+        // Aceita "valor" ou "tempo,valor"
+        char* comma = strrchr(line, ',');
+        char* end;
+        long v = strtol(comma ? comma + 1 : line, &end, 10);
+        if (end != (comma ? comma + 1 : line))
+            t->values[t->count++] = (int32_t)v;
+    }
+    fclose(f);
+    if (!t->type) {
+        fprintf(stderr, "%s: falta a linha '# sensor <nome>'\n", path);
+        return false;
+    }
+    return t->count > 0;
+}
+
+static void on_reading(lora_sensor type, uint8_t index, int32_t value, void* ctx) {
+    check_ctx* c = ctx;
+    c->decoded++;
+    if (c->base + index >= c->t->count || c->t->values[c->base + index] != value)
+        c->errors++;
+}
+
+static void on_gap(lora_sensor type, uint8_t missing, void* ctx) {
+    ((check_ctx*)ctx)->gaps += missing;
+}
+
+/* Codifica a série em pacotes de per_frame leituras e devolve os bits por
+   leitura. order < 0 usa o bloco simples; loss > 0 descarta pacotes antes do
+   decodificador, que acumula em c */
+static double encode(const trace* t, int per_frame, int order, int keyframe, double loss,
+                     check_ctx* c) {
+    lora_series series;
+    lora_series_init(&series, t->type, (uint8_t)keyframe);
+    if (order >= 0)
+        series.order = (uint8_t)order;
+    series.step = t->step;
+    lora_series_rx rx;
+    memset(&rx, 0, sizeof(rx));
+    memset(c, 0, sizeof(*c));
+    c->t = t;
+
+    uint64_t bytes = 0;
+    uint16_t seq = 0;
+    for (int base = 0; base < t->count; base += per_frame) {
+        uint8_t buf[255];
+        lora_frame f;
+        lora_frame_begin(&f, buf, sizeof(buf), 1, seq++, 0);
+        for (int i = base; i < base + per_frame && i < t->count; i++) {
+            bool ok = order < 0 ? lora_frame_add(&f, t->type, t->values[i])
+                                : lora_frame_add_series(&f, &series, t->values[i]);
+            if (!ok) {
+                fprintf(stderr, "lora_codec_bench: pacote cheio (-l muito grande)\n");
+                exit(1);
+            }
+        }
+        bytes += lora_frame_size(&f) - LORA_FRAME_HEADER;
+        if (loss > 0 && random01() < loss)
+            continue;
+        lora_frame_header header;
+        c->base = base;
+        lora_frame_decode_series(buf, lora_frame_size(&f), &header, &rx, on_reading, on_gap, c);
+    }
+    return 8.0 * bytes / t->count;
+}
+
+int main(int argc, char** argv) {
+    int per_frame = 10, keyframe = 8;
+    double loss = 0.1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "l:k:p:s:")) != -1) {
+        switch (opt) {
+        case 'l': per_frame = atoi(optarg); break;
+        case 'k': keyframe = atoi(optarg); break;
+        case 'p': loss = atof(optarg); break;
+        case 's': rng_state = (uint32_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "uso: %s [-l leituras_por_pacote] [-k quadro_chave] [-p perda] [-s semente] [séries...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (per_frame < 1 || per_frame > 255 || keyframe < 0 || keyframe > 255 || loss < 0 || loss >= 1) {
+        fprintf(stderr, "lora_codec_bench: parâmetros inválidos\n");
+        return 1;
+    }
+
+    printf("%d leituras por pacote, quadro-chave a cada %d blocos, perda de %.0f%% dos pacotes\n",
+           per_frame, keyframe, loss * 100);
+    printf("%-24s %6s %6s %6s %6s %6s %6s %6s %6s | %6s %6s %6s\n", "serie", "leit", "abs32", "delta",
+           "o0", "o1", "o2", "o3", "auto", "rec%", "lac%", "erros");
+
+    int files = optind < argc ? argc - optind : (int)(sizeof(default_traces) / sizeof(default_traces[0]));
+    trace* traces = calloc(files, sizeof(trace));
+    int loaded = 0;
+    bool ok = true;
+    for (int i = 0; i < files; i++) {
+        char path[512];
+        const char* name = optind < argc ? argv[optind + i] : default_traces[i];
+        if (optind < argc)
+            snprintf(path, sizeof(path), "%s", name);
+        else
+            snprintf(path, sizeof(path), "%s/%s", TRACE_DIR, name);
+
+        trace* t = &traces[loaded];
+        if (!load_trace(path, t)) {
+            ok = false;
+            continue;
+        }
+        loaded++;
+        const char* base = strrchr(name, '/');
+        printf("%-24s %6d %6.1f", base ? base + 1 : name, t->count, 32.0);
+
+        check_ctx c;
+        uint32_t errors = 0;
+        for (int order = -1; order <= 3; order++) {
+            printf(" %6.2f", encode(t, per_frame, order, keyframe, 0, &c));
+            // Sem perdas, toda leitura volta exata
+            errors += c.errors + (uint32_t)(t->count - c.decoded);
+        }
+        printf(" %6.2f", encode(t, per_frame, LORA_SERIES_AUTO, keyframe, 0, &c));
+        errors += c.errors + (uint32_t)(t->count - c.decoded);
+
+        encode(t, per_frame, LORA_SERIES_AUTO, keyframe, loss, &c);
+        printf(" | %6.1f %6.1f %6u\n", 100.0 * c.decoded / t->count, 100.0 * c.gaps / t->count,
+               c.errors + errors);
+    }
+
+    // Custo e resistência a perdas de cada intervalo de quadros-chave, somando
+    // as séries (0 = só o primeiro bloco)
+    static const int intervals[] = { 1, 2, 4, 8, 16, 0 };
+    printf("\nquadro-chave  bits/leit    rec%%    lac%%  (ordem auto, perda de %.0f%%)\n", loss * 100);
+    for (size_t k = 0; k < sizeof(intervals) / sizeof(intervals[0]) && loaded; k++) {
+        double bits = 0;
+        uint64_t samples = 0, decoded = 0, gaps = 0;
+        for (int i = 0; i < loaded; i++) {
+            check_ctx c;
+            bits += encode(&traces[i], per_frame, LORA_SERIES_AUTO, intervals[k], 0, &c) * traces[i].count;
+            encode(&traces[i], per_frame, LORA_SERIES_AUTO, intervals[k], loss, &c);
+            samples += traces[i].count;
+            decoded += c.decoded;
+            gaps += c.gaps;
+        }
+        printf("%12d %10.2f %7.1f %7.1f\n", intervals[k], bits / samples,
+               100.0 * decoded / samples, 100.0 * gaps / samples);
+    }
+
+    for (int i = 0; i < loaded; i++)
+        free(traces[i].values);
+    free(traces);
+    return ok ? 0 : 1;
+}
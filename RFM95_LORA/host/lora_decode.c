@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "lora_telemetry.h"
+
+// Decodifica pacotes de telemetria LoRa escritos em hexadecimal, um por
+// linha (espaços opcionais), como registrados pelo receptor:
+//
+//   echo "B1 01 01 07 00 01 01 68" | lora_decode
+//
+// Linhas que não são pacotes binários válidos são repetidas como texto. As
+// séries preditivas de cada nó são acompanhadas entre os pacotes, que devem
+// estar na ordem de chegada.
+
+static lora_series_rx series[256];
+
+static void print_reading(lora_sensor type, uint8_t index, int32_t value, void* ctx) {
+    int scale = lora_sensor_scale(type);
+    if (scale == 1)
+        printf("  %-12s [%3u] %ld %s\n", lora_sensor_name(type), index, (long)value, lora_sensor_unit(type));
+    else
+        printf("  %-12s [%3u] %.*f %s\n", lora_sensor_name(type), index,
+               scale >= 1000 ? 3 : scale >= 100 ? 2 : 1, (double)value / scale, lora_sensor_unit(type));
+}
+
+static void print_gap(lora_sensor type, uint8_t missing, void* ctx) {
+    printf("  %-12s lacuna de %u leituras\n", lora_sensor_name(type), missing);
+}
+
+static int parse_hex(const char* line, uint8_t* out, int max) {
+    int n = 0, nibble = -1;
+    for (const char* p = line; *p && *p != '\n'; p++) {
+        if (isspace((unsigned char)*p))
+            continue;
+        if (!isxdigit((unsigned char)*p))
+            return -1;
+        int v = isdigit((unsigned char)*p) ? *p - '0' : tolower((unsigned char)*p) - 'a' + 10;
+        if (nibble < 0) {
+            nibble = v;
+        } else {
+            if (n == max)
+                return -1;
+            out[n++] = (uint8_t)(nibble << 4 | v);
+            nibble = -1;
+        }
+    }
+    return nibble < 0 ? n : -1;
+}
+
+int main() {
+    char line[1024];
+    uint8_t packet[255];
+    unsigned long packets = 0, readings = 0, bytes = 0;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        int size = parse_hex(line, packet, sizeof(packet));
+        lora_frame_header header;
+        int n = size > 0 ? lora_frame_decode(packet, (uint8_t)size, &header, NULL, NULL) : -1;
+        if (n < 0) {
+            printf("texto: %s", line);
+            continue;
+        }
+
+        printf("no %u seq %u%s: %d leituras em %d bytes", header.node, header.seq,
+               header.flags & LORA_FLAG_ALERT ? " ALERTA" : "", n, size);
+        if (header.flags & LORA_FLAG_ROUTED)
+            printf(" (salto %u de %u, por %u)", header.route.hops, header.route.limit, header.route.sender);
+        printf("\n");
+        lora_frame_decode_series(packet, (uint8_t)size, &header, &series[header.node],
+                                 print_reading, print_gap, NULL);
+        packets++;
+        readings += n;
+        bytes += size;
+    }
+
+    if (packets > 0)
+        printf("%lu pacotes, %lu leituras, %.2f bytes por leitura\n",
+               packets, readings, (double)bytes / readings);
+    return 0;
+}
@@ -0,0 +1,433 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sx1276_sim.h"
+#include "sim_node.h"
+
+// Rede LoRa simulada: um gateway no centro e N sensores espalhados em um
+// disco, cada um rodando lib/ sem alterações sobre o SX1276 simulado. Mede
+// entrega, latência, tempo no ar, colisões, as escolhas do ADR e a corrente
+// média estimada do rádio dos sensores. No modo rly, relés em um anel na
+// metade do raio encaminham os pacotes (lora_relay) e uma linha a mais traz
+// a vazão e a espera na fila dos relés:
+//
+//   lora_sim                      varredura padrão (nós x modos)
+//   lora_sim -n 40 -m adr -t 6    um cenário: 40 nós, ACK + ADR, 6 horas
+//   lora_sim -r 4000 -m lbt       sensores além do alcance do gateway...
+//   lora_sim -r 4000 -m rly       ...e alcançados pelos relés
+//   lora_sim -m lbt -c 1,2,4,8    saltos entre canais: 1 canal x N canais
+//   lora_sim -m lbt -c 1,4 -1     ...com gateway de rádio único varrendo
+//
+// Opções:
+//   -n nós      sensores (1..63)           -m modo   sf7 | ack | adr | lbt | lp
+//   -t horas    tempo simulado (1)         -r raio   metros (2000)
+//   -i seg      intervalo de leitura (2)   -l n      leituras por pacote (10)
+//   -a fração   leituras com alerta (0.01) -d fração ciclo de trabalho (0.01)
+//   -s semente  (1)                        -1        gateway de SF único
+//   -w ms       despertar da recepção no modo lp (50)
+//   -R relés    relés no modo rly (6)
+//   -c n,n...   canais do plano de saltos, um cenário por valor (1)
+//   -S ms       permanência em cada canal na varredura do gateway de rádio
+//               único (-1 com mais de um canal) (3)
+//
+// O gateway padrão imita um concentrador de vários demoduladores: ouve todos
+// os SFs em todos os canais. A coluna pac/h é a vazão entregue (pacotes por
+// hora, somando os sensores). Relés usam um canal só: o modo rly fica fora
+// das varreduras com mais de um canal
+
+#ifndef LORA_NODE_MODULE
+#error "LORA_NODE_MODULE deve apontar para o módulo lora_node"
+#endif
+
+// Pacotes criados no fim ficam fora das contas (não tiveram tempo de chegar)
+#define DRAIN_US            (120ull * 1000000)
+#define TRACK_SLOTS         1024
+#define GATEWAY_LOOP_US     10000
+#define LBT_BACKOFFS        4
+#define MAX_CHANNEL_SWEEP   8
+
+typedef struct {
+    const char* name;
+    bool reliable;
+    bool adr;
+    bool lbt;
+    bool low_power;
+    bool relays;
+} sim_mode;
+
+static const sim_mode modes[] = {
+    { "sf7", false, false, false, false, false },  // SF7 fixo, sem confirmação
+    { "ack", true,  false, false, false, false },  // SF7 fixo, entrega confirmada
+    { "adr", true,  true,  false, false, false },  // entrega confirmada e ADR de SF e potência
+    { "lbt", true,  false, true,  false, false },  // ack com escuta antes de transmitir
+    { "lp",  true,  false, true,  true,  false },  // lbt com recepção por despertar (CAD)
+    { "rly", true,  false, true,  false, true  },  // lbt com relés de vários saltos
+};
+
+typedef struct {
+    int      nodes;
+    double   hours;
+    double   radius_m;
+    double   reading_s;
+    int      per_frame;
+    double   alert_rate;
+    double   duty_cycle;
+    uint64_t seed;
+    bool     single_sf;
+    uint32_t wake_ms;
+    int      relays;
+    uint32_t scan_ms;
+} sim_options;
+
+typedef struct {
+    void* handle;
+    sim_node_setup_fn setup;
+    sim_node_loop_fn loop;
+    sim_node_stats_fn get_stats;
+    sim_node_config config;
+} node_instance;
+
+typedef struct {
+    uint16_t seq;
+    uint8_t  readings;
+    bool     used, alert, delivered;
+    uint64_t created_us;
+} frame_track;
+
+typedef struct {
+    uint32_t frames, readings, alerts;
+    uint32_t frames_ok, readings_ok, alerts_ok;
+    double   latency_s, alert_latency_s, max_latency_s;
+} delivery_totals;
+
+static node_instance instances[SIM_MAX_RADIOS];
+static frame_track tracks[SIM_MAX_RADIOS][TRACK_SLOTS];
+static delivery_totals totals;
+static uint64_t measure_end_us;
+static char module_dir[] = "/tmp/lora_sim_XXXXXX";
+
+// ============================================================================
+// Acompanhamento de ponta a ponta (chamado pelos nós)
+// ============================================================================
+
+void sim_frame_created(uint8_t node, uint16_t seq, uint8_t readings, bool alert) {
+    if (node >= SIM_MAX_RADIOS || sim_now() > measure_end_us)
+        return;
+    frame_track* f = &tracks[node][seq % TRACK_SLOTS];
+    *f = (frame_track){ seq, readings, true, alert, false, sim_now() };
+    totals.frames++;
+    totals.readings += readings;
+    totals.alerts += alert;
+}
+
+void sim_frame_received(uint8_t node, uint16_t seq) {
+    if (node >= SIM_MAX_RADIOS)
+        return;
+    frame_track* f = &tracks[node][seq % TRACK_SLOTS];
+    if (!f->used || f->delivered || f->seq != seq)
+        return;
+    f->delivered = true;
+    double latency = (sim_now() - f->created_us) / 1e6;
+    totals.frames_ok++;
+    totals.readings_ok += f->readings;
+    totals.latency_s += latency;
+    if (latency > totals.max_latency_s)
+        totals.max_latency_s = latency;
+    if (f->alert) {
+        totals.alerts_ok++;
+        totals.alert_latency_s += latency;
+    }
+}
+
+// ============================================================================
+// Módulos dos nós
+// ============================================================================
+
+/* Cada nó carrega sua própria cópia do módulo: o carregador não abre o mesmo
+   arquivo duas vezes, e cada cópia traz as variáveis estáticas de lib/ */
+static bool load_instance(int index, node_instance* in) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/node%d.so", module_dir, index);
+    if (access(path, F_OK) != 0) {
+        FILE* src = fopen(LORA_NODE_MODULE, "rb");
+        FILE* dst = fopen(path, "wb");
+        if (!src || !dst) {
+            fprintf(stderr, "lora_sim: não foi possível copiar %s\n", LORA_NODE_MODULE);
+            if (src) fclose(src);
+            if (dst) fclose(dst);
+            return false;
+        }
+        char buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), src)) > 0)
+            fwrite(buf, 1, n, dst);
+        fclose(src);
+        fclose(dst);
+    }
+
+    in->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!in->handle) {
+        fprintf(stderr, "lora_sim: %s\n", dlerror());
+        return false;
+    }
+    in->setup = (sim_node_setup_fn)dlsym(in->handle, "sim_node_setup");
+    in->loop = (sim_node_loop_fn)dlsym(in->handle, "sim_node_loop");
+    in->get_stats = (sim_node_stats_fn)dlsym(in->handle, "sim_node_get_stats");
+    return in->setup && in->loop && in->get_stats;
+}
+
+static void cleanup_modules() {
+    char path[256];
+    for (int i = 0; i < SIM_MAX_RADIOS; i++) {
+        snprintf(path, sizeof(path), "%s/node%d.so", module_dir, i);
+        unlink(path);
+    }
+    rmdir(module_dir);
+}
+
+static void boot_node(void* arg) {
+    node_instance* in = arg;
+    in->setup(&in->config);
+}
+
+static void loop_node(void* arg) {
+    node_instance* in = arg;
+    in->loop();
+}
+
+// ============================================================================
+// Cenários
+// ============================================================================
+
+static void print_header() {
+    printf("%5s %-4s %3s %7s %7s %8s %8s %7s %8s %6s %6s %5s %7s %5s %5s %6s %6s\n",
+           "nos", "modo", "can", "leit%", "alert%", "lat(s)", "latA(s)", "ar(s)", "descart", "retx%",
+           "colis", "crc", "pac/h", "SF", "dBm", "mA", "lig%");
+}
+
+/* Vazão e espera na fila dos relés; multihop é o número de sensores cuja
+   rota passa por um relé no fim da simulação */
+static void print_relays(const sim_options* opt, int first, int relays, uint32_t multihop) {
+    uint32_t forwarded = 0, alerts = 0, duplicates = 0, hop_limit = 0, refused = 0, evicted = 0;
+    uint64_t bytes = 0, wait_us = 0, sent = 0;
+    uint32_t max_wait_us = 0;
+    for (int i = first; i < first + relays; i++) {
+        sim_node_stats st;
+        sim_set_current(i);
+        instances[i].get_stats(&st);
+        forwarded += st.relay.forwarded;
+        alerts += st.relay.forwarded_alerts;
+        bytes += st.relay.forwarded_bytes;
+        duplicates += st.relay.duplicates;
+        hop_limit += st.relay.hop_limit;
+        refused += st.relay.queue_full;
+        evicted += st.queue.dropped;
+        wait_us += st.queue.wait_us;
+        sent += st.queue.sent;
+        if (st.queue.max_wait_us > max_wait_us)
+            max_wait_us = st.queue.max_wait_us;
+    }
+    double hours = opt->hours;
+    printf("      reles: %d, %u sensores via rele; %.0f pacotes/h e %.1f B/s por rele (%u alertas); "
+           "fila: espera media %.1f ms, max %.1f ms, %u descartes; %u duplicatas, %u no limite de saltos\n",
+           relays, multihop, forwarded / hours / relays, bytes / (hours * 3600) / relays, alerts,
+           sent ? wait_us / 1e3 / sent : 0.0, max_wait_us / 1e3, refused + evicted, duplicates, hop_limit);
+}
+
+static bool run_scenario(const sim_options* opt, const sim_mode* mode, int nodes, uint8_t channels) {
+    sim_channel_config channel;
+    sim_channel_default(&channel);
+    sim_init(&channel, opt->seed);
+    memset(tracks, 0, sizeof(tracks));
+    memset(&totals, 0, sizeof(totals));
+
+    uint64_t end_us = (uint64_t)(opt->hours * 3600e6);
+    uint64_t reading_us = (uint64_t)(opt->reading_s * 1e6);
+    measure_end_us = end_us > DRAIN_US ? end_us - DRAIN_US : end_us;
+
+    // Gateway no centro; sensores uniformes no disco; relés igualmente
+    // espaçados no anel da metade do raio
+    int count = nodes + 1;
+    int relays = mode->relays ? opt->relays : 0;
+    // Gateway de rádio único com saltos: varre os canais por CAD
+    uint32_t scan_ms = opt->single_sf && channels > 1 ? opt->scan_ms : 0;
+    for (int i = 0; i < count + relays; i++) {
+        bool relay = i >= count;
+        double r = opt->radius_m * sqrt(sim_random()), a = 2 * M_PI * sim_random();
+        if (relay) {
+            r = opt->radius_m / 2;
+            a = 2 * M_PI * (i - count) / relays;
+        }
+        sim_add_radio(i ? r * cos(a) : 0, i ? r * sin(a) : 0, i == 0 && !opt->single_sf);
+
+        node_instance* in = &instances[i];
+        if (!load_instance(i, in))
+            return false;
+        in->config = (sim_node_config){
+            .role = relay ? SIM_NODE_RELAY : i ? SIM_NODE_SENSOR : SIM_NODE_GATEWAY,
+            .id = (uint8_t)i,
+            .seed = (uint32_t)(opt->seed * 7919 + i),
+            .sf = 7,
+            .power = 17,
+            .reading_ms = (uint32_t)(reading_us / 1000),
+            .readings_per_frame = (uint8_t)opt->per_frame,
+            .alert_rate = (float)opt->alert_rate,
+            .duty_cycle = (float)opt->duty_cycle,
+            .reliable = mode->reliable,
+            .adr = mode->adr,
+            .max_sf = opt->single_sf ? 7 : 12,
+            .reply = mode->reliable || mode->adr,
+            .lbt = mode->lbt ? LBT_BACKOFFS : 0,
+            .rx_period_ms = mode->low_power ? opt->wake_ms : 0,
+            .routed = mode->relays,
+            .channels = channels,
+            .scan_ms = scan_ms,
+        };
+
+        // Nós ligam em instantes diferentes, como no campo; com todos no
+        // mesmo intervalo de pacote, os lotes sairiam juntos
+        uint64_t boot = i && !relay ? (uint64_t)(sim_random() * reading_us * opt->per_frame) : 0;
+        uint32_t period = i && !relay ? (uint32_t)reading_us : GATEWAY_LOOP_US;
+        sim_call_at(i, boot, 0, boot_node, in);
+        sim_call_at(i, boot + period, period, loop_node, in);
+    }
+
+    sim_run(end_us);
+
+    uint32_t dropped = 0, sent = 0, retx = 0, multihop = 0;
+    double airtime = 0, sf = 0, power = 0, charge = 0, awake = 0;
+    for (int i = 1; i < count; i++) {
+        sim_node_stats st;
+        sim_set_current(i);
+        instances[i].get_stats(&st);
+        dropped += st.queue.dropped;
+        airtime += st.queue.airtime_us / 1e6;
+        sent += st.reliable.sent;
+        retx += st.reliable.retransmissions;
+        sf += mode->adr ? st.adr.sf : instances[i].config.sf;
+        power += mode->adr ? st.adr.power : instances[i].config.power;
+        charge += st.power.charge_mah;
+        multihop += mode->relays && st.relay.distance > 1 && st.relay.distance != LORA_ROUTE_UNKNOWN;
+
+        sim_radio_stats rs;
+        sim_radio_get_stats(i, &rs);
+        uint64_t total = 0;
+        for (int m = 0; m < 8; m++)
+            total += rs.mode_us[m];
+        awake += total ? 1.0 - (double)rs.mode_us[0] / total : 0.0;
+    }
+    sim_radio_stats gw;
+    sim_radio_get_stats(0, &gw);
+
+    double hours = opt->hours;
+    printf("%5d %-4s %3u %7.1f %7.1f %8.2f %8.2f %7.1f %8u %6.1f %6u %5u %7.0f %5.1f %5.1f %6.2f %6.1f\n",
+           nodes, mode->name, channels,
+           totals.readings ? 100.0 * totals.readings_ok / totals.readings : 0.0,
+           totals.alerts ? 100.0 * totals.alerts_ok / totals.alerts : 0.0,
+           totals.frames_ok ? totals.latency_s / totals.frames_ok : 0.0,
+           totals.alerts_ok ? totals.alert_latency_s / totals.alerts_ok : 0.0,
+           airtime / nodes / hours, dropped,
+           sent ? 100.0 * retx / sent : 0.0,
+           gw.collisions, gw.crc_errors, totals.frames_ok / hours, sf / nodes, power / nodes,
+           charge / nodes / hours, 100.0 * awake / nodes);
+    if (relays)
+        print_relays(opt, count, relays, multihop);
+    fflush(stdout);
+
+    for (int i = 0; i < count + relays; i++)
+        dlclose(instances[i].handle);
+    return true;
+}
+
+static const sim_mode* find_mode(const char* name) {
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcmp(modes[i].name, name) == 0)
+            return &modes[i];
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    sim_options opt = { 0, 1.0, 2000.0, 2.0, 10, 0.01, 0.01, 1, false, 50, 6, 3 };
+    const sim_mode* mode = NULL;
+    uint8_t channels[MAX_CHANNEL_SWEEP] = { 1 };
+    int channel_sweep = 1;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:m:t:r:i:l:a:d:s:1w:R:c:S:")) != -1) {
+        switch (c) {
+        case 'n': opt.nodes = atoi(optarg); break;
+        case 'm':
+            mode = find_mode(optarg);
+            if (!mode) {
+                fprintf(stderr, "lora_sim: modo desconhecido '%s' (sf7, ack, adr, lbt, lp, rly)\n", optarg);
+                return 1;
+            }
+            break;
+        case 't': opt.hours = atof(optarg); break;
+        case 'r': opt.radius_m = atof(optarg); break;
+        case 'i': opt.reading_s = atof(optarg); break;
+        case 'l': opt.per_frame = atoi(optarg); break;
+        case 'a': opt.alert_rate = atof(optarg); break;
+        case 'd': opt.duty_cycle = atof(optarg); break;
+        case 's': opt.seed = strtoull(optarg, NULL, 10); break;
+        case '1': opt.single_sf = true; break;
+        case 'w': opt.wake_ms = (uint32_t)atoi(optarg); break;
+        case 'R': opt.relays = atoi(optarg); break;
+        case 'c':
+            channel_sweep = 0;
+            for (char* t = strtok(optarg, ","); t && channel_sweep < MAX_CHANNEL_SWEEP; t = strtok(NULL, ",")) {
+                int n = atoi(t);
+                if (n < 1 || n > LORA_MAX_CHANNELS) {
+                    fprintf(stderr, "lora_sim: canais entre 1 e %d\n", LORA_MAX_CHANNELS);
+                    return 1;
+                }
+                channels[channel_sweep++] = (uint8_t)n;
+            }
+            break;
+        case 'S': opt.scan_ms = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "uso: %s [-n nós] [-m sf7|ack|adr|lbt|lp|rly] [-t horas] [-r raio_m] [-i intervalo_s]\n"
+                            "       [-l leituras_por_pacote] [-a taxa_alerta] [-d ciclo] [-s semente] [-1]\n"
+                            "       [-w despertar_ms] [-R relés] [-c canais,...] [-S varredura_ms]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (opt.nodes < 0 || opt.relays < 1 || (opt.nodes ? opt.nodes : 50) + opt.relays >= SIM_MAX_RADIOS ||
+        opt.per_frame < 1 || opt.hours <= 0 || opt.wake_ms == 0 || channel_sweep == 0 || opt.scan_ms == 0) {
+        fprintf(stderr, "lora_sim: parâmetros inválidos (1 a %d nós e relés)\n", SIM_MAX_RADIOS - 1);
+        return 1;
+    }
+    if (!mkdtemp(module_dir)) {
+        perror("lora_sim");
+        return 1;
+    }
+
+    printf("raio %.0f m, %.1f h, leitura a cada %.1f s, %d por pacote, alertas %.1f%%, ciclo %.1f%%, gateway %s\n",
+           opt.radius_m, opt.hours, opt.reading_s, opt.per_frame, opt.alert_rate * 100,
+           opt.duty_cycle * 100, opt.single_sf ? "SF7" : "multi-SF");
+    print_header();
+
+    static const int sweep[] = { 10, 25, 50 };
+    bool ok = true;
+    for (size_t n = 0; n < 3 && ok; n++) {
+        int nodes = opt.nodes ? opt.nodes : sweep[n];
+        for (int ch = 0; ch < channel_sweep && ok; ch++) {
+            for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]) && ok; m++) {
+                if ((!mode || mode == &modes[m]) && !(modes[m].relays && channels[ch] > 1))
+                    ok = run_scenario(&opt, &modes[m], nodes, channels[ch]);
+            }
+        }
+        if (opt.nodes)
+            break;
+    }
+
+    cleanup_modules();
+    return ok ? 0 : 1;
+}
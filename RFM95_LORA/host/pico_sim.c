@@ -0,0 +1,233 @@
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/dma.h"
+#include <string.h>
+
+#include "rfm95_lora.h"
+#include "sx1276_sim.h"
+
+// Chamadas do Pico SDK usadas por lib/, implementadas sobre o simulador.
+// CS e RST vão para o rádio do nó atual, o SPI troca bytes com os
+// registradores dele e o tempo é o do simulador. Esperas retornam na hora:
+// só rmf95_reset as usa, e o rádio simulado não precisa delas.
+
+struct spi_inst {
+    spi_hw_t hw;
+};
+
+spi_inst_t sim_spi_inst;
+
+#define DMA_CHANNELS 12
+
+typedef struct {
+    dma_channel_config config;
+    volatile void* write_addr;
+    const volatile void* read_addr;
+    uint count;
+    bool claimed;
+} dma_channel;
+
+static dma_channel dma[DMA_CHANNELS];
+
+// Bytes recebidos pelo SPI durante DMA, à espera de um canal de leitura
+static uint8_t spi_rx_fifo[256];
+static uint spi_rx_count = 0;
+
+// ============================================================
+// GPIO
+// ============================================================
+
+void gpio_init(uint gpio) {}
+void gpio_set_dir(uint gpio, bool out) {}
+void gpio_set_function(uint gpio, uint fn) {}
+void gpio_pull_up(uint gpio) {}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio == PIN_CS) {
+        sim_spi_select(!value);
+        spi_rx_count = 0;
+    }
+    else if (gpio == PIN_RST && !value)
+        sim_radio_reset();
+}
+
+bool gpio_get(uint gpio) {
+    return false;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    if (gpio == PIN_DIO0)
+        sim_irq_enable(events, enabled);
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler) {
+    if (gpio == PIN_DIO0)
+        sim_irq_handler(handler);
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+    return gpio == PIN_DIO0 ? sim_irq_events() : 0;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t events) {
+    if (gpio == PIN_DIO0)
+        sim_irq_acknowledge(events);
+}
+
+void irq_set_enabled(uint num, bool enabled) {}
+
+// ============================================================
+// SPI
+// ============================================================
+
+uint spi_init(spi_inst_t* spi, uint baudrate) {
+    return baudrate;
+}
+
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {}
+
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        sim_spi_transfer(src[i]);
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        dst[i] = sim_spi_transfer(repeated_tx_data);
+    return (int)len;
+}
+
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        dst[i] = sim_spi_transfer(src[i]);
+    return (int)len;
+}
+
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx) {
+    return is_tx ? 16 : 17;         // DREQ_SPI0_TX, DREQ_SPI0_RX
+}
+
+spi_hw_t* spi_get_hw(spi_inst_t* spi) {
+    return &spi->hw;
+}
+
+// ============================================================
+// DMA
+// ============================================================
+
+int dma_claim_unused_channel(bool required) {
+    for (int i = 0; i < DMA_CHANNELS; i++) {
+        if (!dma[i].claimed) {
+            dma[i].claimed = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c = { DMA_SIZE_32, true, false };
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->read_inc = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->write_inc = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config* c, uint dreq) {}
+
+/* Executa um canal: escrita no SPI troca bytes com o rádio, leitura do SPI
+   recolhe as respostas, e o resto é cópia de memória */
+static void dma_run(dma_channel* ch) {
+    volatile void* spi_dr = &sim_spi_inst.hw.dr;
+    const uint8_t* src = (const uint8_t*)ch->read_addr;
+    uint8_t* dst = (uint8_t*)ch->write_addr;
+    size_t size = 1u << ch->config.size;
+
+    for (uint i = 0; i < ch->count; i++) {
+        if (ch->write_addr == spi_dr) {
+            uint8_t in = sim_spi_transfer(*src);
+            if (spi_rx_count < sizeof(spi_rx_fifo))
+                spi_rx_fifo[spi_rx_count++] = in;
+        } else if (ch->read_addr == spi_dr) {
+            *dst = i < spi_rx_count ? spi_rx_fifo[i] : 0;
+        } else {
+            memmove(dst, src, size);
+        }
+        if (ch->config.read_inc)
+            src += size;
+        if (ch->config.write_inc)
+            dst += size;
+    }
+    if (ch->read_addr == spi_dr)
+        spi_rx_count = 0;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger) {
+    dma_channel* ch = &dma[channel];
+    ch->config = *config;
+    ch->write_addr = write_addr;
+    ch->read_addr = read_addr;
+    ch->count = transfer_count;
+    if (trigger)
+        dma_run(ch);
+}
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < DMA_CHANNELS; i++) {
+            bool reads_spi = dma[i].read_addr == &sim_spi_inst.hw.dr;
+            if ((chan_mask & (1u << i)) && reads_spi == (pass == 1))
+                dma_run(&dma[i]);
+        }
+    }
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {}
+
+// ============================================================
+// Tempo e alarmes
+// ============================================================
+
+uint64_t time_us_64(void) {
+    return sim_now();
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)sim_now();
+}
+
+void sleep_ms(uint32_t ms) {}
+void sleep_us(uint64_t us) {}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return sim_now() + (uint64_t)ms * 1000;
+}
+
+bool time_reached(absolute_time_t t) {
+    return sim_now() >= t;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    return sim_alarm_at(sim_now() + us, callback, user_data);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void* user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    return sim_alarm_cancel(alarm_id);
+}
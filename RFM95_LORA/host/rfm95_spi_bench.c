@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "rfm95_lora.h"
+#include "sx1276_sim.h"
+
+// Custo no barramento SPI das operações de lib/rfm95_lora.c, medido no SX1276
+// simulado: transações (seleções do CS), bytes trocados e o tempo estimado no
+// barramento a 1 MHz (8 us por byte mais a troca do CS e a chamada ao SDK).
+//
+//   ./build-host/rfm95_spi_bench
+//
+// O rádio 0 roda a biblioteca; o rádio 1, a 10 m, é acionado direto pelos
+// registradores para entregar pacotes ao rádio 0.
+
+#define SPI_HZ              1000000
+#define CS_OVERHEAD_US      2.0
+#define REPS                50
+
+#define NODE                0
+#define PEER                1
+
+static sim_radio_stats before;
+static int received = 0;
+
+static void begin() {
+    sim_radio_get_stats(NODE, &before);
+}
+
+static void report(const char* name, int reps) {
+    sim_radio_stats after;
+    sim_radio_get_stats(NODE, &after);
+    double transactions = (double)(after.spi_transactions - before.spi_transactions) / reps;
+    double bytes = (double)(after.spi_bytes - before.spi_bytes) / reps;
+    printf("%-40s %8.1f %8.1f %9.1f\n", name, transactions, bytes,
+           bytes * 8e6 / SPI_HZ + transactions * CS_OVERHEAD_US);
+}
+
+/* Escreve um registrador do rádio 1 sem passar pela biblioteca */
+static void peer_write(uint8_t reg, uint8_t value) {
+    sim_set_current(PEER);
+    sim_spi_select(true);
+    sim_spi_transfer(reg | 0x80);
+    sim_spi_transfer(value);
+    sim_spi_select(false);
+    sim_set_current(NODE);
+}
+
+static void peer_setup() {
+    uint64_t frf = ((uint64_t)LORA_FREQUENCY_HZ * (1 << 19)) / 32000000;
+    peer_write(0x01, 0x80);                 // LoRa, sleep
+    peer_write(0x06, (uint8_t)(frf >> 16));
+    peer_write(0x07, (uint8_t)(frf >> 8));
+    peer_write(0x08, (uint8_t)frf);
+    peer_write(0x1D, 0x72);                 // BW 125 kHz, CR 4/5
+    peer_write(0x1E, 0x74);                 // SF7, CRC
+    peer_write(0x39, 0xF3);
+    peer_write(0x09, 0x8F);
+    peer_write(0x0E, 0x00);
+    peer_write(0x01, 0x81);                 // standby
+}
+
+/* O rádio 1 transmite size bytes; espera o pacote chegar */
+static void peer_send(uint8_t size) {
+    peer_write(0x0D, 0x00);
+    for (int i = 0; i < size; i++)
+        peer_write(0x00, (uint8_t)i);
+    peer_write(0x22, size);
+    peer_write(0x01, 0x83);                 // TX
+    sim_run(sim_now() + 500000);
+}
+
+static void on_receive(const uint8_t* buffer, uint8_t size) {
+    // Como o gateway: RSSI e SNR de cada pacote
+    lora_packet_rssi();
+    lora_packet_snr();
+    received++;
+}
+
+int main() {
+    sim_channel_config channel;
+    sim_channel_default(&channel);
+    channel.shadowing_db = 0;
+    channel.fading_db = 0;
+    sim_init(&channel, 1);
+    sim_add_radio(0, 0, false);
+    sim_add_radio(10, 0, false);
+    sim_set_current(NODE);
+
+    printf("%-40s %8s %8s %9s\n", "operacao", "transac", "bytes", "us@1MHz");
+
+    begin();
+    if (!lora_init()) {
+        printf("rfm95_spi_bench: lora_init falhou\n");
+        return 1;
+    }
+    report("lora_init", 1);
+    peer_setup();
+
+    begin();
+    for (int i = 0; i < REPS; i++)
+        lora_set_frequency(i & 1 ? 915000000 : 916800000);
+    report("lora_set_frequency (outro canal)", REPS);
+
+    begin();
+    for (int i = 0; i < REPS; i++)
+        lora_set_frequency(915000000);
+    report("lora_set_frequency (mesmo canal)", REPS);
+
+    begin();
+    for (int i = 0; i < REPS; i++) {
+        lora_set_frequency(i & 1 ? 915000000 : 916800000);
+        lora_set_spreading_factor(i & 1 ? 7 : 9);
+        lora_set_signal_bandwidth(i & 1 ? 125000 : 250000);
+    }
+    report("troca de canal, SF e BW", REPS);
+    lora_set_spreading_factor(7);
+    lora_set_signal_bandwidth(125000);
+    lora_set_frequency(LORA_FREQUENCY_HZ);
+
+    lora_on_receive(on_receive);
+    lora_receive_async();
+
+    uint8_t payload[200];
+    memset(payload, 0x5A, sizeof(payload));
+    static const uint8_t sizes[] = { 20, 200 };
+    for (int s = 0; s < 2; s++) {
+        char name[64];
+        sim_radio_stats tx_start, tx_end;
+        memset(&tx_start, 0, sizeof(tx_start));
+        memset(&tx_end, 0, sizeof(tx_end));
+
+        for (int i = 0; i < REPS; i++) {
+            sim_radio_stats a, b, c;
+            sim_radio_get_stats(NODE, &a);
+            lora_send_packet_async(payload, sizes[s]);
+            sim_radio_get_stats(NODE, &b);
+            sim_run(sim_now() + 2000000);       // TxDone e volta a RX
+            sim_radio_get_stats(NODE, &c);
+            tx_start.spi_transactions += b.spi_transactions - a.spi_transactions;
+            tx_start.spi_bytes += b.spi_bytes - a.spi_bytes;
+            tx_end.spi_transactions += c.spi_transactions - b.spi_transactions;
+            tx_end.spi_bytes += c.spi_bytes - b.spi_bytes;
+        }
+        memset(&before, 0, sizeof(before));
+        snprintf(name, sizeof(name), "envio de %u bytes (ate TX)", sizes[s]);
+        sim_radio_stats* results[] = { &tx_start, &tx_end };
+        for (int k = 0; k < 2; k++) {
+            double transactions = (double)results[k]->spi_transactions / REPS;
+            double bytes = (double)results[k]->spi_bytes / REPS;
+            printf("%-40s %8.1f %8.1f %9.1f\n", k ? "  TxDone e volta a RX" : name, transactions, bytes,
+                   bytes * 8e6 / SPI_HZ + transactions * CS_OVERHEAD_US);
+        }
+
+        begin();
+        for (int i = 0; i < REPS; i++)
+            peer_send(sizes[s]);
+        snprintf(name, sizeof(name), "recepcao de %u bytes (IRQ, RSSI, SNR)", sizes[s]);
+        report(name, REPS);
+    }
+
+    if (received != 2 * REPS) {
+        printf("rfm95_spi_bench: %d de %d pacotes recebidos\n", received, 2 * REPS);
+        return 1;
+    }
+    return 0;
+}
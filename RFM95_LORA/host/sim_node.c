@@ -0,0 +1,290 @@
+#include "sim_node.h"
+#include <string.h>
+#include "rfm95_lora.h"
+#include "lora_telemetry.h"
+#include "lora_relay.h"
+
+// Reproduz o laço de VL53L0X_RFM95_LORA/vl53l0x_rfm95_lora.c (sensor), de
+// RFM95_LORA/RFM95_LoRa_Gateway.c (gateway) e de RFM95_LoRa_Relay.c (relé)
+// com leituras sintéticas, para que o simulador exercite as mesmas chamadas
+// da biblioteca.
+
+static sim_node_config cfg;
+static sim_node_stats stats;
+static uint32_t rng;
+
+// Sensor
+static uint16_t seq;
+static uint8_t lote_buf[64];
+static lora_frame lote;
+static int32_t distancia;
+static uint32_t uplinks;
+static uint16_t ack_last;
+
+// Gateway
+static lora_ack_window janelas[256];
+
+/* Plano de canais com salto por pacote (lora_frame_channel) */
+static void configura_canais() {
+    if (cfg.channels < 2)
+        return;
+    long canais[LORA_MAX_CHANNELS];
+    for (int i = 0; i < cfg.channels && i < LORA_MAX_CHANNELS; i++)
+        canais[i] = (long)LORA_FREQUENCY_HZ + i * LORA_CHANNEL_SPACING_HZ;
+    lora_set_channel_plan(canais, cfg.channels, lora_frame_channel);
+}
+
+static uint32_t aleatorio() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;                            // 24 bits
+}
+
+// ============================================================================
+// Sensor
+// ============================================================================
+
+static uint8_t flags_roteamento() {
+    return cfg.routed ? LORA_FLAG_ROUTED : 0;
+}
+
+static void envia(uint8_t* buf, uint8_t size, lora_priority priority) {
+    if (cfg.routed)
+        lora_relay_prepare(buf, size);
+    if (cfg.reliable)
+        lora_reliable_send(buf, size, priority);
+    else
+        lora_queue_send(buf, size, priority);
+}
+
+static void envia_lote() {
+    if (lote.readings > 0) {
+        sim_frame_created(cfg.id, lote_buf[3] | (lote_buf[4] << 8), lote.readings, false);
+        envia(lote_buf, lora_frame_size(&lote), LORA_PRIORITY_LOW);
+        stats.frames++;
+    }
+    lora_frame_begin(&lote, lote_buf, sizeof(lote_buf), cfg.id, seq++, flags_roteamento());
+}
+
+static void envia_alerta(int32_t valor) {
+    uint8_t buf[16];
+    lora_frame f;
+    uint16_t s = seq++;
+    lora_frame_begin(&f, buf, sizeof(buf), cfg.id, s, LORA_FLAG_ALERT | flags_roteamento());
+    lora_frame_add(&f, LORA_SENSOR_DISTANCE, valor);
+    sim_frame_created(cfg.id, s, 1, true);
+    envia(buf, lora_frame_size(&f), LORA_PRIORITY_HIGH);
+    stats.alerts++;
+}
+
+static void le_relatorio(lora_sensor type, uint8_t index, int32_t value, void* ctx) {
+    if (type == LORA_SENSOR_SNR && cfg.adr) {
+        lora_adr_report(value * 0.25f);
+    } else if (type == LORA_SENSOR_ACK && index == 0) {
+        ack_last = (uint16_t)value;
+    } else if (type == LORA_SENSOR_ACK && index == 1 && cfg.reliable) {
+        lora_reliable_ack(ack_last, (uint32_t)value);
+    }
+}
+
+static void sensor_recebido(const uint8_t* buffer, uint8_t size) {
+    if (cfg.routed) {
+        // RSSI corrigido pelo SNR abaixo do ruído, como em lora_gateway.c
+        float snr = lora_packet_snr();
+        if (!lora_relay_receive(buffer, size, lora_packet_rssi() + (snr < 0 ? (int16_t)snr : 0)))
+            return;
+    }
+    lora_frame_header header;
+    if (lora_frame_decode(buffer, size, &header, NULL, NULL) >= 0 &&
+        (header.flags & LORA_FLAG_CONTROL) && header.node == cfg.id) {
+        stats.reports++;
+        lora_frame_decode(buffer, size, &header, le_relatorio, NULL);
+    }
+}
+
+static void sensor_setup() {
+    if (cfg.adr) {
+        lora_adr_config adr_cfg;
+        lora_adr_default_config(&adr_cfg);
+        adr_cfg.max_sf = cfg.max_sf;
+        lora_adr_init(&adr_cfg, cfg.sf, 125000, cfg.power);
+    } else {
+        lora_set_spreading_factor(cfg.sf);
+        lora_set_power(cfg.power);
+    }
+    lora_queue_init(cfg.duty_cycle, 3600);
+    if (cfg.reliable)
+        lora_reliable_init(NULL);
+    lora_set_listen_before_talk(cfg.lbt);
+    configura_canais();
+    if (cfg.channels > 1 && cfg.scan_ms)
+        lora_set_preamble_length(lora_wake_preamble_length(cfg.channels * cfg.scan_ms));
+    // Relatórios do gateway chegam invertidos; com relés, tudo em I/Q normal
+    lora_set_invert_iq(false, !cfg.routed);
+    if (cfg.routed) {
+        lora_relay_config relay_cfg;
+        lora_relay_default_config(&relay_cfg, cfg.id);
+        lora_relay_init(&relay_cfg);
+    }
+
+    lora_on_receive(sensor_recebido);
+    if (cfg.rx_period_ms)
+        lora_receive_duty_cycled(cfg.rx_period_ms);
+    else
+        lora_receive_async();
+    seq = 0;
+    uplinks = 0;
+    distancia = 500 + aleatorio() % 1500;
+    lora_frame_begin(&lote, lote_buf, sizeof(lote_buf), cfg.id, seq++, flags_roteamento());
+}
+
+static void sensor_loop() {
+    // Passeio aleatório de distância, com alertas esporádicos
+    distancia += (int32_t)(aleatorio() % 41) - 20;
+    if (distancia < 100) distancia = 100;
+    if (distancia > 2000) distancia = 2000;
+    stats.readings++;
+
+    if (aleatorio() % 1000000 < (uint32_t)(cfg.alert_rate * 1000000))
+        envia_alerta(50 + aleatorio() % 50);
+
+    if (!lora_frame_add(&lote, LORA_SENSOR_DISTANCE, distancia)) {
+        envia_lote();
+        lora_frame_add(&lote, LORA_SENSOR_DISTANCE, distancia);
+    }
+
+    if (cfg.adr) {
+        lora_queue_stats st;
+        lora_queue_get_stats(&st);
+        for (; uplinks < st.sent; uplinks++)
+            lora_adr_uplink();
+        lora_adr_apply();
+    }
+    if (cfg.reliable)
+        lora_reliable_poll();
+    if (lote.readings >= cfg.readings_per_frame)
+        envia_lote();
+}
+
+// ============================================================================
+// Gateway
+// ============================================================================
+
+static void envia_relatorio(const lora_frame_header* header, const lora_gateway_packet* p) {
+    const lora_ack_window* w = &janelas[header->node];
+    uint8_t buf[32];
+    lora_frame f;
+    lora_frame_begin(&f, buf, sizeof(buf), header->node, header->seq,
+                     LORA_FLAG_CONTROL | (header->flags & LORA_FLAG_ROUTED));
+    lora_frame_add(&f, LORA_SENSOR_SNR, (int32_t)(p->snr * 4));
+    lora_frame_add(&f, LORA_SENSOR_RSSI, p->rssi);
+    lora_frame_add(&f, LORA_SENSOR_ACK, w->last);
+    lora_frame_add(&f, LORA_SENSOR_ACK, (int32_t)w->bitmap);
+    lora_relay_prepare(buf, lora_frame_size(&f));
+    lora_queue_send(buf, lora_frame_size(&f), LORA_PRIORITY_HIGH);
+}
+
+static void gateway_setup() {
+    memset(janelas, 0, sizeof(janelas));
+    lora_set_power(cfg.power);
+    lora_set_listen_before_talk(cfg.lbt);
+    lora_set_invert_iq(!cfg.routed, false);
+    if (cfg.routed) {
+        lora_relay_config relay_cfg;
+        lora_relay_default_config(&relay_cfg, LORA_ROUTE_GATEWAY);
+        lora_relay_init(&relay_cfg);
+    }
+    if (cfg.rx_period_ms)
+        lora_set_preamble_length(lora_wake_preamble_length(cfg.rx_period_ms));
+    lora_queue_init(1.0f, 0);
+    configura_canais();
+    lora_gateway_start();
+    if (cfg.channels > 1 && cfg.scan_ms)
+        lora_receive_scan(cfg.scan_ms);
+}
+
+static void gateway_loop() {
+    lora_gateway_packet p;
+    while (lora_gateway_pop(&p)) {
+        if (cfg.routed && !lora_relay_receive(p.data, p.size, p.rssi))
+            continue;
+        lora_frame_header header;
+        if (lora_frame_decode(p.data, p.size, &header, NULL, NULL) < 0 || (header.flags & LORA_FLAG_CONTROL))
+            continue;
+        if (lora_ack_track(&janelas[header.node], header.seq))
+            sim_frame_received(header.node, header.seq);
+        else
+            stats.duplicates++;
+        if (cfg.reply)
+            envia_relatorio(&header, &p);
+    }
+}
+
+// ============================================================================
+// Relé
+// ============================================================================
+
+static void relay_setup() {
+    lora_set_power(cfg.power);
+    lora_set_listen_before_talk(cfg.lbt);
+    lora_set_invert_iq(false, false);
+    lora_queue_init(1.0f, 0);                   // alimentado pela rede, como o gateway
+
+    lora_relay_config relay_cfg;
+    lora_relay_default_config(&relay_cfg, cfg.id);
+    relay_cfg.forward = true;
+    lora_relay_init(&relay_cfg);
+    lora_gateway_start();
+}
+
+static void relay_loop() {
+    lora_gateway_packet p;
+    while (lora_gateway_pop(&p))
+        lora_relay_receive(p.data, p.size, p.rssi);
+}
+
+// ============================================================================
+// Pontos de entrada do módulo
+// ============================================================================
+
+void sim_node_setup(const sim_node_config* config) {
+    cfg = *config;
+    memset(&stats, 0, sizeof(stats));
+    rng = cfg.seed | 1;
+
+    stats.radio_ok = lora_init();
+    if (!stats.radio_ok)
+        return;
+    if (cfg.role == SIM_NODE_GATEWAY)
+        gateway_setup();
+    else if (cfg.role == SIM_NODE_RELAY)
+        relay_setup();
+    else
+        sensor_setup();
+}
+
+void sim_node_loop() {
+    if (!stats.radio_ok)
+        return;
+    if (cfg.role == SIM_NODE_GATEWAY)
+        gateway_loop();
+    else if (cfg.role == SIM_NODE_RELAY)
+        relay_loop();
+    else
+        sensor_loop();
+}
+
+void sim_node_get_stats(sim_node_stats* out) {
+    *out = stats;
+    lora_queue_get_stats(&out->queue);
+    lora_get_power_stats(&out->power);
+    if (cfg.routed || cfg.role == SIM_NODE_RELAY)
+        lora_relay_get_stats(&out->relay);
+    if (cfg.role != SIM_NODE_SENSOR) {
+        lora_gateway_get_stats(&out->gateway);
+    } else {
+        if (cfg.reliable)
+            lora_reliable_get_stats(&out->reliable);
+        if (cfg.adr)
+            lora_adr_get_state(&out->adr);
+    }
+}
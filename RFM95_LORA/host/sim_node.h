@@ -0,0 +1,76 @@
+#ifndef SIM_NODE_H
+#define SIM_NODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_queue.h"
+#include "lora_reliable.h"
+#include "lora_adr.h"
+#include "lora_gateway.h"
+#include "lora_relay.h"
+#include "rfm95_lora.h"
+
+// Programa de um nó simulado (sim_node.c). É compilado junto com lib/ em um
+// módulo carregado uma vez por nó (lora_sim.c), então cada nó tem sua cópia
+// das variáveis estáticas da biblioteca, como em placas separadas.
+
+typedef enum {
+    SIM_NODE_SENSOR,                // leituras em lotes e alertas, como o VL53L0X
+    SIM_NODE_GATEWAY,               // recepção contínua e relatórios de enlace
+    SIM_NODE_RELAY                  // encaminha pacotes de outros nós (lora_relay)
+} sim_node_role;
+
+typedef struct {
+    sim_node_role role;
+    uint8_t  id;                    // nó nos pacotes (lora_telemetry.h)
+    uint32_t seed;
+    uint8_t  sf;                    // configuração inicial do rádio
+    uint8_t  power;                 // dBm
+    uint8_t  lbt;                   // esperas do listen-before-talk (0 = sem LBT)
+    uint32_t rx_period_ms;          // sensor: despertar da recepção (0 = contínua);
+                                    // gateway: o dos sensores, para o preâmbulo
+    bool     routed;                // rede com relés: pacotes roteados, I/Q normal
+    uint8_t  channels;              // canais do plano de saltos (1 = sem saltos)
+    uint32_t scan_ms;               // gateway de rádio único: varredura dos canais
+                                    // (sensor: preâmbulo que cobre a volta)
+
+    // Sensor
+    uint32_t reading_ms;            // intervalo entre leituras
+    uint8_t  readings_per_frame;    // leituras por pacote de telemetria
+    float    alert_rate;            // fração das leituras que geram alerta
+    float    duty_cycle;            // limite de lora_queue
+    bool     reliable;              // entrega confirmada (lora_reliable)
+    bool     adr;                   // taxa adaptativa (lora_adr)
+    uint8_t  max_sf;                // limite do ADR
+
+    // Gateway
+    bool     reply;                 // envia relatórios de enlace (SNR e ACK)
+} sim_node_config;
+
+typedef struct {
+    bool     radio_ok;              // lora_init encontrou o rádio
+    uint32_t readings;              // leituras geradas
+    uint32_t alerts;                // alertas gerados
+    uint32_t frames;                // lotes de telemetria gerados
+    uint32_t reports;               // relatórios de enlace recebidos
+    lora_queue_stats queue;
+    lora_power_stats power;
+    lora_reliable_stats reliable;
+    lora_adr_state adr;
+    lora_relay_stats relay;
+
+    lora_gateway_stats gateway;
+    uint32_t duplicates;            // pacotes repetidos recebidos pelo gateway
+} sim_node_stats;
+
+// Pontos de entrada do módulo
+typedef void (*sim_node_setup_fn)(const sim_node_config* config);
+typedef void (*sim_node_loop_fn)(void);
+typedef void (*sim_node_stats_fn)(sim_node_stats* stats);
+
+// Implementadas por lora_sim.c: acompanham cada pacote da criação à primeira
+// recepção no gateway, para medir entrega e latência de ponta a ponta
+void sim_frame_created(uint8_t node, uint16_t seq, uint8_t readings, bool alert);
+void sim_frame_received(uint8_t node, uint16_t seq);
+
+#endif // SIM_NODE_H
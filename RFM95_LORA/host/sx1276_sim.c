@@ -0,0 +1,828 @@
+#include "sx1276_sim.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Registradores do modo LoRa usados pelo modelo
+#define REG_FIFO                  0x00
+#define REG_OP_MODE               0x01
+#define REG_FRF_MSB               0x06
+#define REG_FRF_MID               0x07
+#define REG_FRF_LSB               0x08
+#define REG_PA_CONFIG             0x09
+#define REG_LNA                   0x0C
+#define REG_FIFO_ADDR_PTR         0x0D
+#define REG_FIFO_TX_BASE_ADDR     0x0E
+#define REG_FIFO_RX_BASE_ADDR     0x0F
+#define REG_FIFO_RX_CURRENT_ADDR  0x10
+#define REG_IRQ_FLAGS             0x12
+#define REG_RX_NB_BYTES           0x13
+#define REG_MODEM_STAT            0x18
+#define REG_PKT_SNR_VALUE         0x19
+#define REG_PKT_RSSI_VALUE        0x1A
+#define REG_RSSI_VALUE            0x1B
+#define REG_MODEM_CONFIG_1        0x1D
+#define REG_MODEM_CONFIG_2        0x1E
+#define REG_PREAMBLE_MSB          0x20
+#define REG_PREAMBLE_LSB          0x21
+#define REG_PAYLOAD_LENGTH        0x22
+#define REG_MAX_PAYLOAD_LENGTH    0x23
+#define REG_FIFO_RX_BYTE_ADDR     0x25
+#define REG_MODEM_CONFIG_3        0x26
+#define REG_INVERT_IQ             0x33
+#define REG_SYNC_WORD             0x39
+#define REG_DIO_MAPPING_1         0x40
+#define REG_VERSION               0x42
+#define REG_PA_DAC                0x4D
+
+#define MODE_LORA                 0x80
+#define MODE_SLEEP                0x00
+#define MODE_STDBY                0x01
+#define MODE_TX                   0x03
+#define MODE_RX_CONTINUOUS        0x05
+#define MODE_RX_SINGLE            0x06
+#define MODE_CAD                  0x07
+
+#define IRQ_CAD_DETECTED          0x01
+#define IRQ_CAD_DONE              0x04
+#define IRQ_TX_DONE               0x08
+#define IRQ_VALID_HEADER          0x10
+#define IRQ_PAYLOAD_CRC_ERROR     0x20
+#define IRQ_RX_DONE               0x40
+
+// Transmissões guardadas para avaliar colisões (reaproveitadas em anel)
+#define MAX_TRANSMISSIONS         2048
+
+// Interrupções seguidas do mesmo rádio sem reconhecimento antes de desistir
+#define MAX_IRQ_ROUNDS            16
+
+// Símbolos de preâmbulo que o receptor precisa ouvir para sincronizar
+#define SYNC_SYMBOLS              4
+
+// Duração do CAD em símbolos (recepção e processamento)
+#define CAD_SYMBOLS               2
+
+typedef struct {
+    double   x, y;
+    bool     multi_sf;
+    uint8_t  reg[128];
+    uint8_t  fifo[256];
+    uint8_t  rx_ptr;                // próxima posição escrita em RX
+
+    // Transação SPI em andamento
+    bool     selected;
+    bool     spi_write;
+    uint8_t  spi_addr;
+    int      spi_count;
+
+    uint64_t mode_since;            // início do modo atual (para mode_us)
+    uint64_t rx_since;              // desde quando ouve com a configuração atual
+    int      tx;                    // transmissão em andamento ou -1
+    int      last_tx;               // última transmissão deste rádio ou -1
+    uint64_t cad_start;
+    uint32_t cad_seq;               // distingue o fim de CADs interrompidos
+    bool     dio0;                  // nível atual do pino
+
+    // GPIO do DIO0 no microcontrolador deste rádio
+    irq_handler_t handler;
+    uint32_t irq_enabled;
+    uint32_t irq_pending;
+
+    sim_radio_stats stats;
+} radio_t;
+
+typedef struct {
+    int      src;
+    uint64_t start, end;
+    uint64_t preamble_end;
+    uint64_t lock_deadline;         // último instante para começar a ouvir
+    uint32_t frf;
+    uint8_t  sf, bw, sync;
+    bool     iq_inverted;
+    uint8_t  size;
+    uint8_t  data[256];
+    float    rssi[SIM_MAX_RADIOS];  // potência recebida em cada rádio (dBm)
+    bool     used;
+} transmission_t;
+
+typedef enum { EV_TX_END, EV_CAD_END, EV_ALARM, EV_CALL } event_type;
+
+typedef struct {
+    uint64_t time;
+    uint64_t order;                 // desempate: ordem de criação
+    event_type type;
+    int      radio;
+    int32_t  id;                    // transmissão, CAD ou alarme
+    alarm_callback_t alarm;
+    void   (*fn)(void*);
+    void*    arg;
+    uint32_t period_us;
+    bool     cancelled;
+} event_t;
+
+static sim_channel_config channel;
+static radio_t radios[SIM_MAX_RADIOS];
+static int radio_count = 0;
+static int current = 0;
+static float shadowing[SIM_MAX_RADIOS][SIM_MAX_RADIOS];
+
+static transmission_t transmissions[MAX_TRANSMISSIONS];
+static int next_transmission = 0;
+
+static event_t* events = NULL;
+static int event_count = 0;
+static int event_cap = 0;
+static uint64_t event_order = 0;
+static alarm_id_t next_alarm = 1;
+
+static uint64_t now = 0;
+static uint64_t rng_state = 1;
+
+static const double bandwidths[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+// ============================================================================
+// Números aleatórios e canal
+// ============================================================================
+
+double sim_random() {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return ((rng_state * 2685821657736338717ull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double sim_gaussian() {
+    double u = sim_random(), v = sim_random();
+    return sqrt(-2.0 * log(u + 1e-300)) * cos(2.0 * M_PI * v);
+}
+
+void sim_channel_default(sim_channel_config* config) {
+    config->ref_loss_db = 40.0;
+    config->path_loss_exp = 3.0;
+    config->shadowing_db = 4.0;
+    config->fading_db = 2.0;
+    config->noise_figure_db = 6.0;
+    config->capture_db = 6.0;
+    config->loss_rate = 0.0;
+    config->cad_payload_detect = 0.5;
+}
+
+double sim_distance(int a, int b) {
+    double dx = radios[a].x - radios[b].x, dy = radios[a].y - radios[b].y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+double sim_path_loss(int a, int b) {
+    double d = sim_distance(a, b);
+    if (d < 1.0)
+        d = 1.0;
+    return channel.ref_loss_db + 10.0 * channel.path_loss_exp * log10(d) + shadowing[a][b];
+}
+
+static double bandwidth_hz(uint8_t index) {
+    return bandwidths[index < 10 ? index : 9];
+}
+
+static double noise_floor_dbm(uint8_t bw) {
+    return -174.0 + 10.0 * log10(bandwidth_hz(bw)) + channel.noise_figure_db;
+}
+
+/* SNR mínimo de demodulação: -7,5 dB em SF7 até -20 dB em SF12 */
+static double required_snr(uint8_t sf) {
+    return -2.5 * (sf - 4);
+}
+
+// ============================================================================
+// Registradores
+// ============================================================================
+
+static uint8_t reg_mode(const radio_t* r) {
+    return r->reg[REG_OP_MODE] & 0x07;
+}
+
+static uint8_t reg_sf(const radio_t* r) {
+    return r->reg[REG_MODEM_CONFIG_2] >> 4;
+}
+
+static uint8_t reg_bw(const radio_t* r) {
+    return r->reg[REG_MODEM_CONFIG_1] >> 4;
+}
+
+/* RegInvertIQ: bit 6 inverte a recepção; bit 0 em zero inverte a transmissão */
+static bool reg_rx_inverted(const radio_t* r) {
+    return (r->reg[REG_INVERT_IQ] & 0x40) != 0;
+}
+
+static bool reg_tx_inverted(const radio_t* r) {
+    return (r->reg[REG_INVERT_IQ] & 0x01) == 0;
+}
+
+static uint32_t reg_frf(const radio_t* r) {
+    return ((uint32_t)r->reg[REG_FRF_MSB] << 16) | (r->reg[REG_FRF_MID] << 8) | r->reg[REG_FRF_LSB];
+}
+
+/* Potência de saída conforme REG_PA_CONFIG e REG_PA_DAC (dBm) */
+static double reg_tx_power(const radio_t* r) {
+    uint8_t pa = r->reg[REG_PA_CONFIG];
+    if (pa & 0x80) {
+        if ((r->reg[REG_PA_DAC] & 0x07) == 0x07)
+            return 5.0 + (pa & 0x0F);               // +20 dBm em alta potência
+        return 2.0 + (pa & 0x0F);
+    }
+    double pmax = 10.8 + 0.6 * ((pa >> 4) & 0x07);
+    return pmax - (15 - (pa & 0x0F));
+}
+
+static double reg_symbol_us(const radio_t* r) {
+    return (double)(1u << reg_sf(r)) * 1e6 / bandwidth_hz(reg_bw(r));
+}
+
+static int reg_preamble(const radio_t* r) {
+    return (r->reg[REG_PREAMBLE_MSB] << 8) | r->reg[REG_PREAMBLE_LSB];
+}
+
+/* Tempo no ar (datasheet SX1276, seção 4.1.1.7) com os registradores atuais */
+static uint64_t reg_time_on_air_us(const radio_t* r, uint8_t size) {
+    int sf = reg_sf(r);
+    double symbol_us = reg_symbol_us(r);
+    int cr = (r->reg[REG_MODEM_CONFIG_1] >> 1) & 0x07;
+    int implicit = r->reg[REG_MODEM_CONFIG_1] & 0x01;
+    int crc = (r->reg[REG_MODEM_CONFIG_2] >> 2) & 0x01;
+    int de = (r->reg[REG_MODEM_CONFIG_3] >> 3) & 0x01;
+    int preamble = reg_preamble(r);
+
+    int num = 8 * size - 4 * sf + 28 + 16 * crc - 20 * implicit;
+    int den = 4 * (sf - 2 * de);
+    int blocks = num > 0 ? (num + den - 1) / den : 0;
+    double symbols = preamble + 4.25 + 8 + blocks * (cr + 4);
+    return (uint64_t)ceil(symbols * symbol_us);
+}
+
+static void reset_registers(radio_t* r) {
+    memset(r->reg, 0, sizeof(r->reg));
+    memset(r->fifo, 0, sizeof(r->fifo));
+    r->reg[REG_OP_MODE] = 0x09;                 // FSK, standby
+    r->reg[REG_FRF_MSB] = 0x6C;                 // 434 MHz
+    r->reg[REG_FRF_MID] = 0x80;
+    r->reg[REG_PA_CONFIG] = 0x4F;
+    r->reg[REG_LNA] = 0x20;
+    r->reg[REG_FIFO_TX_BASE_ADDR] = 0x80;
+    r->reg[REG_MODEM_CONFIG_1] = 0x72;
+    r->reg[REG_MODEM_CONFIG_2] = 0x70;
+    r->reg[REG_PREAMBLE_LSB] = 0x08;
+    r->reg[REG_PAYLOAD_LENGTH] = 0x01;
+    r->reg[REG_MAX_PAYLOAD_LENGTH] = 0xFF;
+    r->reg[REG_INVERT_IQ] = 0x27;
+    r->reg[REG_SYNC_WORD] = 0x12;
+    r->reg[REG_VERSION] = 0x12;
+    r->reg[REG_PA_DAC] = 0x84;
+    r->rx_ptr = 0;
+}
+
+/* Nível do DIO0 conforme o mapeamento; a borda de subida vira interrupção */
+static void update_dio0(radio_t* r) {
+    static const uint8_t dio0_flags[4] = { IRQ_RX_DONE, IRQ_TX_DONE, IRQ_CAD_DONE, 0 };
+    bool level = (r->reg[REG_IRQ_FLAGS] & dio0_flags[r->reg[REG_DIO_MAPPING_1] >> 6]) != 0;
+    if (level && !r->dio0 && (r->irq_enabled & GPIO_IRQ_EDGE_RISE))
+        r->irq_pending |= GPIO_IRQ_EDGE_RISE;
+    r->dio0 = level;
+}
+
+// ============================================================================
+// Eventos
+// ============================================================================
+
+static bool event_before(const event_t* a, const event_t* b) {
+    return a->time < b->time || (a->time == b->time && a->order < b->order);
+}
+
+static void push_event(event_t ev) {
+    if (event_count == event_cap) {
+        event_cap = event_cap ? event_cap * 2 : 256;
+        events = realloc(events, event_cap * sizeof(event_t));
+    }
+    ev.order = event_order++;
+    int i = event_count++;
+    while (i > 0 && event_before(&ev, &events[(i - 1) / 2])) {
+        events[i] = events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    events[i] = ev;
+}
+
+static event_t pop_event() {
+    event_t top = events[0];
+    event_t last = events[--event_count];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= event_count)
+            break;
+        if (c + 1 < event_count && event_before(&events[c + 1], &events[c]))
+            c++;
+        if (!event_before(&events[c], &last))
+            break;
+        events[i] = events[c];
+        i = c;
+    }
+    events[i] = last;
+    return top;
+}
+
+// ============================================================================
+// Rádio
+// ============================================================================
+
+static void start_tx(int index);
+static void start_cad(int index);
+
+/* Troca o modo, contabilizando o tempo no anterior. Sair de TX no meio
+   interrompe a transmissão, como no chip */
+static void set_mode(int index, uint8_t mode) {
+    radio_t* r = &radios[index];
+    uint8_t old = reg_mode(r);
+    r->stats.mode_us[old] += now - r->mode_since;
+    r->mode_since = now;
+    r->reg[REG_OP_MODE] = (r->reg[REG_OP_MODE] & 0xF8) | mode;
+
+    if (old == MODE_TX && mode != MODE_TX && r->tx >= 0) {
+        transmissions[r->tx].end = now;         // segue interferindo até aqui
+        r->tx = -1;
+    }
+    if (mode == MODE_SLEEP)
+        memset(r->fifo, 0, sizeof(r->fifo));    // a FIFO não é mantida em sleep
+    if ((mode == MODE_RX_CONTINUOUS || mode == MODE_RX_SINGLE) && old != mode) {
+        r->rx_since = now;
+        r->rx_ptr = r->reg[REG_FIFO_RX_BASE_ADDR];
+    }
+    if (mode == MODE_TX && old != MODE_TX && (r->reg[REG_OP_MODE] & MODE_LORA))
+        start_tx(index);
+    if (mode == MODE_CAD && old != MODE_CAD && (r->reg[REG_OP_MODE] & MODE_LORA))
+        start_cad(index);
+}
+
+static void write_reg(int index, uint8_t addr, uint8_t value) {
+    radio_t* r = &radios[index];
+    switch (addr) {
+    case REG_FIFO:
+        r->fifo[r->reg[REG_FIFO_ADDR_PTR]++] = value;
+        break;
+    case REG_OP_MODE:
+        r->reg[REG_OP_MODE] = (value & 0xF8) | reg_mode(r);
+        set_mode(index, value & 0x07);
+        break;
+    case REG_IRQ_FLAGS:
+        r->reg[REG_IRQ_FLAGS] &= ~value;        // escrever 1 limpa a flag
+        update_dio0(r);
+        break;
+    case REG_DIO_MAPPING_1:
+        r->reg[addr] = value;
+        update_dio0(r);
+        break;
+    case REG_FIFO_RX_CURRENT_ADDR:
+    case REG_RX_NB_BYTES:
+    case REG_MODEM_STAT:
+    case REG_PKT_SNR_VALUE:
+    case REG_PKT_RSSI_VALUE:
+    case REG_RSSI_VALUE:
+    case REG_FIFO_RX_BYTE_ADDR:
+    case REG_VERSION:
+        break;                                  // somente leitura
+    case REG_FRF_MSB:
+    case REG_FRF_MID:
+    case REG_FRF_LSB:
+    case REG_MODEM_CONFIG_1:
+    case REG_MODEM_CONFIG_2:
+    case REG_SYNC_WORD:
+        // Reconfigurar durante RX reinicia a escuta
+        r->reg[addr] = value;
+        r->rx_since = now;
+        break;
+    default:
+        r->reg[addr & 0x7F] = value;
+        break;
+    }
+}
+
+static bool hears(const radio_t* r, const transmission_t* t);
+
+/* RegModemStat em RX: sinal detectado, sincronizado e recebendo (0x07) se
+   há uma transmissão no ar que o receptor acompanha desde o preâmbulo;
+   senão, modem livre (0x10) */
+static uint8_t modem_stat(int index) {
+    radio_t* r = &radios[index];
+    uint8_t mode = reg_mode(r);
+    if (mode != MODE_RX_CONTINUOUS && mode != MODE_RX_SINGLE)
+        return 0x10;
+    for (int k = 0; k < radio_count; k++) {
+        if (k == index || radios[k].last_tx < 0)
+            continue;
+        const transmission_t* t = &transmissions[radios[k].last_tx];
+        if (t->start <= now && t->end > now && now >= t->lock_deadline && hears(r, t) &&
+            t->rssi[index] - noise_floor_dbm(t->bw) >= required_snr(t->sf))
+            return 0x07;
+    }
+    return 0x10;
+}
+
+static uint8_t read_reg(int index, uint8_t addr) {
+    radio_t* r = &radios[index];
+    if (addr == REG_FIFO)
+        return r->fifo[r->reg[REG_FIFO_ADDR_PTR]++];
+    if (addr == REG_MODEM_STAT)
+        return modem_stat(index);
+    return r->reg[addr & 0x7F];
+}
+
+static void start_tx(int index) {
+    radio_t* r = &radios[index];
+    int id = next_transmission;
+    next_transmission = (next_transmission + 1) % MAX_TRANSMISSIONS;
+
+    transmission_t* t = &transmissions[id];
+    t->used = true;
+    t->src = index;
+    t->size = r->reg[REG_PAYLOAD_LENGTH];
+    for (int i = 0; i < t->size; i++)
+        t->data[i] = r->fifo[(uint8_t)(r->reg[REG_FIFO_TX_BASE_ADDR] + i)];
+    t->frf = reg_frf(r);
+    t->sf = reg_sf(r);
+    t->bw = reg_bw(r);
+    t->sync = r->reg[REG_SYNC_WORD];
+    t->iq_inverted = reg_tx_inverted(r);
+    t->start = now;
+    t->end = now + reg_time_on_air_us(r, t->size);
+    double symbol_us = reg_symbol_us(r);
+    int preamble = reg_preamble(r);
+    t->preamble_end = now + (uint64_t)((preamble + 4.25) * symbol_us);
+    t->lock_deadline = now + (uint64_t)((preamble > SYNC_SYMBOLS ? preamble - SYNC_SYMBOLS : 0) * symbol_us);
+
+    double power = reg_tx_power(r);
+    for (int k = 0; k < radio_count; k++) {
+        t->rssi[k] = k == index ? 0.0f
+                   : (float)(power - sim_path_loss(index, k) + channel.fading_db * sim_gaussian());
+    }
+
+    r->tx = id;
+    r->last_tx = id;
+    r->stats.tx_packets++;
+    push_event((event_t){ .time = t->end, .type = EV_TX_END, .radio = index, .id = id });
+}
+
+/* Copia o pacote para a FIFO do receptor e sinaliza RxDone */
+static void deliver(int index, const transmission_t* t, double rssi, double snr, bool crc_error) {
+    radio_t* r = &radios[index];
+    r->reg[REG_FIFO_RX_CURRENT_ADDR] = r->rx_ptr;
+    for (int i = 0; i < t->size; i++)
+        r->fifo[r->rx_ptr++] = t->data[i];
+    r->reg[REG_RX_NB_BYTES] = t->size;
+    r->reg[REG_FIFO_RX_BYTE_ADDR] = r->rx_ptr;
+
+    // Como no chip, o SNR satura perto de +10 dB em sinais fortes
+    double snr_reg = snr > 10.0 ? 10.0 : snr < -32.0 ? -32.0 : snr;
+    r->reg[REG_PKT_SNR_VALUE] = (uint8_t)(int8_t)lround(snr_reg * 4);
+    long rssi_reg = lround(rssi + 157 - (snr < 0 ? snr : 0));
+    r->reg[REG_PKT_RSSI_VALUE] = (uint8_t)(rssi_reg < 0 ? 0 : rssi_reg > 255 ? 255 : rssi_reg);
+
+    if (r->multi_sf) {
+        // O gateway passa a usar o SF/BW do pacote, para responder na mesma taxa
+        r->reg[REG_MODEM_CONFIG_1] = (r->reg[REG_MODEM_CONFIG_1] & 0x0F) | (t->bw << 4);
+        r->reg[REG_MODEM_CONFIG_2] = (r->reg[REG_MODEM_CONFIG_2] & 0x0F) | (t->sf << 4);
+        double symbol_us = (double)(1u << t->sf) * 1e6 / bandwidth_hz(t->bw);
+        if (symbol_us > 16000)
+            r->reg[REG_MODEM_CONFIG_3] |= 0x08;
+        else
+            r->reg[REG_MODEM_CONFIG_3] &= ~0x08;
+    }
+
+    r->reg[REG_IRQ_FLAGS] |= IRQ_RX_DONE | IRQ_VALID_HEADER | (crc_error ? IRQ_PAYLOAD_CRC_ERROR : 0);
+    if (crc_error)
+        r->stats.crc_errors++;
+    else
+        r->stats.rx_packets++;
+    if (reg_mode(r) == MODE_RX_SINGLE)
+        set_mode(index, MODE_STDBY);
+    update_dio0(r);
+}
+
+/* Receptor ouvindo desde o preâmbulo de t, no mesmo canal, SF, sync word e
+   polaridade de I/Q (o gateway de vários demoduladores ouve qualquer canal,
+   SF e BW) */
+static bool hears(const radio_t* r, const transmission_t* t) {
+    return r->rx_since <= t->lock_deadline &&
+           r->reg[REG_SYNC_WORD] == t->sync && reg_rx_inverted(r) == t->iq_inverted &&
+           (r->multi_sf || (reg_frf(r) == t->frf && reg_sf(r) == t->sf && reg_bw(r) == t->bw));
+}
+
+/* Decide se o rádio index recebe a transmissão t que acabou de terminar.
+   overlap lista as transmissões no mesmo canal e SF que se sobrepõem a t */
+static void receive(int index, const transmission_t* t, const int* overlap, int overlap_count) {
+    radio_t* r = &radios[index];
+    double rssi = t->rssi[index];
+    double snr = rssi - noise_floor_dbm(t->bw);
+    double required = required_snr(t->sf);
+
+    uint8_t mode = reg_mode(r);
+    bool listening = (r->reg[REG_OP_MODE] & MODE_LORA) &&
+                     (mode == MODE_RX_CONTINUOUS || mode == MODE_RX_SINGLE) && hears(r, t);
+    if (!listening) {
+        if (snr >= required)
+            r->stats.deaf++;
+        return;
+    }
+
+    // Colisão com outra transmissão no mesmo canal e SF, a menos que este
+    // pacote seja capture_db mais forte. Se o receptor já estava travado
+    // neste pacote, ele termina com erro de CRC
+    bool collided = false, locked = true;
+    for (int i = 0; i < overlap_count; i++) {
+        const transmission_t* q = &transmissions[overlap[i]];
+        if (q->src == index)
+            continue;
+        if (rssi - q->rssi[index] < channel.capture_db) {
+            collided = true;
+            if (q->start <= t->start)
+                locked = false;
+        }
+    }
+    if (collided) {
+        r->stats.collisions++;
+        if (locked)
+            deliver(index, t, rssi, snr, true);
+        return;
+    }
+
+    // Demodulação: a taxa de acerto cai em ~2 dB em torno do SNR mínimo
+    double success = 1.0 / (1.0 + exp(-(snr - required) / 0.5));
+    if (sim_random() >= success) {
+        if (snr >= required - 2.0)
+            deliver(index, t, rssi, snr, true);         // cabeçalho sim, dados não
+        else
+            r->stats.weak++;
+        return;
+    }
+    deliver(index, t, rssi, snr, sim_random() < channel.loss_rate);
+}
+
+static void tx_end(int id) {
+    transmission_t* t = &transmissions[id];
+    radio_t* r = &radios[t->src];
+    if (r->tx != id)
+        return;                                 // interrompida antes do fim
+    r->tx = -1;
+    r->reg[REG_IRQ_FLAGS] |= IRQ_TX_DONE;
+    set_mode(t->src, MODE_STDBY);               // o chip volta sozinho a standby
+    update_dio0(r);
+
+    static int overlap[MAX_TRANSMISSIONS];
+    int overlap_count = 0;
+    for (int i = 0; i < MAX_TRANSMISSIONS; i++) {
+        const transmission_t* q = &transmissions[i];
+        if (q->used && q != t && q->frf == t->frf && q->sf == t->sf && q->bw == t->bw &&
+            q->start < t->end && q->end > t->start)
+            overlap[overlap_count++] = i;
+    }
+    for (int k = 0; k < radio_count; k++) {
+        if (k != t->src)
+            receive(k, t, overlap, overlap_count);
+    }
+}
+
+static void start_cad(int index) {
+    radio_t* r = &radios[index];
+    r->cad_start = now;
+    uint64_t duration = (uint64_t)(CAD_SYMBOLS * reg_symbol_us(r));
+    push_event((event_t){ .time = now + duration, .type = EV_CAD_END, .radio = index,
+                          .id = (int32_t)++r->cad_seq });
+}
+
+/* Fim do CAD: detecta transmissões no mesmo canal e SF que estiveram no ar
+   durante a janela. No preâmbulo a chance segue a curva de demodulação; nos
+   dados ela é multiplicada por cad_payload_detect */
+static void cad_end(int index, uint32_t seq) {
+    radio_t* r = &radios[index];
+    if (r->cad_seq != seq || reg_mode(r) != MODE_CAD)
+        return;                                 // interrompido
+
+    bool detected = false;
+    for (int k = 0; k < radio_count && !detected; k++) {
+        if (k == index || radios[k].last_tx < 0)
+            continue;
+        const transmission_t* t = &transmissions[radios[k].last_tx];
+        if (t->start >= now || t->end <= r->cad_start || t->frf != reg_frf(r) ||
+            t->sf != reg_sf(r) || t->bw != reg_bw(r) || t->iq_inverted != reg_rx_inverted(r))
+            continue;
+        double snr = t->rssi[index] - noise_floor_dbm(t->bw);
+        double p = 1.0 / (1.0 + exp(-(snr - required_snr(t->sf)) / 0.5));
+        if (r->cad_start >= t->preamble_end)
+            p *= channel.cad_payload_detect;
+        detected = sim_random() < p;
+    }
+
+    r->reg[REG_IRQ_FLAGS] |= IRQ_CAD_DONE | (detected ? IRQ_CAD_DETECTED : 0);
+    set_mode(index, MODE_STDBY);                // o chip volta sozinho a standby
+    update_dio0(r);
+}
+
+/* Entrega as interrupções pendentes do DIO0 aos tratadores dos nós */
+static void dispatch_irqs() {
+    for (int round = 0; round < MAX_IRQ_ROUNDS; round++) {
+        bool any = false;
+        for (int k = 0; k < radio_count; k++) {
+            radio_t* r = &radios[k];
+            if ((r->irq_pending & r->irq_enabled) && r->handler) {
+                current = k;
+                r->handler();
+                any = true;
+            }
+        }
+        if (!any)
+            return;
+    }
+    for (int k = 0; k < radio_count; k++)
+        radios[k].irq_pending = 0;              // tratador que não reconhece
+}
+
+// ============================================================================
+// Interface pública
+// ============================================================================
+
+void sim_init(const sim_channel_config* config, uint64_t seed) {
+    channel = *config;
+    rng_state = seed ? seed : 1;
+    memset(radios, 0, sizeof(radios));
+    memset(transmissions, 0, sizeof(transmissions));
+    radio_count = 0;
+    current = 0;
+    next_transmission = 0;
+    event_count = 0;
+    event_order = 0;
+    next_alarm = 1;
+    now = 0;
+}
+
+int sim_add_radio(double x, double y, bool multi_sf) {
+    if (radio_count >= SIM_MAX_RADIOS)
+        return -1;
+    int index = radio_count++;
+    radio_t* r = &radios[index];
+    r->x = x;
+    r->y = y;
+    r->multi_sf = multi_sf;
+    r->tx = -1;
+    r->last_tx = -1;
+    r->mode_since = now;
+    reset_registers(r);
+
+    // Sombreamento fixo e simétrico de cada enlace
+    for (int k = 0; k < index; k++) {
+        shadowing[k][index] = shadowing[index][k] = (float)(channel.shadowing_db * sim_gaussian());
+    }
+    shadowing[index][index] = 0;
+    return index;
+}
+
+int sim_radio_count() {
+    return radio_count;
+}
+
+void sim_set_current(int radio) {
+    current = radio;
+}
+
+int sim_current() {
+    return current;
+}
+
+uint64_t sim_now() {
+    return now;
+}
+
+void sim_spi_select(bool selected) {
+    radio_t* r = &radios[current];
+    if (selected && !r->selected)
+        r->stats.spi_transactions++;
+    r->selected = selected;
+    r->spi_count = 0;
+}
+
+/* Primeiro byte: endereço (bit 7 = escrita). Os seguintes leem ou escrevem
+   a partir dele, avançando o endereço, exceto na FIFO */
+uint8_t sim_spi_transfer(uint8_t byte) {
+    radio_t* r = &radios[current];
+    if (!r->selected)
+        return 0xFF;
+    r->stats.spi_bytes++;
+    if (r->spi_count++ == 0) {
+        r->spi_addr = byte & 0x7F;
+        r->spi_write = (byte & 0x80) != 0;
+        return 0;
+    }
+    uint8_t out = 0;
+    if (r->spi_write)
+        write_reg(current, r->spi_addr, byte);
+    else
+        out = read_reg(current, r->spi_addr);
+    if (r->spi_addr != REG_FIFO)
+        r->spi_addr = (r->spi_addr + 1) & 0x7F;
+    return out;
+}
+
+void sim_radio_reset() {
+    radio_t* r = &radios[current];
+    set_mode(current, MODE_STDBY);
+    reset_registers(r);
+    r->dio0 = false;
+    r->rx_since = now;
+}
+
+void sim_irq_enable(uint32_t events, bool enabled) {
+    radio_t* r = &radios[current];
+    if (enabled)
+        r->irq_enabled |= events;
+    else
+        r->irq_enabled &= ~events;
+}
+
+void sim_irq_handler(irq_handler_t handler) {
+    radios[current].handler = handler;
+}
+
+uint32_t sim_irq_events() {
+    radio_t* r = &radios[current];
+    return r->irq_pending & r->irq_enabled;
+}
+
+void sim_irq_acknowledge(uint32_t events) {
+    radios[current].irq_pending &= ~events;
+}
+
+alarm_id_t sim_alarm_at(uint64_t time_us, alarm_callback_t callback, void* user_data) {
+    alarm_id_t id = next_alarm++;
+    push_event((event_t){ .time = time_us < now ? now : time_us, .type = EV_ALARM,
+                          .radio = current, .id = id, .alarm = callback, .arg = user_data });
+    return id;
+}
+
+bool sim_alarm_cancel(alarm_id_t id) {
+    for (int i = 0; i < event_count; i++) {
+        if (events[i].type == EV_ALARM && events[i].id == id && !events[i].cancelled) {
+            events[i].cancelled = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sim_call_at(int radio, uint64_t time_us, uint32_t period_us, void (*fn)(void*), void* arg) {
+    push_event((event_t){ .time = time_us, .type = EV_CALL, .radio = radio,
+                          .fn = fn, .arg = arg, .period_us = period_us });
+}
+
+void sim_run(uint64_t end_us) {
+    while (event_count > 0 && events[0].time <= end_us) {
+        event_t ev = pop_event();
+        if (ev.cancelled)
+            continue;
+        now = ev.time;
+
+        switch (ev.type) {
+        case EV_TX_END:
+            tx_end(ev.id);
+            break;
+        case EV_CAD_END:
+            cad_end(ev.radio, (uint32_t)ev.id);
+            break;
+        case EV_ALARM: {
+            current = ev.radio;
+            int64_t again = ev.alarm(ev.id, ev.arg);
+            // Como no SDK: > 0 conta do horário previsto, < 0 de agora
+            if (again != 0) {
+                ev.time = again > 0 ? ev.time + again : now - again;
+                push_event(ev);
+            }
+            break;
+        }
+        case EV_CALL:
+            current = ev.radio;
+            ev.fn(ev.arg);
+            if (ev.period_us) {
+                ev.time += ev.period_us;
+                push_event(ev);
+            }
+            break;
+        }
+        dispatch_irqs();
+    }
+    if (now < end_us)
+        now = end_us;
+}
+
+void sim_radio_get_stats(int radio, sim_radio_stats* stats) {
+    const radio_t* r = &radios[radio];
+    *stats = r->stats;
+    stats->mode_us[reg_mode(r)] += now - r->mode_since;
+}
@@ -0,0 +1,103 @@
+#ifndef SX1276_SIM_H
+#define SX1276_SIM_H
+
+#include "pico/stdlib.h"
+
+// Simulador do SX1276 (RFM95) no nível dos registradores, para rodar
+// lib/rfm95_lora.c e as camadas acima no Linux sem alterar o código.
+//
+// Cada rádio tem o banco de registradores do modo LoRa, a FIFO de 256 bytes
+// com os ponteiros de TX/RX, os modos de operação e as flags de interrupção
+// com o DIO0. O fim de TX e RX acontece depois do tempo no ar calculado a
+// partir dos próprios registradores (SF, BW, CR, preâmbulo, CRC, LDRO).
+//
+// O canal liga todos os rádios: perda de percurso log-distância com
+// sombreamento fixo por enlace e desvanecimento por pacote dão o RSSI e o
+// SNR de cada recepção; pacotes simultâneos no mesmo canal e SF colidem, a
+// menos que um seja capture_db mais forte; half-duplex e rádios fora de RX
+// perdem o pacote. O receptor sincroniza se ouvir ao menos os 4 últimos
+// símbolos do preâmbulo. O CAD detecta transmissões no mesmo canal e SF.
+// Pacotes com I/Q invertido só são ouvidos por receptores invertidos.
+//
+// O tempo é simulado: eventos (fim de pacote, alarmes, laços dos nós) são
+// processados em ordem e as interrupções do DIO0 são entregues entre eles.
+// Todas as chamadas do SDK (pico_sim.c) agem sobre o rádio "atual", o do nó
+// cujo código está rodando.
+
+#define SIM_MAX_RADIOS 64
+
+typedef struct {
+    double ref_loss_db;             // perda a 1 m
+    double path_loss_exp;           // expoente da perda log-distância
+    double shadowing_db;            // desvio padrão fixo de cada enlace
+    double fading_db;               // desvio padrão de cada pacote
+    double noise_figure_db;         // figura de ruído do receptor
+    double capture_db;              // vantagem que sobrevive a uma colisão
+    double loss_rate;               // perdas extras (interferência externa)
+    double cad_payload_detect;      // chance relativa do CAD nos dados (no preâmbulo = 1)
+} sim_channel_config;
+
+typedef struct {
+    uint32_t tx_packets;            // transmissões iniciadas
+    uint32_t rx_packets;            // pacotes entregues com CRC válido
+    uint32_t crc_errors;            // entregues com erro de CRC
+    uint32_t collisions;            // perdidos por outro pacote simultâneo
+    uint32_t weak;                  // abaixo da sensibilidade
+    uint32_t deaf;                  // perdidos fora de RX (TX, standby, outro SF)
+    uint64_t mode_us[8];            // tempo em cada modo (REG_OP_MODE & 7)
+    uint32_t spi_transactions;      // seleções do CS
+    uint32_t spi_bytes;             // bytes trocados, incluindo o de endereço
+} sim_radio_stats;
+
+// Parâmetros típicos de 915 MHz em área urbana aberta
+void sim_channel_default(sim_channel_config* config);
+
+// Reinicia o simulador: sem rádios, sem eventos, tempo zero
+void sim_init(const sim_channel_config* config, uint64_t seed);
+
+// Cria um rádio na posição (x, y) em metros. Um rádio multi_sf imita o
+// gateway de vários demoduladores (SX1301): recebe qualquer SF/BW em
+// qualquer canal e, a cada pacote, passa a usar o SF/BW dele (a resposta sai
+// na mesma taxa; o canal da resposta é escolhido pelo código do gateway)
+int sim_add_radio(double x, double y, bool multi_sf);
+int sim_radio_count();
+
+// Rádio cujo código está rodando (recebe as chamadas do SDK)
+void sim_set_current(int radio);
+int sim_current();
+
+uint64_t sim_now();
+
+// Acesso do SDK simulado ao rádio atual
+void sim_spi_select(bool selected);
+// Byte SPI: o primeiro após selecionar é o endereço (bit 7 = escrita)
+uint8_t sim_spi_transfer(uint8_t byte);
+void sim_radio_reset();
+
+void sim_irq_enable(uint32_t events, bool enabled);
+void sim_irq_handler(irq_handler_t handler);
+uint32_t sim_irq_events();
+void sim_irq_acknowledge(uint32_t events);
+
+// Alarmes do rádio atual (add_alarm_in_us)
+alarm_id_t sim_alarm_at(uint64_t time_us, alarm_callback_t callback, void* user_data);
+bool sim_alarm_cancel(alarm_id_t id);
+
+// Chama fn(arg) no contexto de um rádio no instante time_us e, se period_us
+// não for zero, repete a cada period_us
+void sim_call_at(int radio, uint64_t time_us, uint32_t period_us, void (*fn)(void*), void* arg);
+
+// Processa os eventos até o instante end_us
+void sim_run(uint64_t end_us);
+
+void sim_radio_get_stats(int radio, sim_radio_stats* stats);
+
+// Distância (m) e perda média de percurso (dB) entre dois rádios
+double sim_distance(int a, int b);
+double sim_path_loss(int a, int b);
+
+// Números aleatórios do simulador (reprodutíveis pela semente)
+double sim_random();
+double sim_gaussian();
+
+#endif // SX1276_SIM_H
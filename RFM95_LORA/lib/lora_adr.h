@@ -0,0 +1,70 @@
+#ifndef LORA_ADR_H
+#define LORA_ADR_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+
+// Taxa de dados adaptativa (ADR) do lado do nó. O gateway devolve o SNR com
+// que recebeu os uplinks (pacote LORA_FLAG_CONTROL de lora_telemetry.h) e o
+// nó escolhe SF, largura de banda e potência:
+//   - com margem sobrando (média dos últimos relatórios), acelera a taxa e
+//     depois reduz a potência, em passos de 3 dB;
+//   - com margem negativa, aumenta a potência e depois volta a taxa;
+//   - sem relatórios por ack_limit uplinks, considera o enlace perdido e
+//     sobe potência e SF até voltar a ouvir o gateway. Se o último relatório
+//     ainda tinha margem, a falta é tratada como colisão e só um silêncio 4x
+//     mais longo conta como enlace perdido.
+//
+// Os relatórios só chegam dos pacotes que passaram, então a média já é
+// otimista quanto ao desvanecimento; em redes congestionadas uma margem
+// grande leva nós à toa para SFs lentos, que ocupam mais o canal e estouram o
+// ciclo de trabalho (ver host/lora_sim, modos ack x adr).
+//
+// Um gateway de rádio único (SX127x, ESP32) recebe um só SF/BW: nesse caso
+// use min_sf == max_sf e max_bw = 125000, e o ADR ajusta só a potência.
+
+#ifndef LORA_ADR_HISTORY
+#define LORA_ADR_HISTORY 8          // relatórios guardados no máximo
+#endif
+
+typedef struct {
+    uint8_t min_sf, max_sf;         // faixa de SF permitida (7..12)
+    long    max_bw;                 // 125000, 250000 ou 500000
+    uint8_t min_power, max_power;   // dBm (2..17)
+    float   margin_db;              // margem exigida acima do SNR mínimo do SF
+    float   hysteresis_db;          // folga extra exigida para acelerar
+    uint8_t history;                // relatórios por decisão (<= LORA_ADR_HISTORY)
+    uint8_t ack_limit;              // uplinks sem relatório até tornar o enlace mais robusto
+} lora_adr_config;
+
+typedef struct {
+    uint8_t  sf;
+    long     bw;
+    uint8_t  power;
+    uint32_t changes;               // ajustes aplicados
+    uint16_t missed;                // uplinks seguidos sem relatório
+    float    last_snr;              // último SNR relatado (dB)
+} lora_adr_state;
+
+// Configuração padrão: SF7..12, 125 kHz, 2..17 dBm, margem 2 dB,
+// histerese 1,5 dB, decisões a cada 8 relatórios, enlace perdido após 8
+// uplinks (32 se o último relatório tinha margem)
+void lora_adr_default_config(lora_adr_config* config);
+
+// Inicia o ADR com os parâmetros atuais do rádio e os aplica
+void lora_adr_init(const lora_adr_config* config, uint8_t sf, long bw, uint8_t power);
+
+// Registra um uplink transmitido (conta relatórios que faltaram)
+void lora_adr_uplink();
+
+// Registra o SNR relatado pelo gateway para este nó. Pode ser chamada do
+// callback de recepção
+void lora_adr_report(float snr_db);
+
+// Leva ao rádio a configuração escolhida, se mudou e se não houver TX em
+// andamento. Retorna true quando aplicou uma mudança
+bool lora_adr_apply();
+
+void lora_adr_get_state(lora_adr_state* state);
+
+#endif // LORA_ADR_H
@@ -0,0 +1,63 @@
+#include "lora_gateway.h"
+#include "rfm95_lora.h"
+#include <string.h>
+#include "hardware/sync.h"
+
+#define SLOT_MASK (LORA_GATEWAY_SLOTS - 1)
+
+// Buffer circular: a interrupção só avança head, o consumidor só avança tail
+static lora_gateway_packet ring[LORA_GATEWAY_SLOTS];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static lora_gateway_stats stats;
+
+/* Chamada pela interrupção do DIO0 para cada pacote recebido */
+static void gateway_receive(const uint8_t* buffer, uint8_t size) {
+    uint32_t h = head;
+    if (h - tail >= LORA_GATEWAY_SLOTS) {
+        stats.overflows++;
+        return;
+    }
+
+    lora_gateway_packet* p = &ring[h & SLOT_MASK];
+    p->timestamp_us = time_us_64();
+    p->snr = lora_packet_snr();
+    // Abaixo do ruído, o RSSI do pacote precisa da correção pelo SNR
+    p->rssi = lora_packet_rssi() + (p->snr < 0 ? (int16_t)p->snr : 0);
+    p->size = size;
+    memcpy(p->data, buffer, size);
+
+    __dmb();                        // pacote completo antes de publicá-lo
+    head = h + 1;
+    stats.received++;
+    if (h + 1 - tail > stats.max_pending)
+        stats.max_pending = h + 1 - tail;
+}
+
+void lora_gateway_start() {
+    uint32_t irq = save_and_disable_interrupts();
+    head = tail = 0;
+    memset(&stats, 0, sizeof(stats));
+    restore_interrupts(irq);
+
+    lora_on_receive(gateway_receive);
+    lora_receive_async();
+}
+
+bool lora_gateway_pop(lora_gateway_packet* packet) {
+    uint32_t t = tail;
+    if (t == head)
+        return false;
+    __dmb();
+    *packet = ring[t & SLOT_MASK];
+    tail = t + 1;
+    return true;
+}
+
+void lora_gateway_get_stats(lora_gateway_stats* out) {
+    uint32_t irq = save_and_disable_interrupts();
+    *out = stats;
+    out->pending = head - tail;
+    out->crc_errors = lora_crc_errors();
+    restore_interrupts(irq);
+}
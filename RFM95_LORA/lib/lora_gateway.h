@@ -0,0 +1,42 @@
+#ifndef LORA_GATEWAY_H
+#define LORA_GATEWAY_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+
+// Modo gateway: o rádio fica em recepção contínua e a interrupção do DIO0
+// copia cada pacote, com RSSI, SNR e instante de chegada, para um buffer
+// circular. Consumidores (USB, cartão SD) retiram os pacotes no seu ritmo,
+// sem perder os que chegam em seguida.
+// O gateway usa lora_on_receive; respostas podem ser enviadas com
+// lora_send_packet_async ou lora_queue, e o rádio volta a receber sozinho.
+
+#ifndef LORA_GATEWAY_SLOTS
+#define LORA_GATEWAY_SLOTS 16       // pacotes no buffer (potência de 2)
+#endif
+
+typedef struct {
+    uint64_t timestamp_us;          // fim da recepção (time_us_64)
+    int16_t  rssi;                  // dBm
+    float    snr;                   // dB
+    uint8_t  size;
+    uint8_t  data[255];
+} lora_gateway_packet;
+
+typedef struct {
+    uint32_t received;              // pacotes com CRC válido
+    uint32_t crc_errors;            // pacotes descartados pelo rádio
+    uint32_t overflows;             // perdidos com o buffer cheio
+    uint8_t  pending;               // no buffer agora
+    uint8_t  max_pending;           // maior ocupação observada
+} lora_gateway_stats;
+
+// Entra em recepção contínua e começa a encher o buffer
+void lora_gateway_start();
+
+// Retira o pacote mais antigo; retorna false se o buffer estiver vazio
+bool lora_gateway_pop(lora_gateway_packet* packet);
+
+void lora_gateway_get_stats(lora_gateway_stats* stats);
+
+#endif // LORA_GATEWAY_H
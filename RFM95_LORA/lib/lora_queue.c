@@ -0,0 +1,207 @@
+#include "lora_queue.h"
+#include "rfm95_lora.h"
+#include <string.h>
+#include "hardware/sync.h"
+
+// Um pacote na fila
+typedef struct {
+    uint8_t  data[255];
+    uint8_t  size;
+    uint8_t  priority;
+    uint32_t order;                 // ordem de chegada (menor = mais antigo)
+    uint64_t queued_us;             // instante em que entrou na fila
+    bool     used;
+} queue_entry;
+
+static queue_entry entries[LORA_QUEUE_LEN];
+static uint32_t next_order = 0;
+static lora_queue_stats stats;
+
+// Crédito de tempo no ar (balde de fichas), em microssegundos * 1e6 para
+// acumular frações: cada microssegundo decorrido rende refill_ppm unidades.
+// Em qualquer janela de window_s o rádio transmite no máximo o balde cheio
+// mais o que rende na janela, então os dois dividem o limite: o balde guarda
+// 1/LORA_DUTY_BURST_DIV de duty_cycle * window_s e rende o restante
+static uint32_t duty_ppm = 1000000;
+static uint32_t refill_ppm = 1000000;
+static uint64_t credit = 0;
+static uint64_t credit_max = 0;
+static uint64_t credit_time_us = 0;
+static alarm_id_t retry_alarm = 0;
+static uint64_t sending_queued_us = 0;  // entrada na fila do pacote em transmissão
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+static bool duty_limited() {
+    return duty_ppm < 1000000;
+}
+
+/* Soma o crédito acumulado desde a última atualização */
+static void refill_credit() {
+    uint64_t now = time_us_64();
+    credit += (now - credit_time_us) * refill_ppm;
+    if (credit > credit_max)
+        credit = credit_max;
+    credit_time_us = now;
+}
+
+/* Índice do próximo pacote: maior prioridade, depois o mais antigo */
+static int next_entry() {
+    int best = -1;
+    for (int i = 0; i < LORA_QUEUE_LEN; i++) {
+        if (!entries[i].used)
+            continue;
+        if (best < 0 || entries[i].priority > entries[best].priority ||
+            (entries[i].priority == entries[best].priority && entries[i].order < entries[best].order))
+            best = i;
+    }
+    return best;
+}
+
+static int64_t retry_alarm_cb(alarm_id_t id, void* user_data);
+
+/* Transmite o próximo pacote se o rádio estiver livre e houver crédito.
+   Chamada com interrupções desativadas */
+static void try_send() {
+    if (lora_tx_busy())
+        return;
+    int i = next_entry();
+    if (i < 0)
+        return;
+
+    uint32_t toa = lora_time_on_air_us(entries[i].size);
+    uint64_t need = (uint64_t)toa * 1000000;
+    if (duty_limited()) {
+        refill_credit();
+        if (credit < need) {
+            // Tenta de novo quando o crédito for suficiente
+            if (retry_alarm <= 0) {
+                uint64_t wait_us = (need - credit) / refill_ppm + 1;
+                retry_alarm = add_alarm_in_us(wait_us, retry_alarm_cb, NULL, true);
+            }
+            return;
+        }
+    }
+
+    // O crédito só é gasto se a transmissão começou
+    if (!lora_send_packet_async(entries[i].data, entries[i].size))
+        return;
+    if (duty_limited())
+        credit -= need;
+    entries[i].used = false;
+    stats.depth--;
+    stats.airtime_us += toa;
+    sending_queued_us = entries[i].queued_us;
+}
+
+static int64_t retry_alarm_cb(alarm_id_t id, void* user_data) {
+    uint32_t irq = save_and_disable_interrupts();
+    retry_alarm = 0;
+    try_send();
+    restore_interrupts(irq);
+    return 0;                       // não repete
+}
+
+/* Chamada pela interrupção do DIO0 ao fim de cada transmissão */
+static void queue_tx_done() {
+    uint32_t irq = save_and_disable_interrupts();
+    stats.sent++;
+    uint64_t wait = time_us_64() - sending_queued_us;
+    stats.wait_us += wait;
+    if (wait > stats.max_wait_us)
+        stats.max_wait_us = (uint32_t)wait;
+    try_send();
+    restore_interrupts(irq);
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_queue_init(float duty_cycle, uint32_t window_s) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (retry_alarm > 0)
+        cancel_alarm(retry_alarm);
+    retry_alarm = 0;
+    memset(entries, 0, sizeof(entries));
+    memset(&stats, 0, sizeof(stats));
+    next_order = 0;
+
+    duty_ppm = duty_cycle >= 1.0f ? 1000000 : (uint32_t)(duty_cycle * 1000000.0f);
+    refill_ppm = duty_ppm - duty_ppm / LORA_DUTY_BURST_DIV;
+    credit_max = (uint64_t)window_s * 1000000 * (duty_ppm / LORA_DUTY_BURST_DIV);
+    credit = 0;                           // transmissões de antes de um reset não são conhecidas
+    credit_time_us = time_us_64();
+    restore_interrupts(irq);
+
+    lora_on_tx_done(queue_tx_done);
+}
+
+bool lora_queue_send(const uint8_t* buffer, uint8_t size, lora_priority priority) {
+    uint32_t irq = save_and_disable_interrupts();
+
+    // Um pacote mais longo que a janela inteira nunca seria transmitido
+    if (duty_limited() && (uint64_t)lora_time_on_air_us(size) * 1000000 > credit_max) {
+        stats.dropped++;
+        restore_interrupts(irq);
+        return false;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < LORA_QUEUE_LEN && slot < 0; i++) {
+        if (!entries[i].used)
+            slot = i;
+    }
+
+    if (slot < 0) {
+        // Fila cheia: descarta o mais antigo de menor prioridade, se for menor
+        for (int i = 0; i < LORA_QUEUE_LEN; i++) {
+            if (entries[i].priority >= priority)
+                continue;
+            if (slot < 0 || entries[i].priority < entries[slot].priority ||
+                (entries[i].priority == entries[slot].priority && entries[i].order < entries[slot].order))
+                slot = i;
+        }
+        stats.dropped++;
+        if (slot < 0) {
+            restore_interrupts(irq);
+            return false;
+        }
+        stats.depth--;
+    }
+
+    memcpy(entries[slot].data, buffer, size);
+    entries[slot].size = size;
+    entries[slot].priority = priority;
+    entries[slot].order = next_order++;
+    entries[slot].queued_us = time_us_64();
+    entries[slot].used = true;
+    stats.enqueued++;
+    if (++stats.depth > stats.max_depth)
+        stats.max_depth = stats.depth;
+
+    try_send();
+    restore_interrupts(irq);
+    return true;
+}
+
+bool lora_queue_contains(const uint8_t* buffer, uint8_t size) {
+    bool found = false;
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < LORA_QUEUE_LEN && !found; i++) {
+        found = entries[i].used && entries[i].size == size && memcmp(entries[i].data, buffer, size) == 0;
+    }
+    restore_interrupts(irq);
+    return found;
+}
+
+void lora_queue_get_stats(lora_queue_stats* out) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (duty_limited())
+        refill_credit();
+    *out = stats;
+    out->credit_us = duty_limited() ? (uint32_t)(credit / 1000000) : UINT32_MAX;
+    restore_interrupts(irq);
+}
@@ -0,0 +1,60 @@
+#ifndef LORA_QUEUE_H
+#define LORA_QUEUE_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+
+// Fila de transmissão LoRa com prioridade e limite de ciclo de trabalho.
+// Os pacotes saem pela interrupção de TxDone (lora_send_packet_async) e por
+// um alarme quando falta crédito de tempo no ar, sem bloquear o programa.
+// A fila usa lora_on_tx_done; a aplicação não deve registrar outro callback.
+
+#ifndef LORA_QUEUE_LEN
+#define LORA_QUEUE_LEN 8            // pacotes na fila
+#endif
+
+// Parte do limite da janela que pode sair em rajada (1/8); o resto é
+// liberado aos poucos
+#ifndef LORA_DUTY_BURST_DIV
+#define LORA_DUTY_BURST_DIV 8
+#endif
+
+typedef enum {
+    LORA_PRIORITY_LOW = 0,          // telemetria periódica
+    LORA_PRIORITY_NORMAL,
+    LORA_PRIORITY_HIGH              // alertas
+} lora_priority;
+
+typedef struct {
+    uint8_t  depth;                 // pacotes aguardando agora
+    uint8_t  max_depth;             // maior profundidade observada
+    uint32_t enqueued;              // pacotes aceitos
+    uint32_t sent;                  // transmissões concluídas
+    uint32_t dropped;               // descartados (fila cheia ou grandes demais)
+    uint64_t airtime_us;            // tempo no ar acumulado
+    uint64_t wait_us;               // da entrada na fila ao fim da transmissão, somado
+    uint32_t max_wait_us;           // o maior desses tempos
+    uint32_t credit_us;             // crédito de tempo no ar disponível agora
+} lora_queue_stats;
+
+// Inicializa a fila. duty_cycle é a fração do tempo que o rádio pode
+// transmitir (ex.: 0.01 = 1%) e window_s a janela em segundos (ex.: 3600):
+// em quaisquer window_s segundos o rádio transmite no máximo
+// duty_cycle * window_s. O crédito começa vazio e rende a
+// (1 - 1/LORA_DUTY_BURST_DIV) * duty_cycle, até juntar uma rajada de
+// duty_cycle * window_s / LORA_DUTY_BURST_DIV; pacotes mais longos que ela
+// são descartados. duty_cycle >= 1 desativa o limite
+void lora_queue_init(float duty_cycle, uint32_t window_s);
+
+// Coloca um pacote na fila e retorna sem esperar. Com a fila cheia, o pacote
+// mais antigo de prioridade menor é descartado; se não houver, o novo é
+// descartado e a função retorna false
+bool lora_queue_send(const uint8_t* buffer, uint8_t size, lora_priority priority);
+
+// Verdadeiro se um pacote com este conteúdo ainda aguarda na fila
+bool lora_queue_contains(const uint8_t* buffer, uint8_t size);
+
+// Preenche stats com os contadores atuais
+void lora_queue_get_stats(lora_queue_stats* stats);
+
+#endif // LORA_QUEUE_H
@@ -0,0 +1,279 @@
+#include "lora_relay.h"
+#include "lora_queue.h"
+#include <string.h>
+#include "hardware/sync.h"
+
+// Vizinho que anuncia rota até o gateway
+typedef struct {
+    uint8_t  id;
+    uint8_t  distance;              // saltos anunciados até o gateway
+    int16_t  rssi;                  // média móvel (dBm)
+    uint64_t heard_us;
+    bool     via_me;                // encaminha seus uplinks por este nó
+    bool     used;
+} neighbor_entry;
+
+// Rota de volta até uma origem
+typedef struct {
+    uint8_t  origin;
+    uint8_t  via;                   // vizinho que trouxe o pacote (a própria origem se direto)
+    uint8_t  hops;                  // saltos da origem até aqui
+    int16_t  rssi;
+    uint64_t heard_us;
+    bool     used;
+} route_entry;
+
+// Pacote visto recentemente
+typedef struct {
+    uint8_t  origin;
+    uint16_t seq;
+    bool     control;
+    uint64_t seen_us;
+} seen_entry;
+
+static lora_relay_config cfg;
+static lora_relay_stats stats;
+static neighbor_entry neighbors[LORA_RELAY_NEIGHBORS];
+static route_entry routes[LORA_RELAY_ROUTES];
+static seen_entry seen[LORA_RELAY_SEEN];
+static uint8_t seen_next = 0;
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+static bool is_gateway() {
+    return cfg.id == LORA_ROUTE_GATEWAY;
+}
+
+static bool fresh(uint64_t t, uint64_t now) {
+    return now - t < (uint64_t)cfg.expire_ms * 1000;
+}
+
+/* Verdadeiro se o enlace a (RSSI, distância) é melhor que b: enlace bom
+   primeiro; entre bons, menos saltos e depois mais sinal; entre fracos, mais
+   sinal */
+static bool better(int16_t rssi_a, uint8_t dist_a, int16_t rssi_b, uint8_t dist_b) {
+    bool good_a = rssi_a >= cfg.min_rssi, good_b = rssi_b >= cfg.min_rssi;
+    if (good_a != good_b)
+        return good_a;
+    if (good_a && dist_a != dist_b)
+        return dist_a < dist_b;
+    return rssi_a > rssi_b;
+}
+
+static void update_neighbor(uint8_t id, const lora_route* route, bool uplink, int16_t rssi, uint64_t now) {
+    int slot = -1;
+    for (int i = 0; i < LORA_RELAY_NEIGHBORS; i++) {
+        if (neighbors[i].used && neighbors[i].id == id) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 || !neighbors[i].used ||
+            (neighbors[slot].used && neighbors[i].heard_us < neighbors[slot].heard_us))
+            slot = i;               // livre ou o mais antigo
+    }
+
+    neighbor_entry* n = &neighbors[slot];
+    if (n->used && n->id == id && fresh(n->heard_us, now)) {
+        n->rssi = (int16_t)((3 * n->rssi + rssi) / 4);
+    } else {
+        n->id = id;
+        n->rssi = rssi;
+        n->via_me = false;
+        n->used = true;
+    }
+    n->distance = route->distance;
+    n->heard_us = now;
+    // Um vizinho que sobe por este nó não serve de rota (evita laços a dois)
+    if (uplink && route->next != LORA_ROUTE_ANY)
+        n->via_me = route->next == cfg.id;
+}
+
+static void update_route(uint8_t origin, uint8_t via, uint8_t hops, int16_t rssi, uint64_t now) {
+    int slot = -1;
+    for (int i = 0; i < LORA_RELAY_ROUTES; i++) {
+        if (routes[i].used && routes[i].origin == origin) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 || !routes[i].used ||
+            (routes[slot].used && routes[i].heard_us < routes[slot].heard_us))
+            slot = i;
+    }
+
+    route_entry* r = &routes[slot];
+    if (r->used && r->origin == origin && fresh(r->heard_us, now)) {
+        if (r->via == via) {
+            r->rssi = (int16_t)((3 * r->rssi + rssi) / 4);
+            r->hops = hops;
+            r->heard_us = now;
+        } else if (better(rssi, hops, r->rssi, r->hops)) {
+            *r = (route_entry){ origin, via, hops, rssi, now, true };
+        }
+        return;
+    }
+    *r = (route_entry){ origin, via, hops, rssi, now, true };
+}
+
+/* Próximo salto dos uplinks; atualiza a distância deste nó ao gateway */
+static uint8_t uplink_hop(uint64_t now) {
+    if (is_gateway()) {
+        stats.distance = 0;
+        return LORA_ROUTE_ANY;
+    }
+    int best = -1;
+    for (int i = 0; i < LORA_RELAY_NEIGHBORS; i++) {
+        const neighbor_entry* n = &neighbors[i];
+        if (!n->used || !fresh(n->heard_us, now) || n->distance >= 15 || n->via_me)
+            continue;
+        if (best < 0 || better(n->rssi, n->distance, neighbors[best].rssi, neighbors[best].distance))
+            best = i;
+    }
+    stats.distance = best < 0 ? LORA_ROUTE_UNKNOWN : neighbors[best].distance + 1;
+    stats.next_hop = best < 0 ? LORA_ROUTE_ANY : neighbors[best].id;
+    return stats.next_hop;
+}
+
+/* Próximo salto de um pacote de controle para o nó dest */
+static uint8_t downlink_hop(uint8_t dest, uint64_t now) {
+    for (int i = 0; i < LORA_RELAY_ROUTES; i++) {
+        if (routes[i].used && routes[i].origin == dest && fresh(routes[i].heard_us, now))
+            return routes[i].via;
+    }
+    return LORA_ROUTE_ANY;
+}
+
+/* Registra (origem, seq); retorna true se já tinha sido visto há pouco */
+static bool check_seen(uint8_t origin, uint16_t seq, bool control, uint64_t now) {
+    for (int i = 0; i < LORA_RELAY_SEEN; i++) {
+        const seen_entry* s = &seen[i];
+        if (s->seen_us && s->origin == origin && s->seq == seq && s->control == control &&
+            now - s->seen_us < (uint64_t)cfg.dup_ms * 1000)
+            return true;
+    }
+    seen[seen_next] = (seen_entry){ origin, seq, control, now };
+    seen_next = (seen_next + 1) % LORA_RELAY_SEEN;
+    return false;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_relay_default_config(lora_relay_config* config, uint8_t id) {
+    config->id = id;
+    config->forward = false;
+    config->hop_limit = 3;
+    config->min_rssi = -115;
+    config->dup_ms = 2000;
+    config->expire_ms = 600000;
+}
+
+void lora_relay_init(const lora_relay_config* config) {
+    uint32_t irq = save_and_disable_interrupts();
+    cfg = *config;
+    if (cfg.hop_limit > 15)
+        cfg.hop_limit = 15;
+    memset(&stats, 0, sizeof(stats));
+    memset(neighbors, 0, sizeof(neighbors));
+    memset(routes, 0, sizeof(routes));
+    memset(seen, 0, sizeof(seen));
+    seen_next = 0;
+    stats.distance = is_gateway() ? 0 : LORA_ROUTE_UNKNOWN;
+    stats.next_hop = LORA_ROUTE_ANY;
+    restore_interrupts(irq);
+}
+
+bool lora_relay_receive(const uint8_t* buf, uint8_t size, int16_t rssi) {
+    lora_route route;
+    if (!lora_route_get(buf, size, &route))
+        return true;                // pacote direto, de nós sem roteamento
+
+    uint8_t origin = buf[2];
+    uint16_t seq = buf[3] | (buf[4] << 8);
+    bool control = buf[1] & LORA_FLAG_CONTROL;
+    uint64_t now = time_us_64();
+
+    uint32_t irq = save_and_disable_interrupts();
+    stats.received++;
+    if (route.sender != cfg.id && route.distance < 15)
+        update_neighbor(route.sender, &route, !control, rssi, now);
+    if (!control && (cfg.forward || is_gateway()) && origin != cfg.id)
+        update_route(origin, route.sender, route.hops, rssi, now);
+
+    if (check_seen(origin, seq, control, now)) {
+        stats.duplicates++;
+        restore_interrupts(irq);
+        return false;
+    }
+    if (control ? origin == cfg.id : is_gateway()) {
+        stats.delivered++;
+        restore_interrupts(irq);
+        return true;
+    }
+    if (!cfg.forward || origin == cfg.id || (route.next != cfg.id && route.next != LORA_ROUTE_ANY)) {
+        restore_interrupts(irq);
+        return false;
+    }
+    if (route.hops >= route.limit) {
+        stats.hop_limit++;
+        restore_interrupts(irq);
+        return false;
+    }
+
+    route.hops++;
+    route.sender = cfg.id;
+    route.next = control ? downlink_hop(origin, now) : uplink_hop(now);
+    route.distance = stats.distance;
+    restore_interrupts(irq);
+
+    uint8_t copy[255];
+    memcpy(copy, buf, size);
+    lora_route_set(copy, size, &route);
+    bool urgent = buf[1] & (LORA_FLAG_ALERT | LORA_FLAG_CONTROL);
+    bool queued = lora_queue_send(copy, size, urgent ? LORA_PRIORITY_HIGH : LORA_PRIORITY_NORMAL);
+
+    irq = save_and_disable_interrupts();
+    if (queued) {
+        stats.forwarded++;
+        stats.forwarded_bytes += size;
+        if (buf[1] & LORA_FLAG_ALERT)
+            stats.forwarded_alerts++;
+    } else {
+        stats.queue_full++;
+    }
+    restore_interrupts(irq);
+    return false;
+}
+
+void lora_relay_prepare(uint8_t* buf, uint8_t size) {
+    lora_route route;
+    if (!lora_route_get(buf, size, &route))
+        return;
+
+    uint64_t now = time_us_64();
+    uint32_t irq = save_and_disable_interrupts();
+    route.hops = 0;
+    route.limit = cfg.hop_limit;
+    route.sender = cfg.id;
+    route.next = buf[1] & LORA_FLAG_CONTROL ? downlink_hop(buf[2], now) : uplink_hop(now);
+    // Só relés e o gateway se oferecem como próximo salto
+    route.distance = cfg.forward || is_gateway() ? stats.distance : LORA_ROUTE_UNKNOWN;
+    restore_interrupts(irq);
+    lora_route_set(buf, size, &route);
+}
+
+void lora_relay_get_stats(lora_relay_stats* out) {
+    uint64_t now = time_us_64();
+    uint32_t irq = save_and_disable_interrupts();
+    uplink_hop(now);
+    *out = stats;
+    out->neighbors = 0;
+    out->routes = 0;
+    for (int i = 0; i < LORA_RELAY_NEIGHBORS; i++)
+        out->neighbors += neighbors[i].used && fresh(neighbors[i].heard_us, now);
+    for (int i = 0; i < LORA_RELAY_ROUTES; i++)
+        out->routes += routes[i].used && fresh(routes[i].heard_us, now);
+    restore_interrupts(irq);
+}
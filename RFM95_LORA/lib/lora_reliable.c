@@ -0,0 +1,143 @@
+#include "lora_reliable.h"
+#include "lora_telemetry.h"
+#include <string.h>
+#include "hardware/sync.h"
+
+typedef struct {
+    uint8_t  data[255];
+    uint8_t  size;
+    uint8_t  priority;
+    uint8_t  retries;
+    uint16_t seq;
+    uint64_t deadline_us;           // próxima retransmissão
+    bool     used;
+} pending_entry;
+
+static pending_entry entries[LORA_RELIABLE_SLOTS];
+static lora_reliable_config cfg = { 3000, 4 };
+static lora_reliable_stats stats;
+static uint32_t jitter_state = 1;
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Espera até a próxima tentativa: timeout * 2^tentativas, com até 25% de
+   variação aleatória para que nós diferentes não repitam juntos */
+static uint64_t backoff_us(uint8_t retries) {
+    uint64_t wait = (uint64_t)cfg.timeout_ms * 1000 << (retries > 6 ? 6 : retries);
+    jitter_state = jitter_state * 1664525u + 1013904223u;
+    return wait + (wait / 4) * (jitter_state >> 16) / 65536;
+}
+
+static void count_pending() {
+    stats.pending = 0;
+    for (int i = 0; i < LORA_RELIABLE_SLOTS; i++) {
+        if (entries[i].used)
+            stats.pending++;
+    }
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_reliable_init(const lora_reliable_config* config) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (config)
+        cfg = *config;
+    memset(entries, 0, sizeof(entries));
+    memset(&stats, 0, sizeof(stats));
+    jitter_state = (uint32_t)time_us_64() | 1;
+    restore_interrupts(irq);
+}
+
+bool lora_reliable_send(const uint8_t* frame, uint8_t size, lora_priority priority) {
+    if (size < LORA_FRAME_HEADER)
+        return false;
+
+    uint32_t irq = save_and_disable_interrupts();
+    int slot = -1;
+    for (int i = 0; i < LORA_RELIABLE_SLOTS && slot < 0; i++) {
+        if (!entries[i].used)
+            slot = i;
+    }
+    if (slot < 0) {
+        // Deixa de acompanhar o mais antigo que não seja mais importante
+        for (int i = 0; i < LORA_RELIABLE_SLOTS; i++) {
+            if (entries[i].priority > priority)
+                continue;
+            if (slot < 0 || (uint16_t)(entries[i].seq - entries[slot].seq) >= 0x8000)
+                slot = i;
+        }
+        if (slot < 0) {
+            restore_interrupts(irq);
+            return false;
+        }
+        stats.evicted++;
+    }
+
+    pending_entry* e = &entries[slot];
+    memcpy(e->data, frame, size);
+    e->size = size;
+    e->priority = priority;
+    e->retries = 0;
+    e->seq = frame[3] | (frame[4] << 8);
+    e->deadline_us = time_us_64() + backoff_us(0);
+    e->used = true;
+    stats.sent++;
+    count_pending();
+    restore_interrupts(irq);
+
+    lora_queue_send(frame, size, priority);
+    return true;
+}
+
+void lora_reliable_ack(uint16_t last, uint32_t bitmap) {
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < LORA_RELIABLE_SLOTS; i++) {
+        if (entries[i].used && lora_ack_covers(last, bitmap, entries[i].seq)) {
+            entries[i].used = false;
+            stats.delivered++;
+        }
+    }
+    count_pending();
+    restore_interrupts(irq);
+}
+
+void lora_reliable_poll() {
+    uint64_t now = time_us_64();
+    for (int i = 0; i < LORA_RELIABLE_SLOTS; i++) {
+        uint32_t irq = save_and_disable_interrupts();
+        pending_entry* e = &entries[i];
+        if (!e->used || now < e->deadline_us) {
+            restore_interrupts(irq);
+            continue;
+        }
+        if (lora_queue_contains(e->data, e->size)) {
+            // Ainda na fila (sem crédito de tempo no ar): não conta como perda
+            e->deadline_us = now + backoff_us(e->retries);
+            restore_interrupts(irq);
+            continue;
+        }
+        if (e->retries >= cfg.max_retries) {
+            e->used = false;
+            stats.lost++;
+            count_pending();
+            restore_interrupts(irq);
+            continue;
+        }
+        e->retries++;
+        e->deadline_us = now + backoff_us(e->retries);
+        stats.retransmissions++;
+        restore_interrupts(irq);
+
+        lora_queue_send(e->data, e->size, (lora_priority)e->priority);
+    }
+}
+
+void lora_reliable_get_stats(lora_reliable_stats* out) {
+    uint32_t irq = save_and_disable_interrupts();
+    *out = stats;
+    restore_interrupts(irq);
+}
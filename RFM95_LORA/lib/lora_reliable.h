@@ -0,0 +1,49 @@
+#ifndef LORA_RELIABLE_H
+#define LORA_RELIABLE_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include "lora_queue.h"
+
+// Entrega confirmada sobre lora_queue. Cada pacote (formato de
+// lora_telemetry.h, já com seu número de sequência) fica guardado até que um
+// ACK do gateway o confirme. O ACK traz a última sequência recebida e um
+// bitmap das 32 anteriores, então vários pacotes seguem sem esperar uns pelos
+// outros e só os que faltarem são retransmitidos, com espera exponencial.
+
+#ifndef LORA_RELIABLE_SLOTS
+#define LORA_RELIABLE_SLOTS 8       // pacotes aguardando confirmação
+#endif
+
+typedef struct {
+    uint32_t timeout_ms;            // espera pelo ACK antes da 1ª retransmissão
+    uint8_t  max_retries;           // retransmissões antes de desistir
+} lora_reliable_config;
+
+typedef struct {
+    uint32_t sent;                  // pacotes distintos entregues à camada
+    uint32_t delivered;             // confirmados pelo gateway
+    uint32_t lost;                  // desistências após max_retries
+    uint32_t evicted;               // removidos sem confirmação (buffer cheio)
+    uint32_t retransmissions;       // transmissões extras
+    uint8_t  pending;               // aguardando ACK agora
+} lora_reliable_stats;
+
+// Inicializa a camada (timeout_ms 3000, max_retries 4 se config for NULL)
+void lora_reliable_init(const lora_reliable_config* config);
+
+// Envia um pacote com confirmação. Com o buffer cheio, o pacote pendente mais
+// antigo de prioridade igual ou menor deixa de ser acompanhado; se não houver,
+// retorna false
+bool lora_reliable_send(const uint8_t* frame, uint8_t size, lora_priority priority);
+
+// Registra um ACK recebido (LORA_SENSOR_ACK). Pode ser chamada do callback de
+// recepção
+void lora_reliable_ack(uint16_t last, uint32_t bitmap);
+
+// Retransmite os pacotes cujo prazo venceu; chamar no loop principal
+void lora_reliable_poll();
+
+void lora_reliable_get_stats(lora_reliable_stats* stats);
+
+#endif // LORA_RELIABLE_H
@@ -1,5 +1,9 @@
 #include "rfm95_lora.h"
 #include <string.h>
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/dma.h"
 
 // Definições dos Registradores LoRa (privado)
 #define REG_FIFO                  0x00
@@ -8,23 +12,36 @@
 #define REG_FRF_MID               0x07
 #define REG_FRF_LSB               0x08
 #define REG_PA_CONFIG             0x09
+#define REG_PA_RAMP               0x0A
+#define REG_OCP                   0x0B
 #define REG_LNA                   0x0C
 #define REG_FIFO_ADDR_PTR         0x0D
 #define REG_FIFO_TX_BASE_ADDR     0x0E
 #define REG_FIFO_RX_BASE_ADDR     0x0F
 #define REG_FIFO_RX_CURRENT_ADDR  0x10
+#define REG_IRQ_FLAGS_MASK        0x11
 #define REG_IRQ_FLAGS             0x12
 #define REG_RX_NB_BYTES           0x13
+#define REG_MODEM_STAT            0x18
 #define REG_PKT_SNR_VALUE         0x19
 #define REG_PKT_RSSI_VALUE        0x1A
 #define REG_MODEM_CONFIG_1        0x1D
 #define REG_MODEM_CONFIG_2        0x1E
+#define REG_SYMB_TIMEOUT_LSB      0x1F
 #define REG_PREAMBLE_MSB          0x20
 #define REG_PREAMBLE_LSB          0x21
 #define REG_PAYLOAD_LENGTH        0x22
 #define REG_MAX_PAYLOAD_LENGTH    0x23
-#define REG_DIO_MAPPING_1         0x40
+#define REG_HOP_PERIOD            0x24
+#define REG_RSSI_WIDEBAND         0x2C
+#define REG_MODEM_CONFIG_3        0x26
+#define REG_DETECTION_OPTIMIZE    0x31
+#define REG_INVERT_IQ             0x33
+#define REG_DETECTION_THRESHOLD   0x37
 #define REG_SYNC_WORD             0x39
+#define REG_INVERT_IQ_2           0x3B
+#define REG_DIO_MAPPING_1         0x40
+#define REG_DIO_MAPPING_2         0x41
 #define REG_VERSION               0x42
 #define REG_PA_DAC                0x4D
 
@@ -35,15 +52,121 @@
 #define MODE_TX                   0x03
 #define MODE_RX_CONTINUOUS        0x05
 #define MODE_RX_SINGLE            0x06
+#define MODE_CAD                  0x07
 
 // Máscaras de interrupção
 #define IRQ_RX_DONE_MASK          0x40
 #define IRQ_TX_DONE_MASK          0x08
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
+#define IRQ_CAD_DONE_MASK         0x04
+#define IRQ_CAD_DETECTED_MASK     0x01
+
+// REG_MODEM_STAT: receptor sincronizado em um preâmbulo
+#define MODEM_STAT_SYNCHRONIZED   0x02
+
+// Mapeamento do DIO0 (bits 7-6 de REG_DIO_MAPPING_1)
+#define DIO0_RX_DONE              0x00
+#define DIO0_TX_DONE              0x40
+#define DIO0_CAD_DONE             0x80
 
 // Frequência do cristal do módulo (Hz)
 #define RF_CRYSTAL_FREQ_HZ        32000000
 
+// Registradores abaixo deste endereço podem ficar na cópia local
+#define SHADOW_SIZE               0x50
+
+// Transferências da FIFO a partir deste tamanho usam DMA; nas menores, a
+// configuração dos canais custa mais que os bytes
+#ifndef RFM95_DMA_MIN
+#define RFM95_DMA_MIN             32
+#endif
+
+// Correntes típicas do RFM95 (datasheet SX1276, 915 MHz) para a estimativa
+// de carga, em nA. Em TX, interpolação linear no PA_BOOST entre 2 e 17 dBm
+#define CURRENT_SLEEP_NA          200
+#define CURRENT_STDBY_NA          1600000
+#define CURRENT_RX_NA             11500000     // LNA boost; CAD consome o mesmo
+#define CURRENT_TX_2DBM_NA        24000000
+#define CURRENT_TX_17DBM_NA       87000000
+
+// Estado da operação assíncrona (alterado pela interrupção do DIO0)
+static volatile bool tx_busy = false;
+static volatile bool rx_async = false;     // voltar a RX após cada TX
+static lora_tx_done_callback tx_done_cb = NULL;
+static lora_rx_callback rx_cb = NULL;
+static uint8_t rx_buffer[256];
+static int lock_depth = 0;
+static uint32_t lock_irq_state;
+static uint8_t op_mode = 0xFF;             // último modo escrito em REG_OP_MODE
+static volatile uint32_t crc_errors = 0;
+
+// Detecção de atividade no canal (CAD): por que ela foi iniciada
+typedef enum { CAD_NONE, CAD_LBT, CAD_WAKE } cad_purpose;
+static volatile uint8_t cad_state = CAD_NONE;
+
+// Escuta antes de transmitir: CAD antes de cada TX e espera aleatória em
+// unidades do tempo no ar do próprio pacote enquanto o canal estiver ocupado
+static uint8_t lbt_max_backoffs = 0;      // 0 desativa
+static uint8_t lbt_backoffs;
+static uint32_t lbt_slot_us;
+static alarm_id_t lbt_alarm = 0;
+static uint32_t rng_state = 1;
+
+// I/Q invertido em TX e em RX (o par gateway/nós usa polaridades opostas)
+static bool iq_tx_inverted = false;
+static bool iq_rx_inverted = false;
+
+// Recepção com despertar periódico: dorme, acorda para um CAD e só fica em
+// RX (janela) quando há preâmbulo no ar
+static uint32_t wake_period_us = 0;       // 0 = recepção contínua
+static uint32_t wake_cycle_us = 0;        // volta completa (varredura de canais)
+static bool wake_scan = false;            // cada despertar troca de canal
+static alarm_id_t wake_alarm = 0;
+static alarm_id_t window_alarm = 0;
+static volatile bool rx_window = false;
+static bool window_synced;                // janela estendida até o fim do pacote
+
+// Plano de canais (valores de REG_FRF) e canal atual; base_frf é o canal de
+// lora_set_frequency, usado sem plano
+static uint32_t base_frf = 0;
+static uint32_t channel_frf[LORA_MAX_CHANNELS];
+static uint8_t channel_count = 0;
+static uint8_t channel_current = 0;
+static lora_channel_select channel_select = NULL;
+
+// Tempo e carga em cada modo, desde lora_init
+static uint8_t  power_mode = MODE_STDBY;
+static uint64_t power_since = 0;
+static uint64_t mode_time_us[8];
+static uint64_t charge_na_ms = 0;
+static uint8_t  cfg_power = 17;
+static lora_power_stats power_counts;     // só os contadores de eventos
+
+// Cópia dos registradores de configuração, que o rádio não altera sozinho:
+// escritas de valores iguais são omitidas e leituras não usam o SPI
+static uint8_t shadow[SHADOW_SIZE];
+static bool shadow_valid[SHADOW_SIZE];
+
+// RSSI e SNR do último pacote, lidos junto com ele
+static uint8_t pkt_snr_value = 0;
+static uint8_t pkt_rssi_value = 0;
+
+// Canais de DMA da FIFO (TX para o SPI e RX do SPI)
+static int dma_tx = -1;
+static int dma_rx = -1;
+static uint8_t dma_dummy;
+
+// Configuração atual do modem, usada no cálculo do tempo no ar
+static uint8_t  cfg_sf = 7;
+static uint8_t  cfg_bw_index = 7;          // índice em bandwidths[] (125 kHz)
+static uint8_t  cfg_cr = 1;                // 1..4 → 4/5..4/8
+static uint16_t cfg_preamble = 8;
+
+// Larguras de banda aceitas pelo campo Bw de REG_MODEM_CONFIG_1
+static const long bandwidths[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
 // ============================================================================
 // Funções Privadas
 // ============================================================================
@@ -74,24 +197,398 @@ static void rmf95_write_reg(uint8_t reg, uint8_t value) {
     gpio_put(PIN_CS, 1);
 }
 
-/* Lê um bloco de dados a partir da FIFO */
-static void rmf95_read_fifo(uint8_t* buffer, uint8_t length) {
-    uint8_t addr = REG_FIFO & 0x7F;
+/* Troca length bytes pelo SPI com DMA: tx NULL envia zeros, rx NULL descarta.
+   O canal RX sempre roda, para a FIFO de recepção do SPI não transbordar */
+static void rfm95_dma_transfer(const uint8_t* tx, uint8_t* rx, size_t length) {
+    dma_channel_config c = dma_channel_get_default_config(dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(SPI_PORT, true));
+    channel_config_set_read_increment(&c, tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(dma_tx, &c, &spi_get_hw(SPI_PORT)->dr, tx ? tx : &dma_dummy, length, false);
+
+    c = dma_channel_get_default_config(dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(SPI_PORT, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rx != NULL);
+    dma_channel_configure(dma_rx, &c, rx ? rx : &dma_dummy, &spi_get_hw(SPI_PORT)->dr, length, false);
+
+    dma_dummy = 0;
+    dma_start_channel_mask((1u << dma_tx) | (1u << dma_rx));
+    dma_channel_wait_for_finish_blocking(dma_rx);
+}
+
+/* Lê length registradores a partir de reg em uma só transação: o SX127x
+   avança o endereço a cada byte (na FIFO, avança o ponteiro dela) */
+static void rfm95_read_burst(uint8_t reg, uint8_t* buffer, uint8_t length) {
+    uint8_t addr = reg & 0x7F;
     gpio_put(PIN_CS, 0);
     spi_write_blocking(SPI_PORT, &addr, 1);
-    spi_read_blocking(SPI_PORT, 0, buffer, length);
+    if (length >= RFM95_DMA_MIN && dma_rx >= 0)
+        rfm95_dma_transfer(NULL, buffer, length);
+    else
+        spi_read_blocking(SPI_PORT, 0, buffer, length);
     gpio_put(PIN_CS, 1);
 }
 
-/* Escreve um bloco de dados na FIFO */
-static void rmf95_write_fifo(const uint8_t* buffer, uint8_t length) {
-    uint8_t addr = REG_FIFO | 0x80;
+/* Escreve length registradores a partir de reg em uma só transação */
+static void rfm95_write_burst(uint8_t reg, const uint8_t* data, uint8_t length) {
+    uint8_t addr = reg | 0x80;
     gpio_put(PIN_CS, 0);
     spi_write_blocking(SPI_PORT, &addr, 1);
-    spi_write_blocking(SPI_PORT, buffer, length);
+    if (length >= RFM95_DMA_MIN && dma_tx >= 0)
+        rfm95_dma_transfer(data, NULL, length);
+    else
+        spi_write_blocking(SPI_PORT, data, length);
     gpio_put(PIN_CS, 1);
 }
 
+/* Registradores de configuração: só mudam quando escritos pelo SPI */
+static bool rfm95_cacheable(uint8_t reg) {
+    switch (reg) {
+    case REG_FRF_MSB: case REG_FRF_MID: case REG_FRF_LSB:
+    case REG_PA_CONFIG: case REG_PA_RAMP: case REG_OCP: case REG_LNA:
+    case REG_FIFO_TX_BASE_ADDR: case REG_FIFO_RX_BASE_ADDR: case REG_IRQ_FLAGS_MASK:
+    case REG_MODEM_CONFIG_1: case REG_MODEM_CONFIG_2: case REG_SYMB_TIMEOUT_LSB:
+    case REG_PREAMBLE_MSB: case REG_PREAMBLE_LSB:
+    case REG_PAYLOAD_LENGTH: case REG_MAX_PAYLOAD_LENGTH: case REG_HOP_PERIOD:
+    case REG_MODEM_CONFIG_3: case REG_DETECTION_OPTIMIZE: case REG_INVERT_IQ:
+    case REG_DETECTION_THRESHOLD: case REG_SYNC_WORD: case REG_INVERT_IQ_2:
+    case REG_DIO_MAPPING_1: case REG_DIO_MAPPING_2: case REG_PA_DAC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void rfm95_shadow_store(uint8_t reg, const uint8_t* values, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++, reg++) {
+        if (reg < SHADOW_SIZE && rfm95_cacheable(reg)) {
+            shadow[reg] = values[i];
+            shadow_valid[reg] = true;
+        }
+    }
+}
+
+/* Registrador de configuração, da cópia local quando já conhecido */
+static uint8_t rfm95_read_cfg(uint8_t reg) {
+    if (!shadow_valid[reg]) {
+        shadow[reg] = rmf95_read_reg(reg);
+        shadow_valid[reg] = true;
+    }
+    return shadow[reg];
+}
+
+/* Escreve registradores de configuração consecutivos a partir do primeiro
+   que mudou até o último do bloco (FRF e preâmbulo valem ao escrever o LSB);
+   não acessa o SPI se nada mudou */
+static void rfm95_write_cfg(uint8_t reg, const uint8_t* values, uint8_t length) {
+    uint8_t first = 0;
+    while (first < length && shadow_valid[reg + first] && shadow[reg + first] == values[first])
+        first++;
+    if (first == length)
+        return;
+    rfm95_write_burst(reg + first, values + first, length - first);
+    rfm95_shadow_store(reg + first, values + first, length - first);
+}
+
+static void rfm95_write_cfg_reg(uint8_t reg, uint8_t value) {
+    rfm95_write_cfg(reg, &value, 1);
+}
+
+/* Impede que interrupções (DIO0, alarmes da fila) usem o SPI no meio de
+   uma sequência de acessos. Eventos de borda continuam registrados e são
+   atendidos ao liberar */
+static void rfm95_lock() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (lock_depth++ == 0)
+        lock_irq_state = irq;
+}
+
+static void rfm95_unlock() {
+    if (--lock_depth == 0)
+        restore_interrupts(lock_irq_state);
+}
+
+/* Corrente estimada do modo, em nA */
+static uint32_t rfm95_mode_current_na(uint8_t mode) {
+    switch (mode) {
+    case MODE_SLEEP:
+        return CURRENT_SLEEP_NA;
+    case MODE_TX:
+        return CURRENT_TX_2DBM_NA +
+               (CURRENT_TX_17DBM_NA - CURRENT_TX_2DBM_NA) / 15 * (cfg_power - 2);
+    case MODE_RX_CONTINUOUS:
+    case MODE_RX_SINGLE:
+    case MODE_CAD:
+        return CURRENT_RX_NA;
+    default:
+        return CURRENT_STDBY_NA;        // standby e sínteses de frequência
+    }
+}
+
+/* Fecha o intervalo do modo anterior e passa a contar o novo */
+static void rfm95_power_account(uint8_t mode) {
+    uint64_t now = time_us_64();
+    uint64_t elapsed = now - power_since;
+    mode_time_us[power_mode] += elapsed;
+    charge_na_ms += elapsed * rfm95_mode_current_na(power_mode) / 1000;
+    power_mode = mode & 0x07;
+    power_since = now;
+}
+
+/* Troca o modo de operação; não reescreve o modo em que o rádio já está */
+static void rfm95_set_mode(uint8_t mode) {
+    if (op_mode == mode)
+        return;
+    rmf95_write_reg(REG_OP_MODE, MODE_LORA | mode);
+    op_mode = mode;
+    rfm95_power_account(mode);
+}
+
+static uint32_t rfm95_random() {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static uint32_t rfm95_frf(long frequency) {
+    return (uint32_t)(((uint64_t)frequency << 19) / RF_CRYSTAL_FREQ_HZ);
+}
+
+/* A cópia dos registradores omite a escrita quando a frequência não muda */
+static void rfm95_write_frf(uint32_t frf) {
+    uint8_t regs[] = { (uint8_t)(frf >> 16), (uint8_t)(frf >> 8), (uint8_t)frf };
+    rfm95_write_cfg(REG_FRF_MSB, regs, 3);
+}
+
+/* Sintoniza um canal do plano */
+static void rfm95_set_channel(uint8_t channel) {
+    rfm95_write_frf(channel_frf[channel]);
+    channel_current = channel;
+}
+
+/* Low Data Rate Optimize é obrigatório quando o símbolo passa de 16 ms */
+static void rfm95_update_ldro() {
+    uint32_t symbol_us = (uint32_t)(((1ull << cfg_sf) * 1000000) / bandwidths[cfg_bw_index]);
+    uint8_t cfg3 = rfm95_read_cfg(REG_MODEM_CONFIG_3);
+    if (symbol_us > 16000)
+        cfg3 |= 0x08;
+    else
+        cfg3 &= ~0x08;
+    rfm95_write_cfg_reg(REG_MODEM_CONFIG_3, cfg3);
+}
+
+/* Polaridade de I/Q para a próxima operação (valores da nota de aplicação
+   da Semtech). Sem inversão configurada desde o reset, nada é escrito */
+static void rfm95_set_iq(bool inverted) {
+    if (!inverted && !shadow_valid[REG_INVERT_IQ])
+        return;                     // valores de fábrica: I/Q normal
+    rfm95_write_cfg_reg(REG_INVERT_IQ, inverted ? 0x66 : 0x27);
+    rfm95_write_cfg_reg(REG_INVERT_IQ_2, inverted ? 0x19 : 0x1D);
+}
+
+/* Entra em recepção contínua com o DIO0 sinalizando RxDone */
+static void rfm95_start_rx() {
+    rfm95_set_iq(iq_rx_inverted);
+    rfm95_write_cfg_reg(REG_DIO_MAPPING_1, DIO0_RX_DONE);
+    rmf95_write_reg(REG_FIFO_ADDR_PTR, 0);
+    rfm95_set_mode(MODE_RX_CONTINUOUS);
+}
+
+/* Inicia um CAD; o DIO0 sinaliza CadDone e o rádio volta sozinho a standby.
+   O LBT procura uplinks (I/Q normal): num nó, pacotes como o seu; no gateway,
+   os que ele está recebendo. O despertar procura os dirigidos a este rádio */
+static void rfm95_start_cad(cad_purpose purpose) {
+    rfm95_set_mode(MODE_STDBY);
+    rfm95_set_iq(purpose == CAD_LBT ? false : iq_rx_inverted);
+    rfm95_write_cfg_reg(REG_DIO_MAPPING_1, DIO0_CAD_DONE);
+    cad_state = purpose;
+    power_counts.cad_runs++;
+    rfm95_set_mode(MODE_CAD);
+    op_mode = 0xFF;
+}
+
+/* Transmite o pacote que já está na FIFO */
+static void rfm95_start_tx() {
+    rfm95_set_iq(iq_tx_inverted);
+    rfm95_write_cfg_reg(REG_DIO_MAPPING_1, DIO0_TX_DONE);
+    rfm95_set_mode(MODE_TX);
+    op_mode = 0xFF;                 // o rádio volta sozinho a standby após TxDone
+}
+
+/* Fecha a janela de recepção aberta por um despertar */
+static void rfm95_close_window() {
+    if (window_alarm > 0)
+        cancel_alarm(window_alarm);
+    window_alarm = 0;
+    rx_window = false;
+}
+
+/* Para o despertar periódico (a recepção contínua ou o sleep assumem) */
+static void rfm95_stop_wake() {
+    if (wake_alarm > 0)
+        cancel_alarm(wake_alarm);
+    wake_alarm = 0;
+    wake_period_us = 0;
+    wake_scan = false;
+    rfm95_close_window();
+}
+
+/* Estado do rádio quando não há TX: RX contínuo, sleep entre despertares
+   ou standby */
+static void rfm95_resume_rx() {
+    if (wake_period_us)
+        rfm95_set_mode(MODE_SLEEP);
+    else if (rx_async)
+        rfm95_start_rx();
+    else
+        rfm95_set_mode(MODE_STDBY);
+}
+
+static int64_t rfm95_lbt_alarm(alarm_id_t id, void* user_data) {
+    rfm95_lock();
+    lbt_alarm = 0;
+    if (tx_busy && cad_state == CAD_NONE)
+        rfm95_start_cad(CAD_LBT);
+    rfm95_unlock();
+    return 0;
+}
+
+/* Canal ocupado: espera de 1 a 2^n vezes o tempo no ar do pacote e escuta
+   de novo. Esgotadas as tentativas, transmite mesmo assim */
+static void rfm95_lbt_result(bool busy) {
+    if (busy && lbt_backoffs < lbt_max_backoffs) {
+        lbt_backoffs++;
+        power_counts.lbt_backoffs++;
+        uint32_t slots = 1 + rfm95_random() % (1u << lbt_backoffs);
+        lbt_alarm = add_alarm_in_us((uint64_t)slots * lbt_slot_us, rfm95_lbt_alarm, NULL, true);
+        return;                     // espera em standby: o sleep apagaria a FIFO
+    }
+    if (busy)
+        power_counts.lbt_forced++;
+    rfm95_start_tx();
+}
+
+/* Preâmbulo de despertar já terminou: com o receptor sincronizado, espera o
+   pacote inteiro; senão o CAD viu dados de um pacote alheio ou ruído */
+static int64_t rfm95_window_alarm(alarm_id_t id, void* user_data) {
+    rfm95_lock();
+    if (rx_window && !window_synced && (rmf95_read_reg(REG_MODEM_STAT) & MODEM_STAT_SYNCHRONIZED)) {
+        window_synced = true;
+        rfm95_unlock();
+        return lora_time_on_air_us(255);
+    }
+    window_alarm = 0;
+    if (rx_window) {
+        rx_window = false;          // detecção sem pacote (ou pacote perdido)
+        if (!tx_busy)
+            rfm95_set_mode(MODE_SLEEP);
+    }
+    rfm95_unlock();
+    return 0;
+}
+
+static int64_t rfm95_wake_alarm(alarm_id_t id, void* user_data) {
+    rfm95_lock();
+    uint32_t period = wake_period_us;
+    if (period && !tx_busy && !rx_window && cad_state == CAD_NONE) {
+        if (wake_scan)
+            rfm95_set_channel((channel_current + 1) % channel_count);
+        rfm95_start_cad(CAD_WAKE);
+    }
+    rfm95_unlock();
+    return period;                  // repete a partir do horário previsto
+}
+
+/* Atividade detectada: recebe até o fim do preâmbulo de despertar mais
+   alguns símbolos; sem nada no ar, volta a dormir */
+static void rfm95_wake_result(bool detected) {
+    if (!detected) {
+        rfm95_set_mode(MODE_SLEEP);
+        return;
+    }
+    power_counts.rx_windows++;
+    rx_window = true;
+    window_synced = false;
+    rfm95_start_rx();
+    uint64_t symbol_us = ((1ull << cfg_sf) * 1000000) / bandwidths[cfg_bw_index];
+    uint64_t search_us = (lora_wake_preamble_length(wake_cycle_us / 1000) + 4) * symbol_us;
+    window_alarm = add_alarm_in_us(search_us, rfm95_window_alarm, NULL, true);
+}
+
+/* Copia o último pacote recebido da FIFO, guardando RSSI e SNR. Os
+   registradores vizinhos são lidos em rajada */
+static uint8_t rfm95_read_packet(uint8_t* buffer, int max_size) {
+    uint8_t info[4];                // FifoRxCurrentAddr, IrqFlagsMask, IrqFlags, RxNbBytes
+    uint8_t quality[2];             // PktSnrValue, PktRssiValue
+    rfm95_read_burst(REG_FIFO_RX_CURRENT_ADDR, info, sizeof(info));
+    rfm95_read_burst(REG_PKT_SNR_VALUE, quality, sizeof(quality));
+    pkt_snr_value = quality[0];
+    pkt_rssi_value = quality[1];
+
+    uint8_t len = info[3];
+    if (len > max_size) len = max_size;
+    rmf95_write_reg(REG_FIFO_ADDR_PTR, info[0]);
+    rfm95_read_burst(REG_FIFO, buffer, len);
+    return len;
+}
+
+/* Tratador da interrupção do DIO0: conclui TX e entrega pacotes recebidos */
+static void rfm95_dio0_irq() {
+    if (!(gpio_get_irq_event_mask(PIN_DIO0) & GPIO_IRQ_EDGE_RISE))
+        return;
+    gpio_acknowledge_irq(PIN_DIO0, GPIO_IRQ_EDGE_RISE);
+
+    uint8_t irq = rmf95_read_reg(REG_IRQ_FLAGS);
+
+    if ((irq & IRQ_CAD_DONE_MASK) && cad_state != CAD_NONE) {
+        rmf95_write_reg(REG_IRQ_FLAGS, IRQ_CAD_DONE_MASK | IRQ_CAD_DETECTED_MASK);
+        rfm95_power_account(MODE_STDBY);
+        op_mode = MODE_STDBY;
+        bool detected = (irq & IRQ_CAD_DETECTED_MASK) != 0;
+        if (detected)
+            power_counts.cad_detections++;
+        uint8_t purpose = cad_state;
+        cad_state = CAD_NONE;
+        if (purpose == CAD_LBT)
+            rfm95_lbt_result(detected);
+        else
+            rfm95_wake_result(detected);
+    }
+
+    if ((irq & IRQ_TX_DONE_MASK) && tx_busy) {
+        rmf95_write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);   // limpa flag
+        rfm95_power_account(MODE_STDBY);
+        rfm95_resume_rx();
+        tx_busy = false;
+        __sev();                                    // acorda lora_send_packet
+        if (tx_done_cb)
+            tx_done_cb();
+    }
+
+    // Sem recepção assíncrona o pacote fica para lora_receive_packet
+    if ((irq & IRQ_RX_DONE_MASK) && rx_async) {
+        rmf95_write_reg(REG_IRQ_FLAGS, IRQ_RX_DONE_MASK | IRQ_PAYLOAD_CRC_ERROR_MASK);
+        bool valid = !(irq & IRQ_PAYLOAD_CRC_ERROR_MASK);
+        uint8_t len = 0;
+        if (valid)
+            len = rfm95_read_packet(rx_buffer, sizeof(rx_buffer));
+        else
+            crc_errors++;                                   // CRC inválido
+
+        // Janela de despertar: pacote lido, o rádio volta a dormir (o sleep
+        // apaga a FIFO)
+        if (rx_window) {
+            rfm95_close_window();
+            if (!tx_busy)
+                rfm95_set_mode(MODE_SLEEP);
+        }
+        if (valid && rx_cb)
+            rx_cb(rx_buffer, len);
+    }
+}
+
 // ============================================================================
 // Implementação das Funções Públicas
 // ============================================================================
@@ -108,12 +605,45 @@ bool lora_init() {
     gpio_init(PIN_CS);   gpio_set_dir(PIN_CS, GPIO_OUT);   gpio_put(PIN_CS, 1);
     gpio_init(PIN_RST);  gpio_set_dir(PIN_RST, GPIO_OUT);
 
+    /* --- DIO0 como entrada de interrupção (borda de subida) --- */
+    gpio_init(PIN_DIO0); gpio_set_dir(PIN_DIO0, GPIO_IN);
+    static bool dio0_handler_added = false;
+    if (!dio0_handler_added) {                  // lora_init pode ser chamado de novo
+        gpio_add_raw_irq_handler(PIN_DIO0, rfm95_dio0_irq);
+        dio0_handler_added = true;
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    /* --- Dois canais de DMA para as transferências da FIFO --- */
+    if (dma_tx < 0) {
+        dma_tx = dma_claim_unused_channel(true);
+        dma_rx = dma_claim_unused_channel(true);
+    }
+
+    lock_depth = 0;
+    op_mode = 0xFF;
+    crc_errors = 0;
+    rfm95_stop_wake();
+    if (lbt_alarm > 0)
+        cancel_alarm(lbt_alarm);
+    lbt_alarm = 0;
+    cad_state = CAD_NONE;
+
     /* --- Reset do módulo e verificação da versão --- */
     rmf95_reset();
+    memset(shadow_valid, 0, sizeof(shadow_valid));     // valores de fábrica
+    power_mode = MODE_STDBY;
+    power_since = time_us_64();
+    memset(mode_time_us, 0, sizeof(mode_time_us));
+    memset(&power_counts, 0, sizeof(power_counts));
+    charge_na_ms = 0;
     if (rmf95_read_reg(REG_VERSION) != 0x12) {     // 0x12 é a versão esperada
         return false;
     }
 
+    /* --- Semente das esperas do LBT: o RSSI de banda larga varia com o ruído --- */
+    rng_state = (uint32_t)time_us_64() ^ ((uint32_t)rmf95_read_reg(REG_RSSI_WIDEBAND) << 24) ^ 1;
+
     /* --- Entra em modo sleep para configurar com segurança --- */
     lora_sleep();
 
@@ -121,101 +651,331 @@ bool lora_init() {
     lora_set_frequency(LORA_FREQUENCY_HZ);
 
     /* --- Ponteiros base da FIFO (TX e RX no início) --- */
-    rmf95_write_reg(REG_FIFO_TX_BASE_ADDR, 0x00);
-    rmf95_write_reg(REG_FIFO_RX_BASE_ADDR, 0x00);
+    static const uint8_t fifo_base[] = { 0x00, 0x00 };
+    rfm95_write_cfg(REG_FIFO_TX_BASE_ADDR, fifo_base, 2);
 
     /* --- LNA: ativa ganho máximo para melhor sensibilidade --- */
-    rmf95_write_reg(REG_LNA, rmf95_read_reg(REG_LNA) | 0x03);
+    rfm95_write_cfg_reg(REG_LNA, rfm95_read_cfg(REG_LNA) | 0x03);
 
     /* --- Configuração do modem
-         BW 125 kHz, CR 4/5, CRC on, SF7 --- */
-    rmf95_write_reg(REG_MODEM_CONFIG_1, 0x72);
-    rmf95_write_reg(REG_MODEM_CONFIG_2, 0x74);
+         BW 125 kHz, CR 4/5, CRC on, SF7 (0x72, 0x74) --- */
+    static const uint8_t modem[] = { 0x72, 0x74 };
+    rfm95_write_cfg(REG_MODEM_CONFIG_1, modem, 2);
+    cfg_sf = 7;
+    cfg_bw_index = 7;
+    cfg_cr = 1;
+    rfm95_update_ldro();
 
     /* --- Preâmbulo de 8 símbolos --- */
-    rmf95_write_reg(REG_PREAMBLE_MSB, 0x00);
-    rmf95_write_reg(REG_PREAMBLE_LSB, 0x08);
+    lora_set_preamble_length(8);
 
     lora_set_sync_word(0xF3); 
 
     /* --- Volta para standby, pronto para TX/RX --- */
     lora_idle();
+    tx_busy = false;
+    gpio_set_irq_enabled(PIN_DIO0, GPIO_IRQ_EDGE_RISE, true);
     return true;
 }
 
 /* Converte frequência em Hz para os três registradores FRF */
 void lora_set_frequency(long frequency) {
-    uint64_t frf = ((uint64_t)frequency << 19) / RF_CRYSTAL_FREQ_HZ;
-    rmf95_write_reg(REG_FRF_MSB, (uint8_t)(frf >> 16));
-    rmf95_write_reg(REG_FRF_MID, (uint8_t)(frf >> 8));
-    rmf95_write_reg(REG_FRF_LSB, (uint8_t) frf);
+    rfm95_lock();
+    base_frf = rfm95_frf(frequency);
+    if (!channel_count)
+        rfm95_write_frf(base_frf);
+    rfm95_unlock();
 }
 
 /* Define a potência de transmissão (2 dBm–17 dBm) usando PA_BOOST */
 void lora_set_power(uint8_t power) {
     if (power > 17) power = 17;
     if (power < 2)  power = 2;
-    rmf95_write_reg(REG_PA_CONFIG, 0x80 | (power - 2));   // 0x80 → PA_BOOST
+    rfm95_lock();
+    rfm95_write_cfg_reg(REG_PA_CONFIG, 0x80 | (power - 2));  // 0x80 → PA_BOOST
+    cfg_power = power;
+    rfm95_unlock();
 }
 
 /* Define o byte de sincronização (0x12 padrão para redes privadas) */
 void lora_set_sync_word(uint8_t sw) {
-    rmf95_write_reg(REG_SYNC_WORD, sw);
+    rfm95_lock();
+    rfm95_write_cfg_reg(REG_SYNC_WORD, sw);
+    rfm95_unlock();
+}
+
+void lora_set_spreading_factor(uint8_t sf) {
+    if (sf < 7)  sf = 7;
+    if (sf > 12) sf = 12;
+    rfm95_lock();
+    cfg_sf = sf;
+    rfm95_write_cfg_reg(REG_MODEM_CONFIG_2, (rfm95_read_cfg(REG_MODEM_CONFIG_2) & 0x0F) | (sf << 4));
+    rfm95_update_ldro();
+    rfm95_unlock();
+}
+
+void lora_set_signal_bandwidth(long bw) {
+    uint8_t index = 0;
+    while (index < 9 && bandwidths[index] < bw)
+        index++;
+    rfm95_lock();
+    cfg_bw_index = index;
+    rfm95_write_cfg_reg(REG_MODEM_CONFIG_1, (rfm95_read_cfg(REG_MODEM_CONFIG_1) & 0x0F) | (index << 4));
+    rfm95_update_ldro();
+    rfm95_unlock();
+}
+
+void lora_set_coding_rate4(uint8_t denominator) {
+    if (denominator < 5) denominator = 5;
+    if (denominator > 8) denominator = 8;
+    rfm95_lock();
+    cfg_cr = denominator - 4;
+    rfm95_write_cfg_reg(REG_MODEM_CONFIG_1, (rfm95_read_cfg(REG_MODEM_CONFIG_1) & 0xF1) | (cfg_cr << 1));
+    rfm95_unlock();
+}
+
+void lora_set_preamble_length(uint16_t length) {
+    rfm95_lock();
+    cfg_preamble = length;
+    uint8_t regs[] = { (uint8_t)(length >> 8), (uint8_t)length };
+    rfm95_write_cfg(REG_PREAMBLE_MSB, regs, 2);
+    rfm95_unlock();
+}
+
+/* Header explícito e CRC ligado, como configurado em lora_init:
+     Tsym = 2^SF / BW
+     Tpreâmbulo = (Npreâmbulo + 4,25) * Tsym
+     Npayload = 8 + max(ceil((8*PL - 4*SF + 28 + 16) / (4*(SF - 2*DE))) * (CR + 4), 0) */
+uint32_t lora_time_on_air_us(uint8_t size) {
+    uint32_t bw = bandwidths[cfg_bw_index];
+    uint64_t symbol_ns = ((1ull << cfg_sf) * 1000000000ull) / bw;
+    int de = symbol_ns > 16000000ull ? 1 : 0;
+
+    int num = 8 * size - 4 * cfg_sf + 28 + 16;
+    int den = 4 * (cfg_sf - 2 * de);
+    int blocks = num > 0 ? (num + den - 1) / den : 0;
+    uint32_t payload_symbols = 8 + blocks * (cfg_cr + 4);
+
+    // Preâmbulo em quartos de símbolo: (N + 4,25) * 4 = 4N + 17
+    uint64_t quarter_symbols = 4ull * cfg_preamble + 17 + 4ull * payload_symbols;
+    return (uint32_t)((quarter_symbols * symbol_ns / 4 + 999) / 1000);
 }
 
+/* Sleep e standby também encerram a recepção assíncrona */
 void lora_sleep() {
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_SLEEP);
+    rfm95_lock();
+    rx_async = false;
+    rfm95_stop_wake();
+    rfm95_set_mode(MODE_SLEEP);
+    rfm95_unlock();
 }
 
 void lora_idle() {
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_STDBY);
+    rfm95_lock();
+    rx_async = false;
+    rfm95_stop_wake();
+    rfm95_set_mode(MODE_STDBY);
+    rfm95_unlock();
 }
 
-/* Envia um pacote: grava FIFO, aciona modo TX e espera IRQ_TX_DONE */
+/* Envia um pacote e dorme até a interrupção de TX_DONE. O tratador do DIO0
+   faz __sev ao fim de cada TX; se o evento chegar antes do __wfe, ele fica
+   registrado e o __wfe retorna na hora */
 void lora_send_packet(const uint8_t* buffer, uint8_t size) {
-    lora_idle();
+    while (!lora_send_packet_async(buffer, size)) {
+        __wfe();                                        // TX anterior em andamento
+    }
+    while (tx_busy) {
+        __wfe();                                        // espera TX terminar
+    }
+}
+
+/* Grava a FIFO e aciona TX (ou o CAD do LBT) sem esperar; o fim é
+   sinalizado pelo DIO0 */
+bool lora_send_packet_async(const uint8_t* buffer, uint8_t size) {
+    rfm95_lock();
+    if (tx_busy) {
+        rfm95_unlock();
+        return false;
+    }
+    rfm95_close_window();           // TX interrompe a janela de recepção
+    cad_state = CAD_NONE;           // e um CAD de despertar em andamento
+    rfm95_set_mode(MODE_STDBY);
     rmf95_write_reg(REG_FIFO_ADDR_PTR, 0);
-    rmf95_write_fifo(buffer, size);
-    rmf95_write_reg(REG_PAYLOAD_LENGTH, size);
+    rfm95_write_burst(REG_FIFO, buffer, size);
+    rfm95_write_cfg_reg(REG_PAYLOAD_LENGTH, size);
+    if (channel_count)
+        rfm95_set_channel(channel_select ? channel_select(buffer, size, channel_count) % channel_count
+                                         : rfm95_random() % channel_count);
+
+    tx_busy = true;
+    if (lbt_max_backoffs) {
+        lbt_backoffs = 0;
+        lbt_slot_us = lora_time_on_air_us(size);
+        rfm95_start_cad(CAD_LBT);
+    } else {
+        rfm95_start_tx();
+    }
+    rfm95_unlock();
+    return true;
+}
+
+bool lora_tx_busy() {
+    return tx_busy;
+}
+
+void lora_on_tx_done(lora_tx_done_callback callback) {
+    tx_done_cb = callback;
+}
+
+void lora_on_receive(lora_rx_callback callback) {
+    rx_cb = callback;
+}
 
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_TX);
+void lora_receive_async() {
+    rfm95_lock();
+    rfm95_stop_wake();
+    rx_async = true;
+    if (!tx_busy)                   // durante TX, o tratador volta a RX no fim
+        rfm95_start_rx();
+    rfm95_unlock();
+}
 
-    while (!(rmf95_read_reg(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK)) {
-        sleep_ms(1);                                    // espera TX terminar
+void lora_receive_duty_cycled(uint32_t period_ms) {
+    rfm95_lock();
+    rfm95_stop_wake();
+    rx_async = true;
+    wake_period_us = period_ms * 1000;
+    wake_cycle_us = wake_period_us;
+    if (!tx_busy)                   // em TX (ou à espera do LBT) a FIFO ainda é usada
+        rfm95_set_mode(MODE_SLEEP);
+    wake_alarm = add_alarm_in_us(wake_period_us, rfm95_wake_alarm, NULL, true);
+    rfm95_unlock();
+}
+
+void lora_receive_scan(uint32_t dwell_ms) {
+    lora_receive_duty_cycled(dwell_ms);
+    rfm95_lock();
+    wake_scan = channel_count > 1;
+    if (wake_scan)
+        wake_cycle_us = wake_period_us * channel_count;
+    rfm95_unlock();
+}
+
+/* Cobre o período inteiro, o CAD (2 símbolos) e a sincronização do
+   receptor depois dele (6 símbolos) */
+uint16_t lora_wake_preamble_length(uint32_t period_ms) {
+    uint64_t symbol_us = ((1ull << cfg_sf) * 1000000) / bandwidths[cfg_bw_index];
+    uint64_t symbols = ((uint64_t)period_ms * 1000 + symbol_us - 1) / symbol_us + 8;
+    return symbols > 0xFFFF ? 0xFFFF : (uint16_t)symbols;
+}
+
+void lora_set_invert_iq(bool tx, bool rx) {
+    rfm95_lock();
+    iq_tx_inverted = tx;
+    iq_rx_inverted = rx;
+    if (op_mode == MODE_RX_CONTINUOUS)
+        rfm95_set_iq(rx);           // vale já para a recepção em curso
+    rfm95_unlock();
+}
+
+void lora_set_channel_plan(const long* frequencies, uint8_t count, lora_channel_select select) {
+    if (count > LORA_MAX_CHANNELS) count = LORA_MAX_CHANNELS;
+    rfm95_lock();
+    channel_count = count > 1 ? count : 0;
+    channel_select = select;
+    for (uint8_t i = 0; i < channel_count; i++)
+        channel_frf[i] = rfm95_frf(frequencies[i]);
+    channel_current = 0;
+    if (!channel_count)
+        wake_scan = false;
+    if (!tx_busy) {
+        if (channel_count)
+            rfm95_set_channel(0);
+        else
+            rfm95_write_frf(base_frf);
     }
-    rmf95_write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);   // limpa flag
-    lora_idle();
+    rfm95_unlock();
+}
+
+uint8_t lora_channel() {
+    return channel_current;
+}
+
+void lora_set_listen_before_talk(uint8_t max_backoffs) {
+    rfm95_lock();
+    lbt_max_backoffs = max_backoffs > 8 ? 8 : max_backoffs;
+    rfm95_unlock();
 }
 
 /* Recebe pacote em modo contínuo; retorna tamanho ou 0 se nada recebido */
 int lora_receive_packet(uint8_t* buffer, int max_size) {
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_RX_CONTINUOUS);
+    rfm95_lock();
+    rfm95_set_mode(MODE_RX_CONTINUOUS);
 
     uint8_t irq = rmf95_read_reg(REG_IRQ_FLAGS);
     if (irq & IRQ_RX_DONE_MASK) {
-        rmf95_write_reg(REG_IRQ_FLAGS, IRQ_RX_DONE_MASK); // limpa flag
+        // limpa as flags (a de CRC fica presa se não for escrita junto)
+        rmf95_write_reg(REG_IRQ_FLAGS, IRQ_RX_DONE_MASK | IRQ_PAYLOAD_CRC_ERROR_MASK);
 
         if (irq & IRQ_PAYLOAD_CRC_ERROR_MASK) {
+            crc_errors++;
+            rfm95_unlock();
             return 0;                                     // CRC inválido
         }
 
-        uint8_t len = rmf95_read_reg(REG_RX_NB_BYTES);
-        if (len > max_size) len = max_size;
-
-        uint8_t fifo_addr = rmf95_read_reg(REG_FIFO_RX_CURRENT_ADDR);
-        rmf95_write_reg(REG_FIFO_ADDR_PTR, fifo_addr);
-        rmf95_read_fifo(buffer, len);
+        uint8_t len = rfm95_read_packet(buffer, max_size);
+        rfm95_unlock();
         return len;
     }
+    rfm95_unlock();
     return 0;   // nada recebido
 }
 
-/* RSSI absoluto: (-157 dBm para 915 MHz) + valor lido */
+uint32_t lora_crc_errors() {
+    return crc_errors;
+}
+
+/* RSSI absoluto: (-157 dBm para 915 MHz) + valor lido com o pacote */
 int lora_packet_rssi() {
-    return (rmf95_read_reg(REG_PKT_RSSI_VALUE) - 157);
+    return pkt_rssi_value - 157;
 }
 
 /* SNR em dB (valor fracionário; cada unidade = 0,25 dB) */
 float lora_packet_snr() {
-    return ((int8_t)rmf95_read_reg(REG_PKT_SNR_VALUE)) * 0.25f;
+    return (int8_t)pkt_snr_value * 0.25f;
+}
+
+void lora_read_registers(uint8_t reg, uint8_t* buffer, uint8_t length) {
+    rfm95_lock();
+    rfm95_read_burst(reg, buffer, length);
+    if (reg != REG_FIFO)
+        rfm95_shadow_store(reg, buffer, length);
+    rfm95_unlock();
+}
+
+void lora_write_registers(uint8_t reg, const uint8_t* data, uint8_t length) {
+    rfm95_lock();
+    rfm95_write_burst(reg, data, length);
+    if (reg != REG_FIFO) {
+        rfm95_shadow_store(reg, data, length);
+        if (reg <= REG_OP_MODE && reg + length > REG_OP_MODE) {
+            op_mode = 0xFF;         // modo escrito por fora de rfm95_set_mode
+            rfm95_power_account(data[REG_OP_MODE - reg]);
+        }
+    }
+    rfm95_unlock();
+}
+
+void lora_get_power_stats(lora_power_stats* stats) {
+    rfm95_lock();
+    rfm95_power_account(power_mode);
+    *stats = power_counts;
+    stats->sleep_us = mode_time_us[MODE_SLEEP];
+    stats->standby_us = mode_time_us[MODE_STDBY] + mode_time_us[2] + mode_time_us[4];
+    stats->tx_us = mode_time_us[MODE_TX];
+    stats->rx_us = mode_time_us[MODE_RX_CONTINUOUS] + mode_time_us[MODE_RX_SINGLE];
+    stats->cad_us = mode_time_us[MODE_CAD];
+    stats->charge_mah = charge_na_ms / 3.6e12f;
+    rfm95_unlock();
 }
\ No newline at end of file
@@ -14,13 +14,26 @@
 #define PIN_SCK  18
 #define PIN_MOSI 19
 #define PIN_RST  20
+#define PIN_DIO0 21   // DIO0 do RFM95: TxDone / RxDone (interrupção)
 
 // Frequência de operação (915 MHz para o Brasil)
 #define LORA_FREQUENCY_HZ 915E6
 
+// Canais de 125 kHz do plano de saltos: espaçados de 200 kHz a partir de
+// LORA_FREQUENCY_HZ
+#define LORA_MAX_CHANNELS       16
+#define LORA_CHANNEL_SPACING_HZ 200000
+
 
 // Funções Públicas da Biblioteca
 
+// Callbacks chamados pela interrupção do DIO0 (contexto de IRQ: ser breve)
+typedef void (*lora_tx_done_callback)(void);
+typedef void (*lora_rx_callback)(const uint8_t* buffer, uint8_t size);
+
+// Escolhe o canal (0..count-1) de um pacote a transmitir (lora_set_channel_plan)
+typedef uint8_t (*lora_channel_select)(const uint8_t* buffer, uint8_t size, uint8_t count);
+
 // Inicializa o hardware SPI e o módulo RFM95
 // Retorna true se a comunicação foi bem-sucedida, false caso contrário
 bool lora_init();
@@ -39,19 +52,127 @@ void lora_set_power(uint8_t power);
 
 void lora_set_sync_word(uint8_t sw);
 
-// Envia um pacote de dados
+// Spreading factor entre 7 e 12 (padrão 7)
+void lora_set_spreading_factor(uint8_t sf);
+
+// Largura de banda em Hz: 7800, 10400, 15600, 20800, 31250, 41700, 62500,
+// 125000 (padrão), 250000 ou 500000. Valores intermediários usam a próxima acima
+void lora_set_signal_bandwidth(long bw);
+
+// Taxa de codificação 4/denominador, denominador entre 5 (padrão) e 8
+void lora_set_coding_rate4(uint8_t denominator);
+
+// Comprimento do preâmbulo em símbolos (padrão 8)
+void lora_set_preamble_length(uint16_t length);
+
+// Tempo no ar, em microssegundos, de um pacote de size bytes com a
+// configuração atual do modem (fórmula da seção 4.1.1.7 do datasheet SX1276)
+uint32_t lora_time_on_air_us(uint8_t size);
+
+// Envia um pacote de dados e espera o fim da transmissão
 // buffer: ponteiro para os dados, size: número de bytes
+// Não chamar de dentro de um callback
 void lora_send_packet(const uint8_t* buffer, uint8_t size);
 
+// Inicia a transmissão e retorna sem esperar; o fim é sinalizado pelo DIO0
+// Retorna false se outra transmissão ainda estiver em andamento
+bool lora_send_packet_async(const uint8_t* buffer, uint8_t size);
+
+// true enquanto um pacote estiver sendo transmitido
+bool lora_tx_busy();
+
+// Define a função chamada ao fim de cada transmissão (NULL desativa)
+void lora_on_tx_done(lora_tx_done_callback callback);
+
+// Define a função chamada a cada pacote recebido com CRC válido (NULL desativa)
+// O buffer só é válido durante a chamada
+void lora_on_receive(lora_rx_callback callback);
+
+// Coloca o rádio em recepção contínua; os pacotes chegam pelo callback de
+// lora_on_receive. Após cada transmissão assíncrona o rádio volta a receber
+void lora_receive_async();
+
+// Recepção de baixo consumo: o rádio dorme e acorda a cada period_ms para
+// uma detecção de atividade (CAD, cerca de 2 símbolos). Só com preâmbulo no
+// ar ele fica em RX, até o pacote chegar pelo callback de lora_on_receive.
+// Quem transmite para este nó precisa de um preâmbulo que cubra o período
+// (lora_wake_preamble_length). Após cada transmissão o rádio volta a dormir
+void lora_receive_duty_cycled(uint32_t period_ms);
+
+// Preâmbulo, em símbolos da configuração atual, que um receptor em
+// lora_receive_duty_cycled(period_ms) sempre detecta
+uint16_t lora_wake_preamble_length(uint32_t period_ms);
+
+// Escuta antes de transmitir: cada envio começa por um CAD e, com o canal
+// ocupado, espera de 1 a 2^n vezes o tempo no ar do pacote (n = tentativa)
+// antes de escutar de novo. Depois de max_backoffs esperas (até 8) transmite
+// mesmo assim. 0 desativa (padrão). O CAD detecta bem o preâmbulo, mas pode
+// não perceber um pacote já no meio dos dados
+void lora_set_listen_before_talk(uint8_t max_backoffs);
+
+// Inverte I/Q nas transmissões e/ou nas recepções. Como no LoRaWAN, o
+// gateway transmite invertido e os nós recebem invertido: assim os nós não
+// ouvem (nem despertam com) os pacotes uns dos outros. O LBT sempre escuta
+// com I/Q normal, a polaridade dos uplinks. Padrão: nenhuma inversão
+void lora_set_invert_iq(bool tx, bool rx);
+
+// Plano de canais com salto por transmissão: cada envio (inclusive o CAD do
+// LBT) sai em um dos count canais, escolhido por select ou, se NULL,
+// sorteado. A recepção continua no canal da última transmissão, onde chega a
+// resposta. Com select determinístico (ex.: lora_frame_channel), quem conhece
+// o plano sabe o canal de cada pacote e responde nele. count < 2 desativa e
+// volta ao canal de lora_set_frequency. frequencies é copiado
+void lora_set_channel_plan(const long* frequencies, uint8_t count, lora_channel_select select);
+
+// Canal atual no plano (o da última transmissão ou do último pacote recebido)
+uint8_t lora_channel();
+
+// Gateway de rádio único em rede com saltos: como lora_receive_duty_cycled,
+// mas cada despertar faz o CAD no canal seguinte do plano, um a cada
+// dwell_ms. Os nós precisam de preâmbulo que cubra a volta inteira,
+// lora_wake_preamble_length(count * dwell_ms)
+void lora_receive_scan(uint32_t dwell_ms);
+
+// Tempo em cada modo do rádio e carga estimada pelas correntes típicas do
+// datasheet (TX conforme lora_set_power), desde lora_init
+typedef struct {
+    uint64_t sleep_us;
+    uint64_t standby_us;            // inclui as esperas do LBT
+    uint64_t tx_us;
+    uint64_t rx_us;
+    uint64_t cad_us;
+    float    charge_mah;
+    uint32_t cad_runs;              // CADs de LBT e de despertar
+    uint32_t cad_detections;        // CADs que encontraram atividade
+    uint32_t lbt_backoffs;          // esperas por canal ocupado
+    uint32_t lbt_forced;            // transmissões com o canal ainda ocupado
+    uint32_t rx_windows;            // despertares que ficaram em RX
+} lora_power_stats;
+
+void lora_get_power_stats(lora_power_stats* stats);
+
 // Tenta receber um pacote (modo não-bloqueante) - deve ser chamada em loop
+// Não usar junto com lora_receive_async
 // buffer: buffer de destino, max_size: tamanho máximo do buffer
 // Retorna: número de bytes recebidos ou 0 se nenhum pacote foi recebido
 int lora_receive_packet(uint8_t* buffer, int max_size);
 
+// Pacotes descartados por erro de CRC desde lora_init
+uint32_t lora_crc_errors();
+
 // Obtém o RSSI do último pacote recebido em dBm
 int lora_packet_rssi();
 
 // Obtém o SNR do último pacote recebido em dB
 float lora_packet_snr();
 
+// Acesso em rajada a registradores consecutivos do SX127x (o endereço avança
+// a cada byte; em REG_FIFO, 0x00, avança o ponteiro da FIFO), para recursos
+// que a biblioteca não cobre. Os registradores de configuração ficam em uma
+// cópia local: a biblioteca omite escritas que não mudam o valor e não relê
+// o que já conhece. Mudar SF, BW ou CR por aqui não atualiza o cálculo de
+// lora_time_on_air_us
+void lora_read_registers(uint8_t reg, uint8_t* buffer, uint8_t length);
+void lora_write_registers(uint8_t reg, const uint8_t* data, uint8_t length);
+
 #endif // RFM95_LORA_H
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "lora_adr.h"
+#include "rfm95_lora.h"
+#include "hardware/sync.h"
+
+// Taxas de dados permitidas, da mais robusta (índice 0) à mais rápida
+#define MAX_RATES 8
+
+static uint8_t rate_sf[MAX_RATES];
+static long    rate_bw[MAX_RATES];
+static int     rate_count = 0;
+
+static lora_adr_config cfg;
+static int      rate;               // taxa escolhida
+static uint8_t  power;              // potência escolhida (dBm)
+static bool     pending = false;    // escolha ainda não levada ao rádio
+static lora_adr_state state;
+
+static float    history[LORA_ADR_HISTORY];
+static uint8_t  history_count = 0;
+static float    last_margin;        // margem do último relatório (dB)
+static bool     have_margin = false;
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Acréscimo de ruído da banda em relação a 125 kHz (dB) */
+static float bw_offset(long bw) {
+    return bw >= 500000 ? 6.0f : bw >= 250000 ? 3.0f : 0.0f;
+}
+
+/* SNR mínimo de demodulação de uma taxa, referido a 125 kHz:
+   -7,5 dB em SF7 até -20 dB em SF12 (datasheet SX1276, tabela 13) */
+static float required_snr(int r) {
+    return -2.5f * (rate_sf[r] - 4) + bw_offset(rate_bw[r]);
+}
+
+static void set_choice(int r, uint8_t p) {
+    if (r != rate || p != power) {
+        rate = r;
+        power = p;
+        pending = true;
+    }
+    history_count = 0;              // medidas antigas não valem para a nova escolha
+}
+
+/* Margem de um SNR sobre o mínimo da taxa atual, já descontada a exigida */
+static float margin_of(float snr_db) {
+    return snr_db + bw_offset(rate_bw[rate]) - required_snr(rate) - cfg.margin_db;
+}
+
+/* Decide com a média dos relatórios guardados */
+static void decide() {
+    float mean = 0;
+    for (int i = 0; i < history_count; i++)
+        mean += history[i];
+    mean /= history_count;
+
+    float margin = margin_of(mean);
+    int r = rate;
+    int p = power;
+
+    if (margin < 0) {
+        // Enlace fraco: primeiro potência, depois taxa mais robusta
+        while (margin < 0 && p < cfg.max_power) {
+            int step = p + 3 <= cfg.max_power ? 3 : cfg.max_power - p;
+            p += step;
+            margin += step;
+        }
+        while (margin < 0 && r > 0) {
+            margin += required_snr(r) - required_snr(r - 1);
+            r--;
+        }
+    } else if (margin >= cfg.hysteresis_db) {
+        // Margem sobrando: primeiro taxa mais rápida, depois menos potência
+        while (r < rate_count - 1 && margin - (required_snr(r + 1) - required_snr(r)) >= cfg.hysteresis_db) {
+            margin -= required_snr(r + 1) - required_snr(r);
+            r++;
+        }
+        while (p > cfg.min_power && margin - 3 >= cfg.hysteresis_db) {
+            int step = p - 3 >= cfg.min_power ? 3 : p - cfg.min_power;
+            p -= step;
+            margin -= step;
+        }
+    }
+    set_choice(r, (uint8_t)p);
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_adr_default_config(lora_adr_config* config) {
+    config->min_sf = 7;
+    config->max_sf = 12;
+    config->max_bw = 125000;
+    config->min_power = 2;
+    config->max_power = 17;
+    config->margin_db = 2.0f;
+    config->hysteresis_db = 1.5f;
+    config->history = 8;
+    config->ack_limit = 8;
+}
+
+void lora_adr_init(const lora_adr_config* config, uint8_t sf, long bw, uint8_t tx_power) {
+    uint32_t irq = save_and_disable_interrupts();
+    cfg = *config;
+    if (cfg.history == 0 || cfg.history > LORA_ADR_HISTORY)
+        cfg.history = LORA_ADR_HISTORY;
+    if (cfg.ack_limit < 2)
+        cfg.ack_limit = 2;
+
+    rate_count = 0;
+    for (int s = cfg.max_sf; s >= cfg.min_sf; s--) {
+        rate_sf[rate_count] = s;
+        rate_bw[rate_count++] = 125000;
+    }
+    for (long b = 250000; b <= cfg.max_bw && b <= 500000; b *= 2) {
+        rate_sf[rate_count] = cfg.min_sf;
+        rate_bw[rate_count++] = b;
+    }
+
+    // Parte da taxa mais próxima da atual
+    rate = 0;
+    for (int r = 0; r < rate_count; r++) {
+        if (rate_sf[r] >= sf && rate_bw[r] <= bw)
+            rate = r;
+    }
+    power = tx_power < cfg.min_power ? cfg.min_power : tx_power > cfg.max_power ? cfg.max_power : tx_power;
+    history_count = 0;
+    have_margin = false;
+    state.changes = 0;
+    state.missed = 0;
+    state.last_snr = 0;
+    pending = true;
+    restore_interrupts(irq);
+
+    lora_adr_apply();
+    state.changes = 0;
+}
+
+void lora_adr_uplink() {
+    uint32_t irq = save_and_disable_interrupts();
+    state.missed++;
+    // Sem resposta do gateway: potência máxima e, a cada ack_limit / 2
+    // uplinks a mais, uma taxa mais robusta. Se o último relatório ainda
+    // tinha margem, os que faltam são colisões e não alcance (uma taxa mais
+    // lenta só aumentaria o tempo no ar): aí só um silêncio 4x mais longo
+    // conta como enlace perdido
+    uint16_t limit = cfg.ack_limit;
+    if (have_margin && last_margin >= 0)
+        limit *= 4;
+    if (state.missed >= limit && (state.missed - limit) % (cfg.ack_limit / 2) == 0) {
+        if (power < cfg.max_power)
+            set_choice(rate, cfg.max_power);
+        else if (rate > 0)
+            set_choice(rate - 1, power);
+    }
+    restore_interrupts(irq);
+}
+
+void lora_adr_report(float snr_db) {
+    uint32_t irq = save_and_disable_interrupts();
+    state.missed = 0;
+    state.last_snr = snr_db;
+    last_margin = margin_of(snr_db);
+    have_margin = true;
+    history[history_count++] = snr_db;
+    if (history_count >= cfg.history)
+        decide();
+    restore_interrupts(irq);
+}
+
+bool lora_adr_apply() {
+    uint32_t irq = save_and_disable_interrupts();
+    if (!pending || lora_tx_busy()) {
+        restore_interrupts(irq);
+        return false;
+    }
+    lora_set_spreading_factor(rate_sf[rate]);
+    lora_set_signal_bandwidth(rate_bw[rate]);
+    lora_set_power(power);
+    pending = false;
+    state.changes++;
+    restore_interrupts(irq);
+    return true;
+}
+
+void lora_adr_get_state(lora_adr_state* out) {
+    uint32_t irq = save_and_disable_interrupts();
+    *out = state;
+    out->sf = rate_sf[rate];
+    out->bw = rate_bw[rate];
+    out->power = power;
+    restore_interrupts(irq);
+}
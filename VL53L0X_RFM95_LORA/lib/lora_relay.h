@@ -0,0 +1,88 @@
+#ifndef LORA_RELAY_H
+#define LORA_RELAY_H
+
+#include "pico/stdlib.h"
+#include <stdbool.h>
+#include "lora_telemetry.h"
+
+// Encaminhamento em vários saltos (store-and-forward) para nós fora do
+// alcance do gateway. Os pacotes levam LORA_FLAG_ROUTED e o cabeçalho de
+// roteamento de lora_telemetry.h; origem e sequência são o id do nó e a seq
+// do próprio pacote. Uplinks vão ao gateway (LORA_ROUTE_GATEWAY); pacotes de
+// controle descem ao nó "id do nó".
+//
+// Todo nó da rede (sensor, relé e gateway) passa os pacotes recebidos por
+// lora_relay_receive, que aprende as rotas pelo tráfego:
+//   - vizinhos: RSSI médio de cada transmissor e a distância (saltos até o
+//     gateway) que ele anuncia. O próximo salto de um uplink é o vizinho mais
+//     próximo do gateway entre os de enlace bom (RSSI >= min_rssi) e, entre
+//     esses, o de melhor RSSI;
+//   - rotas de volta: para cada origem, o vizinho pelo qual a cópia de
+//     melhor enlace chegou. Os pacotes de controle descem por ela.
+// Sem rota, o pacote sai para LORA_ROUTE_ANY e qualquer relé o encaminha.
+//
+// Um relé copia para lora_queue os pacotes endereçados a ele, com prioridade
+// alta para alertas e controle (ACKs) e normal para telemetria; a fila é
+// limitada (LORA_QUEUE_LEN) e, cheia, descarta antes a telemetria. Cópias
+// repetidas de um mesmo (origem, seq) dentro de dup_ms são descartadas; uma
+// retransmissão de lora_reliable, que reusa a seq, chega depois disso e é
+// encaminhada de novo. O limite de saltos encerra qualquer laço.
+//
+// Todos os nós precisam receber e transmitir com I/Q normal
+// (lora_set_invert_iq(false, false)): o relé ouve os dois sentidos.
+
+#ifndef LORA_RELAY_NEIGHBORS
+#define LORA_RELAY_NEIGHBORS 16     // vizinhos acompanhados
+#endif
+
+#ifndef LORA_RELAY_ROUTES
+#define LORA_RELAY_ROUTES 32        // rotas de volta (origens)
+#endif
+
+#ifndef LORA_RELAY_SEEN
+#define LORA_RELAY_SEEN 32          // pacotes recentes no cache de duplicatas
+#endif
+
+typedef struct {
+    uint8_t  id;                    // id deste nó (LORA_ROUTE_GATEWAY no gateway)
+    bool     forward;               // papel de relé: encaminha pacotes de outros
+    uint8_t  hop_limit;             // saltos permitidos aos pacotes originados aqui
+    int16_t  min_rssi;              // RSSI mínimo de um enlace bom (dBm)
+    uint32_t dup_ms;                // tempo em que uma cópia conta como duplicata
+    uint32_t expire_ms;             // vizinhos e rotas sem notícias são esquecidos
+} lora_relay_config;
+
+typedef struct {
+    uint32_t received;              // pacotes roteados recebidos
+    uint32_t delivered;             // destinados a este nó
+    uint32_t forwarded;             // colocados na fila para o próximo salto
+    uint32_t forwarded_bytes;
+    uint32_t forwarded_alerts;
+    uint32_t duplicates;            // cópias descartadas pelo cache
+    uint32_t hop_limit;             // descartados pelo limite de saltos
+    uint32_t queue_full;            // recusados pela fila
+    uint8_t  distance;              // saltos até o gateway (LORA_ROUTE_UNKNOWN)
+    uint8_t  next_hop;              // próximo salto dos uplinks agora
+    uint8_t  neighbors;             // vizinhos conhecidos
+    uint8_t  routes;                // rotas de volta conhecidas
+} lora_relay_stats;
+
+// Configuração padrão para o nó id: sem encaminhar, 3 saltos, enlace bom a
+// partir de -115 dBm, duplicatas por 2 s, rotas esquecidas após 10 min
+void lora_relay_default_config(lora_relay_config* config, uint8_t id);
+
+void lora_relay_init(const lora_relay_config* config);
+
+// Processa um pacote recebido (rssi em dBm): aprende rotas, descarta
+// duplicatas e, num relé, encaminha. Retorna true se o pacote deve ser tratado
+// por este nó (uplink no gateway, controle para este nó ou pacote sem
+// roteamento). Pode ser chamada do callback de recepção
+bool lora_relay_receive(const uint8_t* buf, uint8_t size, int16_t rssi);
+
+// Preenche o roteamento de um pacote originado aqui (LORA_FLAG_ROUTED)
+// antes de enviá-lo: transmissor, distância, limite de saltos e próximo salto
+void lora_relay_prepare(uint8_t* buf, uint8_t size);
+
+void lora_relay_get_stats(lora_relay_stats* stats);
+
+#endif // LORA_RELAY_H
@@ -0,0 +1,560 @@
+#include "lora_telemetry.h"
+#include <string.h>
+
+static const struct {
+    const char* name;
+    const char* unit;
+    int scale;
+} sensors[LORA_SENSOR_COUNT] = {
+    [LORA_SENSOR_DISTANCE]    = { "distancia",   "cm", 10 },
+    [LORA_SENSOR_TEMPERATURE] = { "temperatura", "C",  100 },
+    [LORA_SENSOR_HUMIDITY]    = { "umidade",     "%",  10 },
+    [LORA_SENSOR_VOLTAGE]     = { "tensao",      "V",  1000 },
+    [LORA_SENSOR_CURRENT]     = { "corrente",    "mA", 10 },
+    [LORA_SENSOR_LIGHT]       = { "luz",         "lx", 1 },
+    [LORA_SENSOR_SNR]         = { "snr",         "dB", 4 },
+    [LORA_SENSOR_RSSI]        = { "rssi",        "dBm", 1 },
+    [LORA_SENSOR_ACK]         = { "ack",         "",   1 },
+};
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Grava v em varint zig-zag; retorna false se não couber */
+static bool put_varint(lora_frame* f, int32_t v) {
+    uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    uint8_t tmp[5];
+    uint8_t n = 0;
+    do {
+        tmp[n] = z & 0x7F;
+        z >>= 7;
+        if (z)
+            tmp[n] |= 0x80;
+        n++;
+    } while (z);
+
+    if (f->size + n > f->cap)
+        return false;
+    memcpy(f->buf + f->size, tmp, n);
+    f->size += n;
+    return true;
+}
+
+/* Lê um varint zig-zag; retorna false se o pacote terminar antes */
+static bool get_varint(const uint8_t* buf, uint8_t size, uint8_t* pos, int32_t* v) {
+    uint32_t z = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*pos >= size)
+            return false;
+        uint8_t b = buf[(*pos)++];
+        z |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Bits de um varint zig-zag em grupos de g bits, cada um seguido do bit de
+   continuação */
+static uint8_t group_varint_bits(uint32_t z, uint8_t g) {
+    uint8_t n = 0;
+    do {
+        n += g + 1;
+        z >>= g;
+    } while (z);
+    return n;
+}
+
+/* Acrescenta n bits (do menos significativo) ao bloco preditivo aberto; o
+   espaço já foi conferido */
+static void put_bits(lora_frame* f, uint32_t v, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) {
+        if (f->bit == 0)
+            f->buf[f->size++] = 0;
+        f->buf[f->size - 1] |= ((v >> i) & 1) << f->bit;
+        f->bit = (f->bit + 1) & 7;
+    }
+}
+
+/* Grava z em varint de grupos de g bits */
+static void put_group_varint(lora_frame* f, uint32_t z, uint8_t g) {
+    do {
+        put_bits(f, z, g);
+        z >>= g;
+        put_bits(f, z != 0, 1);
+    } while (z);
+}
+
+// Leitura dos bits de um bloco preditivo
+typedef struct {
+    const uint8_t* buf;
+    uint8_t size;
+    uint8_t pos;                    // próximo byte
+    uint8_t bit;                    // bits já lidos de buf[pos - 1] (0 = nenhum byte aberto)
+} bit_reader;
+
+static bool get_bits(bit_reader* r, uint8_t n, uint32_t* v) {
+    *v = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (r->bit == 0) {
+            if (r->pos >= r->size)
+                return false;
+            r->pos++;
+        }
+        *v |= (uint32_t)((r->buf[r->pos - 1] >> r->bit) & 1) << i;
+        r->bit = (r->bit + 1) & 7;
+    }
+    return true;
+}
+
+static bool get_group_varint(bit_reader* r, uint8_t g, int32_t* v) {
+    uint32_t z = 0, part, more;
+    for (uint8_t shift = 0; shift < 32 + g; shift += g) {
+        if (!get_bits(r, g, &part) || !get_bits(r, 1, &more))
+            return false;
+        if (shift < 32)
+            z |= part << shift;
+        if (!more) {
+            *v = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Predição polinomial de ordem k sobre as leituras anteriores (prev[0] a
+   mais recente); aritmética módulo 2^32, desfeita exatamente na decodificação */
+static uint32_t predict(const int32_t* prev, uint8_t k) {
+    uint32_t a = (uint32_t)prev[0], b = (uint32_t)prev[1], c = (uint32_t)prev[2];
+    switch (k) {
+    case 0:  return 0;
+    case 1:  return a;
+    case 2:  return 2 * a - b;
+    default: return 3 * a - 3 * b + c;
+    }
+}
+
+static void push_history(int32_t* prev, uint8_t* history, int32_t value) {
+    prev[2] = prev[1];
+    prev[1] = prev[0];
+    prev[0] = value;
+    if (*history < 3)
+        (*history)++;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/* Ordem e grupo do varint de menor custo médio nas leituras recentes */
+static void best_coding(const lora_series* s, uint8_t* order, uint8_t* group) {
+    uint8_t first = s->order == LORA_SERIES_AUTO ? 0 : (s->order > 3 ? 3 : s->order);
+    uint8_t last = s->order == LORA_SERIES_AUTO ? 3 : first;
+    *order = first;
+    *group = 8;
+    for (uint8_t k = first; k <= last; k++) {
+        for (uint8_t g = 1; g <= 8; g++) {
+            if (s->cost[k][g - 1] < s->cost[*order][*group - 1]) {
+                *order = k;
+                *group = g;
+            }
+        }
+    }
+}
+
+/* Média móvel (x8) dos bits que a leitura q ocuparia em cada ordem e grupo,
+   para escolher os do próximo bloco; só com as quatro ordens disponíveis,
+   para compará-las nas mesmas leituras */
+static void update_cost(lora_series* s, int32_t q) {
+    if (s->history < 3)
+        return;
+    for (uint8_t k = 0; k < 4; k++) {
+        uint32_t z = zigzag((int32_t)((uint32_t)q - predict(s->prev, k)));
+        for (uint8_t g = 1; g <= 8; g++) {
+            uint16_t* c = &s->cost[k][g - 1];
+            *c += group_varint_bits(z, g) - (*c >> 3);
+        }
+    }
+}
+
+static lora_series_track* find_track(lora_series_rx* rx, uint8_t type) {
+    lora_series_track* slot = NULL;
+    for (int i = 0; i < LORA_SERIES_MAX; i++) {
+        lora_series_track* t = &rx->series[i];
+        if (t->type == type)
+            return t;
+        if (!slot && (!t->type || !t->synced))
+            slot = t;
+    }
+    // Sem espaço: a última série acompanhada dá lugar à nova
+    if (!slot)
+        slot = &rx->series[LORA_SERIES_MAX - 1];
+    *slot = (lora_series_track){ type, false, false, 0, 0, 1, { 0, 0, 0 } };
+    return slot;
+}
+
+/* Decodifica um bloco preditivo a partir de *pos (já depois do tipo) */
+static int decode_series_block(const uint8_t* buf, uint8_t size, uint8_t* pos, uint8_t tag,
+                               lora_series_rx* rx, lora_reading_callback callback,
+                               lora_gap_callback gap, void* ctx) {
+    if (*pos + 2 > size)
+        return -1;
+    lora_sensor type = (lora_sensor)(tag & LORA_BLOCK_TYPE);
+    bool key = tag & LORA_BLOCK_KEY;
+    uint8_t order = (tag & LORA_BLOCK_ORDER) >> 4;
+    uint8_t count = buf[*pos];
+    uint8_t index = buf[*pos + 1];
+    *pos += 2;
+
+    lora_series_track* t = rx ? find_track(rx, type) : NULL;
+    // Bloco de antes do último decodificado: chegou atrasado
+    bool late = t && t->started && (int8_t)(index - t->next) < 0;
+    bool decodable = key;
+    uint16_t missing = 0;
+    int32_t prev[3] = { 0, 0, 0 };
+    uint8_t history = 0;
+    if (t && !late) {
+        if (t->started)
+            missing = (uint8_t)(index - t->next);
+        if (!key && t->synced && !missing) {
+            decodable = true;
+            memcpy(prev, t->prev, sizeof(prev));
+            history = t->history;
+        } else if (!key) {
+            missing += count;
+        }
+    }
+    if (missing) {
+        rx->gaps += missing;
+        if (gap)
+            gap(type, missing > 255 ? 255 : (uint8_t)missing, ctx);
+    }
+
+    bit_reader reader = { buf, size, *pos, 0 };
+    uint32_t group;
+    int32_t step = decodable && !key ? t->step : 1;
+    if (!get_bits(&reader, 3, &group))
+        return -1;
+    if (key) {
+        int32_t v;
+        if (!get_group_varint(&reader, 3, &v) || v < 0)
+            return -1;
+        step = v + 1;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t r;
+        if (!get_group_varint(&reader, (uint8_t)group + 1, &r))
+            return -1;
+        if (!decodable)
+            continue;
+        int32_t q = (int32_t)(predict(prev, order < history ? order : history) + (uint32_t)r);
+        push_history(prev, &history, q);
+        if (callback)
+            callback(type, i, (int32_t)((uint32_t)q * (uint32_t)step), ctx);
+    }
+    *pos = reader.pos;
+
+    if (t && !late) {
+        t->next = index + count;
+        t->started = true;
+        t->synced = decodable;
+        t->step = step;
+        memcpy(t->prev, prev, sizeof(prev));
+        t->history = history;
+    }
+    return count;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_frame_begin(lora_frame* f, uint8_t* buf, uint8_t cap,
+                      uint8_t node, uint16_t seq, uint8_t flags) {
+    f->buf = buf;
+    f->cap = cap;
+    f->block = 0;
+    f->last = 0;
+    f->readings = 0;
+    f->series = NULL;
+    f->bit = 0;
+    f->size = 0;
+    if (cap < LORA_FRAME_HEADER)
+        return;
+    buf[0] = LORA_FRAME_MAGIC;
+    buf[1] = flags;
+    buf[2] = node;
+    buf[3] = (uint8_t)seq;
+    buf[4] = (uint8_t)(seq >> 8);
+    f->size = LORA_FRAME_HEADER;
+
+    if (flags & LORA_FLAG_ROUTED) {
+        if (cap < LORA_FRAME_HEADER + LORA_ROUTE_SIZE) {
+            f->size = 0;
+            return;
+        }
+        lora_route route = { 0, 15, node, LORA_ROUTE_UNKNOWN, LORA_ROUTE_ANY };
+        f->size += LORA_ROUTE_SIZE;
+        lora_route_set(buf, f->size, &route);
+    }
+}
+
+bool lora_frame_add(lora_frame* f, lora_sensor type, int32_t value) {
+    if (f->size < LORA_FRAME_HEADER)
+        return false;
+
+    uint8_t size = f->size;
+    // Continua o bloco aberto com a diferença para a leitura anterior
+    if (f->block && f->buf[f->block] == type && f->buf[f->block + 1] < 255) {
+        // Em uint32_t: o bitmap do ACK vai como int32_t e a diferença pode
+        // passar do limite (o decodificador soma do mesmo jeito)
+        if (!put_varint(f, (int32_t)((uint32_t)value - (uint32_t)f->last)))
+            return false;
+        f->buf[f->block + 1]++;
+    } else {
+        if (size + 2 > f->cap)
+            return false;
+        f->buf[size] = type;
+        f->buf[size + 1] = 1;
+        f->size += 2;
+        if (!put_varint(f, value)) {
+            f->size = size;
+            return false;
+        }
+        f->block = size;
+        f->series = NULL;
+    }
+    f->last = value;
+    f->readings++;
+    return true;
+}
+
+void lora_series_init(lora_series* s, lora_sensor type, uint8_t keyframe_every) {
+    memset(s, 0, sizeof(*s));
+    s->type = (uint8_t)type;
+    s->order = LORA_SERIES_AUTO;
+    s->keyframe_every = keyframe_every;
+    s->step = 1;
+    // Sem histórico: diferenças em grupos de 8 bits, como o bloco simples
+    for (uint8_t k = 0; k < 4; k++) {
+        for (uint8_t g = 0; g < 8; g++)
+            s->cost[k][g] = k == 1 && g == 7 ? 0 : 1;
+    }
+}
+
+void lora_series_keyframe(lora_series* s) {
+    s->history = 0;
+}
+
+bool lora_frame_add_series(lora_frame* f, lora_series* s, int32_t value) {
+    if (f->size < LORA_FRAME_HEADER)
+        return false;
+
+    lora_series saved = *s;
+    // Leitura fora do passo declarado: a série segue com passo 1
+    if (s->step > 1 && value % s->step) {
+        s->step = 1;
+        s->history = 0;
+    }
+    if (s->step < 1)
+        s->step = 1;
+    int32_t q = value / s->step;
+
+    bool open = !f->block || f->series != s || f->buf[f->block + 1] == 255 || s->history == 0;
+    if (open) {
+        bool key = s->history == 0 || (s->keyframe_every && s->blocks >= s->keyframe_every);
+        if (key) {
+            s->history = 0;
+            s->blocks = 0;
+        }
+        s->blocks++;
+        best_coding(s, &s->block_order, &s->block_group);
+    }
+
+    uint8_t k = s->block_order < s->history ? s->block_order : s->history;
+    uint32_t z = zigzag((int32_t)((uint32_t)q - predict(s->prev, k)));
+    // Bits que faltam: cabeçalho do bloco (3 bytes, o grupo e, no
+    // quadro-chave, o passo) e o resíduo
+    uint16_t bits = group_varint_bits(z, s->block_group);
+    if (open)
+        bits += 3 + (s->history ? 0 : group_varint_bits(zigzag(s->step - 1), 3));
+    uint16_t free_bits = open ? 0 : (8 - f->bit) & 7;
+    uint16_t bytes = (open ? 3 : 0) + (bits > free_bits ? (bits - free_bits + 7) / 8 : 0);
+    if (f->size + bytes > f->cap) {
+        *s = saved;
+        return false;
+    }
+
+    if (open) {
+        uint8_t size = f->size;
+        bool key = s->history == 0;
+        f->buf[size] = (uint8_t)(s->type | LORA_BLOCK_SERIES | (key ? LORA_BLOCK_KEY : 0) |
+                                 s->block_order << 4);
+        f->buf[size + 1] = 0;
+        f->buf[size + 2] = s->index;
+        f->size += 3;
+        f->bit = 0;
+        f->block = size;
+        f->series = s;
+        put_bits(f, s->block_group - 1, 3);
+        if (key)
+            put_group_varint(f, zigzag(s->step - 1), 3);
+    }
+    put_group_varint(f, z, s->block_group);
+    f->buf[f->block + 1]++;
+    update_cost(s, q);
+    push_history(s->prev, &s->history, q);
+    s->index++;
+    f->last = value;
+    f->readings++;
+    return true;
+}
+
+uint8_t lora_frame_size(const lora_frame* f) {
+    return f->size;
+}
+
+int lora_frame_decode(const uint8_t* buf, uint8_t size, lora_frame_header* header,
+                      lora_reading_callback callback, void* ctx) {
+    return lora_frame_decode_series(buf, size, header, NULL, callback, NULL, ctx);
+}
+
+int lora_frame_decode_series(const uint8_t* buf, uint8_t size, lora_frame_header* header,
+                             lora_series_rx* rx, lora_reading_callback callback,
+                             lora_gap_callback gap, void* ctx) {
+    if (size < LORA_FRAME_HEADER || buf[0] != LORA_FRAME_MAGIC)
+        return -1;
+    header->flags = buf[1];
+    header->node = buf[2];
+    header->seq = buf[3] | (buf[4] << 8);
+    if (!lora_route_get(buf, size, &header->route)) {
+        if (header->flags & LORA_FLAG_ROUTED)
+            return -1;
+        header->route = (lora_route){ 0, 0, header->node, LORA_ROUTE_UNKNOWN, LORA_ROUTE_ANY };
+    }
+
+    uint8_t pos = LORA_FRAME_HEADER + (header->flags & LORA_FLAG_ROUTED ? LORA_ROUTE_SIZE : 0);
+    int readings = 0;
+    while (pos < size) {
+        if (buf[pos] & LORA_BLOCK_SERIES) {
+            pos++;
+            int n = decode_series_block(buf, size, &pos, buf[pos - 1], rx, callback, gap, ctx);
+            if (n < 0)
+                return -1;
+            readings += n;
+            continue;
+        }
+        if (pos + 2 > size)
+            return -1;
+        lora_sensor type = (lora_sensor)buf[pos];
+        uint8_t count = buf[pos + 1];
+        pos += 2;
+
+        int32_t value = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            int32_t v;
+            if (!get_varint(buf, size, &pos, &v))
+                return -1;
+            value = i == 0 ? v : (int32_t)((uint32_t)value + (uint32_t)v);
+            if (callback)
+                callback(type, i, value, ctx);
+            readings++;
+        }
+    }
+    return readings;
+}
+
+bool lora_route_get(const uint8_t* buf, uint8_t size, lora_route* route) {
+    if (size < LORA_FRAME_HEADER + LORA_ROUTE_SIZE || buf[0] != LORA_FRAME_MAGIC ||
+        !(buf[1] & LORA_FLAG_ROUTED))
+        return false;
+    const uint8_t* r = buf + LORA_FRAME_HEADER;
+    route->hops = r[0] & 0x0F;
+    route->limit = r[0] >> 4;
+    route->sender = r[1];
+    route->distance = r[2];
+    route->next = r[3];
+    return true;
+}
+
+bool lora_route_set(uint8_t* buf, uint8_t size, const lora_route* route) {
+    if (size < LORA_FRAME_HEADER + LORA_ROUTE_SIZE || buf[0] != LORA_FRAME_MAGIC ||
+        !(buf[1] & LORA_FLAG_ROUTED))
+        return false;
+    uint8_t* r = buf + LORA_FRAME_HEADER;
+    r[0] = (uint8_t)((route->hops > 15 ? 15 : route->hops) | (route->limit > 15 ? 15 : route->limit) << 4);
+    r[1] = route->sender;
+    r[2] = route->distance;
+    r[3] = route->next;
+    return true;
+}
+
+uint8_t lora_frame_channel(const uint8_t* buf, uint8_t size, uint8_t count) {
+    if (count < 2)
+        return 0;
+    uint32_t h;
+    if (size >= LORA_FRAME_HEADER && buf[0] == LORA_FRAME_MAGIC) {
+        h = (uint32_t)buf[2] << 16 | buf[3] | buf[4] << 8;
+    } else {
+        h = size;
+        for (uint8_t i = 0; i < size; i++)
+            h = h * 31 + buf[i];
+    }
+    // Mistura dos bits (finalizador do MurmurHash3): seqs seguidas espalham
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    return (uint8_t)(h % count);
+}
+
+bool lora_ack_track(lora_ack_window* w, uint16_t seq) {
+    if (!w->valid) {
+        w->valid = true;
+        w->last = seq;
+        w->bitmap = 0;
+        return true;
+    }
+
+    uint16_t ahead = (uint16_t)(seq - w->last);
+    if (ahead == 0)
+        return false;
+    if (ahead < 0x8000) {
+        // Sequência nova: desloca a janela
+        w->bitmap = ahead > 32 ? 0 : ((w->bitmap << 1) | 1) << (ahead - 1);
+        w->last = seq;
+        return true;
+    }
+
+    uint16_t behind = (uint16_t)(w->last - seq);
+    if (behind > 32)
+        return true;                // fora da janela: não há como saber
+    uint32_t bit = 1u << (behind - 1);
+    if (w->bitmap & bit)
+        return false;
+    w->bitmap |= bit;
+    return true;
+}
+
+bool lora_ack_covers(uint16_t last, uint32_t bitmap, uint16_t seq) {
+    uint16_t behind = (uint16_t)(last - seq);
+    if (behind == 0)
+        return true;
+    return behind <= 32 && (bitmap & (1u << (behind - 1)));
+}
+
+const char* lora_sensor_name(lora_sensor type) {
+    return type > 0 && type < LORA_SENSOR_COUNT ? sensors[type].name : "?";
+}
+
+const char* lora_sensor_unit(lora_sensor type) {
+    return type > 0 && type < LORA_SENSOR_COUNT ? sensors[type].unit : "";
+}
+
+int lora_sensor_scale(lora_sensor type) {
+    return type > 0 && type < LORA_SENSOR_COUNT ? sensors[type].scale : 1;
+}
@@ -0,0 +1,223 @@
+#ifndef LORA_TELEMETRY_H
+#define LORA_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Formato binário de telemetria para os pacotes LoRa.
+//
+// Cabeçalho (5 bytes):
+//   [0]    LORA_FRAME_MAGIC (versão do formato; nunca é ASCII)
+//   [1]    flags (LORA_FLAG_*)
+//   [2]    id do nó
+//   [3..4] número de sequência (little-endian)
+// Com LORA_FLAG_ROUTED, seguem 4 bytes de roteamento (lora_relay.h):
+//   [5]    bits 0-3 saltos já dados, bits 4-7 limite de saltos
+//   [6]    nó que transmitiu este salto
+//   [7]    saltos desse nó até o gateway (LORA_ROUTE_UNKNOWN se não souber)
+//   [8]    próximo salto, quem deve encaminhar (LORA_ROUTE_ANY = qualquer relé)
+// Seguido de blocos, um por sequência de leituras do mesmo sensor:
+//   [tipo][quantidade N][valor inicial][N-1 diferenças]
+// Valores são inteiros em ponto fixo (escala por tipo, ver lora_sensor_scale)
+// gravados em varint zig-zag: diferenças pequenas ocupam 1 byte.
+//
+// Blocos preditivos (lora_series), de uma série que continua entre pacotes:
+//   [tipo | LORA_BLOCK_SERIES | LORA_BLOCK_KEY? | ordem << 4][N][índice][bits]
+// O índice é a posição (mod 256) da primeira leitura na série. Cada leitura
+// sai como o resíduo da predição polinomial da ordem indicada (0 = valor,
+// 1 = diferença, 2 = diferença da diferença, 3 = terceira diferença) sobre
+// as leituras anteriores da série, inclusive as de pacotes anteriores. Os
+// bits, do menos significativo de cada byte, trazem o tamanho g do grupo
+// (3 bits, g - 1), no quadro-chave o passo da série menos 1 (varint de grupos
+// de 3 bits, zig-zag) e os N resíduos em varint zig-zag de grupos de g bits, cada
+// grupo seguido do bit de continuação; o bloco termina no byte. Valores e
+// predições são em múltiplos do passo (a resolução do sensor). Um
+// quadro-chave (LORA_BLOCK_KEY) recomeça do zero, com ordens menores nas
+// primeiras leituras, e é decodificável sozinho; os demais exigem o bloco
+// anterior da série. Só decodificadores com lora_series_rx os entendem.
+//
+// Não depende do Pico SDK: o mesmo arquivo é usado pelo receptor ESP32 e
+// pelas ferramentas do host.
+
+#define LORA_FRAME_MAGIC     0xB1
+#define LORA_FRAME_HEADER    5
+
+#define LORA_FLAG_ALERT      0x01   // o pacote contém um alerta
+#define LORA_FLAG_CONTROL    0x02   // pacote do gateway para o nó "id do nó"
+#define LORA_FLAG_ROUTED     0x04   // traz o cabeçalho de roteamento
+
+#define LORA_BLOCK_SERIES    0x80   // bits do tipo de um bloco preditivo
+#define LORA_BLOCK_KEY       0x40
+#define LORA_BLOCK_ORDER     0x30
+#define LORA_BLOCK_TYPE      0x0F
+
+#define LORA_ROUTE_SIZE      4
+#define LORA_ROUTE_GATEWAY   0      // id do gateway nos saltos
+#define LORA_ROUTE_ANY       0xFF
+#define LORA_ROUTE_UNKNOWN   0xFF
+
+// Tipos de leitura e sua unidade em ponto fixo
+typedef enum {
+    LORA_SENSOR_DISTANCE = 1,       // mm
+    LORA_SENSOR_TEMPERATURE,        // 0,01 °C
+    LORA_SENSOR_HUMIDITY,           // 0,1 %UR
+    LORA_SENSOR_VOLTAGE,            // mV
+    LORA_SENSOR_CURRENT,            // 0,1 mA
+    LORA_SENSOR_LIGHT,              // lux
+    LORA_SENSOR_SNR,                // 0,25 dB (relatório de enlace do gateway)
+    LORA_SENSOR_RSSI,               // dBm
+    LORA_SENSOR_ACK,                // [0] última sequência recebida, [1] bitmap das 32 anteriores
+    LORA_SENSOR_COUNT
+} lora_sensor;
+
+// Roteamento de um pacote com LORA_FLAG_ROUTED
+typedef struct {
+    uint8_t hops;                   // saltos já dados (0 = saiu da origem)
+    uint8_t limit;                  // máximo de saltos (até 15)
+    uint8_t sender;                 // quem transmitiu este salto
+    uint8_t distance;               // saltos de sender até o gateway
+    uint8_t next;                   // quem deve encaminhar
+} lora_route;
+
+typedef struct {
+    uint8_t  flags;
+    uint8_t  node;
+    uint16_t seq;
+    lora_route route;               // sem LORA_FLAG_ROUTED: enviado direto por node
+} lora_frame_header;
+
+#define LORA_SERIES_AUTO     0xFF   // ordem escolhida pelas leituras recentes
+
+#ifndef LORA_SERIES_MAX
+#define LORA_SERIES_MAX      3      // séries de cada nó no decodificador
+#endif
+
+// Série de leituras de um sensor no nó, codificada entre pacotes
+typedef struct {
+    uint8_t  type;
+    uint8_t  order;                 // preditor (0..3) ou LORA_SERIES_AUTO
+    uint8_t  keyframe_every;        // blocos por quadro-chave (0 = só o primeiro)
+    uint8_t  blocks;                // blocos desde o último quadro-chave
+    uint8_t  index;                 // posição da próxima leitura (mod 256)
+    uint8_t  history;               // leituras anteriores conhecidas (até 3)
+    uint8_t  block_order;           // ordem do bloco aberto
+    uint8_t  block_group;           // bits por grupo do varint no bloco aberto
+    int32_t  step;                  // resolução do sensor em unidades do tipo (1)
+    int32_t  prev[3];               // leituras anteriores / step, prev[0] a mais recente
+    uint16_t cost[4][8];            // bits médios (x8) por ordem e grupo do varint
+} lora_series;
+
+// Estado de uma série no decodificador
+typedef struct {
+    uint8_t  type;                  // 0 = livre
+    bool     started;               // next vale: já chegou um bloco da série
+    bool     synced;                // prev vale: o próximo bloco pode ser decodificado
+    uint8_t  next;                  // índice esperado do próximo bloco
+    uint8_t  history;
+    int32_t  step;
+    int32_t  prev[3];
+} lora_series_track;
+
+// Séries de um nó no gateway (uma por nó, como lora_ack_window)
+typedef struct {
+    lora_series_track series[LORA_SERIES_MAX];
+    uint32_t gaps;                  // leituras perdidas ou impossíveis de reconstruir
+} lora_series_rx;
+
+// Estado da montagem de um pacote
+typedef struct {
+    uint8_t* buf;
+    uint8_t  cap;
+    uint8_t  size;
+    uint8_t  block;                 // posição do bloco aberto (0 = nenhum)
+    int32_t  last;                  // último valor do bloco aberto
+    uint8_t  readings;
+    lora_series* series;            // série do bloco aberto (NULL = bloco simples)
+    uint8_t  bit;                   // bits usados no último byte do bloco preditivo
+} lora_frame;
+
+// Começa um pacote em buf (até cap bytes). Com LORA_FLAG_ROUTED, o
+// roteamento sai como da origem, sem próximo salto definido
+void lora_frame_begin(lora_frame* f, uint8_t* buf, uint8_t cap,
+                      uint8_t node, uint16_t seq, uint8_t flags);
+
+// Acrescenta uma leitura; leituras seguidas do mesmo tipo formam um bloco
+// codificado por diferenças. Retorna false se não couber
+bool lora_frame_add(lora_frame* f, lora_sensor type, int32_t value);
+
+// Começa uma série do tipo type com quadro-chave a cada keyframe_every
+// blocos, ordem LORA_SERIES_AUTO (pode ser fixada em s->order) e passo 1.
+// s->step pode receber a resolução do sensor (ex.: 10 para o DHT22, que mede
+// 0,1 °C); uma leitura fora dele volta a série ao passo 1
+void lora_series_init(lora_series* s, lora_sensor type, uint8_t keyframe_every);
+
+// Força quadro-chave no próximo bloco (ex.: o gateway perdeu um pacote)
+void lora_series_keyframe(lora_series* s);
+
+// Acrescenta uma leitura da série; leituras seguidas formam um bloco
+// preditivo. Retorna false se não couber (a série fica como estava)
+bool lora_frame_add_series(lora_frame* f, lora_series* s, int32_t value);
+
+// Tamanho final do pacote
+uint8_t lora_frame_size(const lora_frame* f);
+
+// Chamado para cada leitura decodificada; index é a posição dentro do bloco
+typedef void (*lora_reading_callback)(lora_sensor type, uint8_t index, int32_t value, void* ctx);
+
+// Chamado quando missing leituras de uma série não podem ser reconstruídas
+// (pacotes perdidos antes deste ou bloco sem o anterior)
+typedef void (*lora_gap_callback)(lora_sensor type, uint8_t missing, void* ctx);
+
+// Decodifica um pacote. Retorna o número de leituras ou -1 se buf não for
+// um pacote válido (ex.: texto de um nó antigo). Sem estado, só os blocos
+// preditivos que são quadros-chave chegam ao callback
+int lora_frame_decode(const uint8_t* buf, uint8_t size, lora_frame_header* header,
+                      lora_reading_callback callback, void* ctx);
+
+// Como lora_frame_decode, mantendo em rx as séries do nó: reconstrói os
+// blocos preditivos exatamente ou avisa a lacuna por gap (pode ser NULL).
+// Cada pacote deve passar uma vez só, na ordem de chegada e sem duplicatas;
+// blocos atrasados só são aproveitados se forem quadros-chave
+int lora_frame_decode_series(const uint8_t* buf, uint8_t size, lora_frame_header* header,
+                             lora_series_rx* rx, lora_reading_callback callback,
+                             lora_gap_callback gap, void* ctx);
+
+// Lê e regrava o roteamento de um pacote com LORA_FLAG_ROUTED (false se não
+// tiver)
+bool lora_route_get(const uint8_t* buf, uint8_t size, lora_route* route);
+bool lora_route_set(uint8_t* buf, uint8_t size, const lora_route* route);
+
+// Canal (0..count-1) de um pacote num plano de saltos: função de (nó, seq),
+// então a resposta do gateway (controle com o mesmo nó e seq) sai no canal
+// do uplink e o gateway sabe onde responder. Pacotes que não são do formato
+// usam todos os bytes. Serve de seletor para lora_set_channel_plan
+uint8_t lora_frame_channel(const uint8_t* buf, uint8_t size, uint8_t count);
+
+// Janela de sequências recebidas de um nó, mantida pelo gateway para
+// descartar duplicatas e montar o ACK (bit i de bitmap = seq last - 1 - i)
+typedef struct {
+    uint16_t last;
+    uint32_t bitmap;
+    bool     valid;
+} lora_ack_window;
+
+// Registra seq na janela. Retorna false se o pacote já tinha sido recebido
+bool lora_ack_track(lora_ack_window* w, uint16_t seq);
+
+// Verdadeiro se o ACK (last, bitmap) confirma seq
+bool lora_ack_covers(uint16_t last, uint32_t bitmap, uint16_t seq);
+
+// Nome, unidade e divisor do ponto fixo de cada tipo (para exibição)
+const char* lora_sensor_name(lora_sensor type);
+const char* lora_sensor_unit(lora_sensor type);
+int lora_sensor_scale(lora_sensor type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LORA_TELEMETRY_H
@@ -3,6 +3,11 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "rfm95_lora.h"
+#include "lora_queue.h"
+#include "lora_telemetry.h"
+#include "lora_adr.h"
+#include "lora_reliable.h"
+#include "lora_relay.h"
 
 // =============================================================================
 // --- DEFINIÇÕES E FUNÇÕES DO SENSOR VL53L0X ---
@@ -72,6 +77,161 @@ int vl53l0x_read_distance_mm() {
 }
 
 
+// =============================================================================
+// --- FILA DE TRANSMISSÃO LORA ---
+// =============================================================================
+
+// Limite de ciclo de trabalho: 1% do tempo em qualquer janela de 1 hora
+#define LORA_DUTY_CYCLE        0.01f
+#define LORA_DUTY_WINDOW_S     3600
+
+// Identificação deste nó nos pacotes binários (lora_telemetry.h)
+#define LORA_NODE_ID           1
+
+// Leituras de distância agrupadas em cada pacote de telemetria
+#define TELEMETRIA_A_CADA      10
+
+// As distâncias vão como série preditiva (lora_series): cada pacote continua
+// do anterior e só o quadro-chave, a cada LORA_QUADRO_CHAVE pacotes, é
+// decodificável sozinho. Um pacote perdido custa ao gateway os seguintes até
+// o próximo quadro-chave, que também sai logo depois de uma perda confirmada
+#define LORA_QUADRO_CHAVE      4
+
+// Escuta antes de transmitir: esperas por canal ocupado antes de transmitir
+// mesmo assim
+#define LORA_LBT_ESPERAS       4
+
+// Entre transmissões o rádio dorme e acorda a cada LORA_DESPERTAR_MS para
+// procurar um relatório do gateway, que usa o mesmo valor no preâmbulo
+// (NODE_WAKE_MS no ESP32_LoRA_Receiver, NOS_DESPERTAR_MS no RFM95_LoRa_Gateway)
+#define LORA_DESPERTAR_MS      50
+
+// 1 = rede com relés (RFM95_LoRa_Relay): pacotes roteados, I/Q normal nos dois
+// sentidos e recepção contínua, já que os relés não alongam o preâmbulo
+#define LORA_ROTEADO           0
+
+// Canais do plano de saltos (lora_set_channel_plan), a partir de
+// LORA_FREQUENCY_HZ; 1 = canal fixo. Com mais de um, só o gateway Pico
+// (RFM95_LoRa_Gateway com o mesmo LORA_CANAIS) acompanha os saltos: ele
+// varre os canais, um a cada GATEWAY_VARREDURA_MS, e o preâmbulo cobre a volta
+#define LORA_CANAIS            1
+#define GATEWAY_VARREDURA_MS   3
+
+#if LORA_ROTEADO
+#define LORA_FLAGS             LORA_FLAG_ROUTED
+#else
+#define LORA_FLAGS             0
+#endif
+
+static uint16_t lora_seq = 0;
+static uint8_t lote_buf[64];
+static lora_frame lote;             // leituras aguardando o próximo pacote
+static lora_series serie_distancia;
+
+/* Envia o lote de leituras (baixa prioridade) e começa outro */
+static void envia_lote() {
+    static uint32_t atrasados = 0;
+    if (lote.readings > 0) {
+        lora_relay_prepare(lote_buf, lora_frame_size(&lote));
+        if (!lora_reliable_send(lote_buf, lora_frame_size(&lote), LORA_PRIORITY_LOW)) {
+            lora_series_keyframe(&serie_distancia);
+        }
+    }
+    // Pacote retransmitido ou perdido: se chegar, vem depois de um mais novo
+    // e o gateway descarta o bloco preditivo, então a série só volta num
+    // quadro-chave. Forçá-lo já na primeira retransmissão limita a lacuna a
+    // um lote, em vez de esperar o lora_reliable desistir (~93 s)
+    lora_reliable_stats rel;
+    lora_reliable_get_stats(&rel);
+    uint32_t eventos = rel.retransmissions + rel.lost + rel.evicted;
+    if (eventos != atrasados) {
+        atrasados = eventos;
+        lora_series_keyframe(&serie_distancia);
+    }
+    lora_frame_begin(&lote, lote_buf, sizeof(lote_buf), LORA_NODE_ID, lora_seq++, LORA_FLAGS);
+}
+
+/* Envia um alerta imediatamente, em um pacote próprio (alta prioridade) */
+static bool envia_alerta(int distancia_mm) {
+    uint8_t buf[16];
+    lora_frame f;
+    lora_frame_begin(&f, buf, sizeof(buf), LORA_NODE_ID, lora_seq++, LORA_FLAG_ALERT | LORA_FLAGS);
+    lora_frame_add(&f, LORA_SENSOR_DISTANCE, distancia_mm);
+    lora_relay_prepare(buf, lora_frame_size(&f));
+    return lora_reliable_send(buf, lora_frame_size(&f), LORA_PRIORITY_HIGH);
+}
+
+/* Relatório de enlace: SNR (em 0,25 dB) para o ADR e ACK para a entrega
+   confirmada ([0] última sequência, [1] bitmap) */
+static void le_relatorio(lora_sensor type, uint8_t index, int32_t value, void* ctx) {
+    static uint16_t ack_last;
+    if (type == LORA_SENSOR_SNR) {
+        lora_adr_report(value * 0.25f);
+    } else if (type == LORA_SENSOR_ACK && index == 0) {
+        ack_last = (uint16_t)value;
+    } else if (type == LORA_SENSOR_ACK && index == 1) {
+        lora_reliable_ack(ack_last, (uint32_t)value);
+    }
+}
+
+/* Pacotes recebidos entre transmissões (contexto de IRQ) */
+static void lora_recebido(const uint8_t* buffer, uint8_t size) {
+    // Rotas e duplicatas (pacotes roteados); RSSI corrigido pelo SNR
+    float snr = lora_packet_snr();
+    if (!lora_relay_receive(buffer, size, lora_packet_rssi() + (snr < 0 ? (int16_t)snr : 0))) {
+        return;
+    }
+    lora_frame_header header;
+    if (lora_frame_decode(buffer, size, &header, NULL, NULL) >= 0 &&
+        (header.flags & LORA_FLAG_CONTROL) && header.node == LORA_NODE_ID) {
+        lora_frame_decode(buffer, size, &header, le_relatorio, NULL);
+    }
+}
+
+/* Atualiza o ADR: conta os uplinks concluídos e aplica a nova configuração */
+static void atualiza_adr() {
+    static uint32_t uplinks = 0;
+    lora_queue_stats st;
+    lora_queue_get_stats(&st);
+    for (; uplinks < st.sent; uplinks++) {
+        lora_adr_uplink();
+    }
+    lora_adr_apply();
+}
+
+static void imprime_estatisticas_lora() {
+    lora_queue_stats st;
+    lora_adr_state adr;
+    lora_queue_get_stats(&st);
+    lora_adr_get_state(&adr);
+    printf("LoRa: fila %u (max %u), enviados %lu, descartados %lu, no ar %.1f s, credito %.1f s\n",
+           st.depth, st.max_depth, (unsigned long)st.sent, (unsigned long)st.dropped,
+           st.airtime_us / 1e6, st.credit_us / 1e6);
+    lora_reliable_stats rel;
+    lora_reliable_get_stats(&rel);
+    printf("Entrega: %lu de %lu confirmados (%.0f%%), %lu retransmissoes (+%.0f%%), %lu perdidos, %u pendentes\n",
+           (unsigned long)rel.delivered, (unsigned long)rel.sent,
+           rel.sent ? 100.0 * rel.delivered / rel.sent : 0.0,
+           (unsigned long)rel.retransmissions, rel.sent ? 100.0 * rel.retransmissions / rel.sent : 0.0,
+           (unsigned long)(rel.lost + rel.evicted), rel.pending);
+    printf("ADR: SF%u, %ld kHz, %u dBm, SNR %.1f dB, %lu ajustes, %u sem resposta\n",
+           adr.sf, adr.bw / 1000, adr.power, adr.last_snr, (unsigned long)adr.changes, adr.missed);
+    lora_power_stats pw;
+    lora_get_power_stats(&pw);
+    uint64_t total_us = pw.sleep_us + pw.standby_us + pw.tx_us + pw.rx_us + pw.cad_us;
+    printf("Radio: TX %.1f s, RX %.1f s, CAD %.1f s, sleep %.0f%%, %.3f mAh (%.2f mA), %lu esperas LBT\n",
+           pw.tx_us / 1e6, pw.rx_us / 1e6, pw.cad_us / 1e6,
+           total_us ? 100.0 * pw.sleep_us / total_us : 0.0, pw.charge_mah,
+           total_us ? pw.charge_mah / (total_us / 3.6e9) : 0.0, (unsigned long)pw.lbt_backoffs);
+#if LORA_ROTEADO
+    lora_relay_stats rs;
+    lora_relay_get_stats(&rs);
+    printf("Rota: %u saltos ate o gateway, proximo salto %u, %u vizinhos, %lu duplicatas\n",
+           rs.distance, rs.next_hop, rs.neighbors, (unsigned long)rs.duplicates);
+#endif
+}
+
+
 // =============================================================================
 // --- FUNÇÃO PRINCIPAL ---
 // =============================================================================
@@ -96,10 +256,42 @@ int main() {
     }
     printf("Comunicacao com RFM95 OK! ✅\n\n");
     
-    // Configura a potência do LoRa para o máximo
-    lora_set_power(17);
+    // Começa na potência máxima; o ADR reduz conforme os relatórios do
+    // gateway. O receptor ESP32 só ouve SF7/125 kHz, então apenas a
+    // potência é adaptada
+    lora_adr_config adr_cfg;
+    lora_adr_default_config(&adr_cfg);
+    adr_cfg.max_sf = 7;
+    lora_adr_init(&adr_cfg, 7, 125000, 17);
+    lora_queue_init(LORA_DUTY_CYCLE, LORA_DUTY_WINDOW_S);
+    lora_reliable_init(NULL);
+    lora_set_listen_before_talk(LORA_LBT_ESPERAS);
+#if LORA_CANAIS > 1
+    long canais[LORA_CANAIS];
+    for (int i = 0; i < LORA_CANAIS; i++)
+        canais[i] = (long)LORA_FREQUENCY_HZ + i * LORA_CHANNEL_SPACING_HZ;
+    lora_set_channel_plan(canais, LORA_CANAIS, lora_frame_channel);
+    lora_set_preamble_length(lora_wake_preamble_length(LORA_CANAIS * GATEWAY_VARREDURA_MS));
+#endif
+
+    lora_relay_config relay_cfg;
+    lora_relay_default_config(&relay_cfg, LORA_NODE_ID);
+    lora_relay_init(&relay_cfg);
+    lora_on_receive(lora_recebido);
+#if LORA_ROTEADO
+    lora_set_invert_iq(false, false);
+    lora_receive_async();
+#else
+    // Entre transmissões o rádio acorda periodicamente para os relatórios de
+    // enlace, que o gateway envia com I/Q invertido
+    lora_set_invert_iq(false, true);
+    lora_receive_duty_cycled(LORA_DESPERTAR_MS);
+#endif
+    lora_series_init(&serie_distancia, LORA_SENSOR_DISTANCE, LORA_QUADRO_CHAVE);
+    lora_frame_begin(&lote, lote_buf, sizeof(lote_buf), LORA_NODE_ID, lora_seq++, LORA_FLAGS);
 
     // --- Loop Principal ---
+    uint32_t leituras = 0;
     while (1) {
         // 1. Faz a leitura "crua" do sensor em milímetros
         int distancia_raw = vl53l0x_read_distance_mm();
@@ -127,13 +319,25 @@ int main() {
 
             // 4. Verifica a condição de alerta com o valor corrigido em mm
             if (distancia < 100) { // Menor que 10 cm (100 mm)
-                char message_buffer[50];
-                // Monta a mensagem de alerta usando o valor em cm
-                snprintf(message_buffer, sizeof(message_buffer), "ALERTA! Objeto a %.1f cm", distancia_cm);
-                
-                printf("--> Condição de alerta atingida! Enviando via LoRa: '%s'\n", message_buffer);
-                lora_send_packet((uint8_t*)message_buffer, strlen(message_buffer));
+                printf("--> Condição de alerta atingida! Enviando via LoRa: objeto a %.1f cm\n", distancia_cm);
+                // Entra na fila e retorna; a transmissão segue por interrupção
+                if (!envia_alerta(distancia)) {
+                    printf("--> Fila LoRa cheia, alerta descartado.\n");
+                }
             }
+
+            // 5. Guarda a leitura no lote de telemetria
+            if (!lora_frame_add_series(&lote, &serie_distancia, distancia)) {
+                envia_lote();
+                lora_frame_add_series(&lote, &serie_distancia, distancia);
+            }
+        }
+
+        atualiza_adr();
+        lora_reliable_poll();
+        if (++leituras % TELEMETRIA_A_CADA == 0) {
+            envia_lote();
+            imprime_estatisticas_lora();
         }
         
         // Aguarda 2 segundos para a próxima leitura
@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_encode.h"
+
+void buf_push(ByteBuf *b, uint8_t v)
+{
+	if (b->len == b->cap)
+	{
+		b->cap = b->cap ? b->cap * 2 : 256;
+		b->data = realloc(b->data, b->cap);
+	}
+	b->data[b->len++] = v;
+}
+
+void buf_free(ByteBuf *b)
+{
+	free(b->data);
+	b->data = NULL;
+	b->len = b->cap = 0;
+}
+
+static int paletteIndex(uint16_t *palette, int *n, uint16_t color)
+{
+	for (int i = 0; i < *n; i++)
+		if (palette[i] == color)
+			return i;
+	if (*n == 256)
+		return -1;
+	palette[*n] = color;
+	return (*n)++;
+}
+
+// PackBits over one row of palette indexes. Runs of 3 or more become run
+// packets; shorter repeats stay inside literal packets.
+static void encodeRow(const uint8_t *idx, uint16_t w, ByteBuf *out)
+{
+	uint16_t i = 0;
+	while (i < w)
+	{
+		uint16_t run = 1;
+		while (i + run < w && run < 128 && idx[i + run] == idx[i])
+			run++;
+		if (run >= 3)
+		{
+			buf_push(out, 0x80 | (run - 1));
+			buf_push(out, idx[i]);
+			i += run;
+			continue;
+		}
+
+		uint16_t start = i, n = 0;
+		while (i < w && n < 128)
+		{
+			if (i + 2 < w && idx[i] == idx[i + 1] && idx[i] == idx[i + 2])
+				break;
+			i++;
+			n++;
+		}
+		buf_push(out, n - 1);
+		for (uint16_t k = 0; k < n; k++)
+			buf_push(out, idx[start + k]);
+	}
+}
+
+int encode_image(const uint16_t *pixels, uint16_t w, uint16_t h, int32_t transparent,
+				 uint16_t *palette, int16_t *transparentIndex, ByteBuf *out)
+{
+	int n = 0;
+	uint8_t *idx = malloc((size_t)w * h);
+
+	*transparentIndex = -1;
+	if (transparent >= 0)
+	{
+		for (size_t i = 0; i < (size_t)w * h; i++)
+			if (pixels[i] == transparent)
+			{
+				*transparentIndex = paletteIndex(palette, &n, transparent);
+				break;
+			}
+	}
+
+	for (size_t i = 0; i < (size_t)w * h; i++)
+	{
+		int k = paletteIndex(palette, &n, pixels[i]);
+		if (k < 0)
+		{
+			free(idx);
+			return -1;
+		}
+		idx[i] = k;
+	}
+
+	for (uint16_t y = 0; y < h; y++)
+		encodeRow(idx + (size_t)y * w, w, out);
+	free(idx);
+	return n;
+}
+
+void encode_glyph(const uint8_t *mask, uint16_t w, uint16_t h, ByteBuf *out)
+{
+	for (uint16_t y = 0; y < h; y++)
+	{
+		const uint8_t *row = mask + (size_t)y * w;
+		bool fg = false;
+		uint16_t x = 0;
+		while (x < w)
+		{
+			uint16_t n = 0;
+			while (x + n < w && (row[x + n] != 0) == fg && n < 255)
+				n++;
+			buf_push(out, n);
+			x += n;
+			fg = !fg;
+		}
+	}
+}
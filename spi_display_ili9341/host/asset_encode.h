@@ -0,0 +1,29 @@
+#ifndef asset_encode_H
+#define asset_encode_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Encoders for the formats of lib/gfx/gfx_asset.h, shared by gfx_assetconv
+// and gfx_bench. Output goes to a growable byte buffer.
+
+typedef struct
+{
+	uint8_t *data;
+	size_t len, cap;
+} ByteBuf;
+
+void buf_push(ByteBuf *b, uint8_t v);
+void buf_free(ByteBuf *b);
+
+// Builds the palette of an RGB565 image (at most 256 colors, transparent
+// color first when used) and encodes its rows. Returns the palette size,
+// or -1 when the image has more than 256 colors.
+int encode_image(const uint16_t *pixels, uint16_t w, uint16_t h, int32_t transparent,
+				 uint16_t *palette, int16_t *transparentIndex, ByteBuf *out);
+
+// Encodes a w x h glyph bounding box (mask != 0 = foreground) as row runs
+void encode_glyph(const uint8_t *mask, uint16_t w, uint16_t h, ByteBuf *out);
+
+#endif
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_encode.h"
+
+// Converts images and font sheets into the compressed assets of
+// lib/gfx/gfx_asset.h and prints them as C source.
+//
+//   gfx_assetconv image <in.ppm> <name> [-t RRGGBB]
+//       RGB image (binary PPM), reduced to RGB565, at most 256 colors.
+//       -t marks a color as transparent.
+//   gfx_assetconv font <sheet.ppm> <name> <first> <last> <cellW> <cellH>
+//       Glyphs first..last drawn in cellW x cellH cells, left to right and
+//       top to bottom. The color of the top-left pixel is the background;
+//       every other pixel is ink. Characters advance by cellW.
+
+static uint8_t *readPPM(const char *path, int *w, int *h)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return NULL;
+
+	int maxval;
+	char magic[3] = {0};
+	if (fscanf(f, "%2s", magic) != 1 || strcmp(magic, "P6") != 0)
+	{
+		fclose(f);
+		return NULL;
+	}
+	// Skip comments between the header fields
+	int vals[3];
+	for (int i = 0; i < 3; i++)
+	{
+		int c;
+		while ((c = fgetc(f)) == '#' || c == ' ' || c == '\n' || c == '\r' || c == '\t')
+			if (c == '#')
+				while ((c = fgetc(f)) != '\n' && c != EOF)
+					;
+		ungetc(c, f);
+		if (fscanf(f, "%d", &vals[i]) != 1)
+		{
+			fclose(f);
+			return NULL;
+		}
+	}
+	*w = vals[0];
+	*h = vals[1];
+	maxval = vals[2];
+	fgetc(f);
+	if (maxval != 255 || *w <= 0 || *h <= 0)
+	{
+		fclose(f);
+		return NULL;
+	}
+
+	uint8_t *rgb = malloc((size_t)*w * *h * 3);
+	if (fread(rgb, 3, (size_t)*w * *h, f) != (size_t)*w * *h)
+	{
+		free(rgb);
+		rgb = NULL;
+	}
+	fclose(f);
+	return rgb;
+}
+
+static uint16_t rgb565(const uint8_t *p)
+{
+	return ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+}
+
+static void printBytes(const char *type, const char *name, const uint8_t *data, size_t n)
+{
+	printf("const %s %s[] = {", type, name);
+	for (size_t i = 0; i < n; i++)
+		printf("%s0x%02X,", (i % 12) ? " " : "\n    ", data[i]);
+	printf("\n};\n\n");
+}
+
+static int convertImage(const char *path, const char *name, int32_t transparent)
+{
+	int w, h;
+	uint8_t *rgb = readPPM(path, &w, &h);
+	if (!rgb)
+	{
+		fprintf(stderr, "%s: nao foi possivel ler o PPM\n", path);
+		return 1;
+	}
+	if (w > 320 || h > 320)
+	{
+		fprintf(stderr, "%s: imagem maior que a tela (%dx%d)\n", path, w, h);
+		free(rgb);
+		return 1;
+	}
+
+	uint16_t *pixels = malloc((size_t)w * h * 2);
+	for (size_t i = 0; i < (size_t)w * h; i++)
+		pixels[i] = rgb565(rgb + i * 3);
+	free(rgb);
+
+	uint16_t palette[256];
+	int16_t tIdx;
+	ByteBuf out = {0};
+	int n = encode_image(pixels, w, h, transparent, palette, &tIdx, &out);
+	free(pixels);
+	if (n < 0)
+	{
+		fprintf(stderr, "%s: mais de 256 cores, reduza a paleta antes\n", path);
+		return 1;
+	}
+
+	printf("// %s: %dx%d, %d cores, %zu bytes (RGB565 bruto: %d)\n\n", path, w, h, n, out.len, w * h * 2);
+	printf("#include \"gfx_asset.h\"\n\n");
+	printf("const uint16_t %s_palette[] = {", name);
+	for (int i = 0; i < n; i++)
+		printf("%s0x%04X,", (i % 8) ? " " : "\n    ", palette[i]);
+	printf("\n};\n\n");
+
+	char dataName[256];
+	snprintf(dataName, sizeof(dataName), "%s_data", name);
+	printBytes("uint8_t", dataName, out.data, out.len);
+	printf("const GFX_Image %s = {%d, %d, %s_palette, %d, %d, %s_data};\n", name, w, h, name, n, tIdx, name);
+
+	fprintf(stderr, "%s: %zu bytes, %.1f%% do RGB565 bruto\n", name, out.len, 100.0 * out.len / (w * h * 2));
+	buf_free(&out);
+	return 0;
+}
+
+static int convertFont(const char *path, const char *name, int first, int last, int cellW, int cellH)
+{
+	int w, h;
+	uint8_t *rgb = readPPM(path, &w, &h);
+	if (!rgb)
+	{
+		fprintf(stderr, "%s: nao foi possivel ler o PPM\n", path);
+		return 1;
+	}
+	if (cellW <= 0 || cellH <= 0 || cellW > 255 || cellH > 255 || first < 0 || first > last ||
+		last > 0xFFFF)
+	{
+		fprintf(stderr, "parametros de celula invalidos\n");
+		free(rgb);
+		return 1;
+	}
+
+	int perRow = w / cellW;
+	uint16_t bg = rgb565(rgb);
+	ByteBuf out = {0};
+	uint8_t *mask = malloc(cellW * cellH);
+
+	// Glyph table, printed after the run data it points into
+	typedef struct
+	{
+		size_t offset;
+		int w, h, x0, y0;
+	} Glyph;
+	Glyph *glyphs = malloc((size_t)(last - first + 1) * sizeof(Glyph));
+
+	printf("// %s: '%c'..'%c', celulas %dx%d\n\n", path, first, last, cellW, cellH);
+	printf("#include \"gfx_asset.h\"\n\n");
+
+	for (int c = first; c <= last; c++)
+	{
+		int cx = ((c - first) % perRow) * cellW;
+		int cy = ((c - first) / perRow) * cellH;
+		int x0 = cellW, y0 = cellH, x1 = -1, y1 = -1;
+
+		// Bounding box of the ink
+		for (int y = 0; y < cellH; y++)
+			for (int x = 0; x < cellW; x++)
+			{
+				bool ink = false;
+				if (cx + x < w && cy + y < h)
+					ink = rgb565(rgb + ((size_t)(cy + y) * w + cx + x) * 3) != bg;
+				if (ink)
+				{
+					x0 = x < x0 ? x : x0;
+					y0 = y < y0 ? y : y0;
+					x1 = x > x1 ? x : x1;
+					y1 = y > y1 ? y : y1;
+				}
+			}
+
+		int gw = x1 >= x0 ? x1 - x0 + 1 : 0;
+		int gh = y1 >= y0 ? y1 - y0 + 1 : 0;
+		if (gw == 0)
+			x0 = y0 = 0;
+		for (int y = 0; y < gh; y++)
+			for (int x = 0; x < gw; x++)
+				mask[y * gw + x] = rgb565(rgb + ((size_t)(cy + y0 + y) * w + cx + x0 + x) * 3) != bg;
+
+		if (out.len > 0xFFFF)
+		{
+			fprintf(stderr, "%s: fonte passa de 64 KB\n", name);
+			free(glyphs);
+			free(mask);
+			free(rgb);
+			buf_free(&out);
+			return 1;
+		}
+		glyphs[c - first] = (Glyph){out.len, gw, gh, x0, y0};
+		encode_glyph(mask, gw, gh, &out);
+	}
+	free(mask);
+	free(rgb);
+
+	char dataName[256];
+	snprintf(dataName, sizeof(dataName), "%s_data", name);
+	printBytes("uint8_t", dataName, out.data, out.len);
+	printf("const GFX_RunGlyph %s_glyphs[] = {\n", name);
+	for (int c = first; c <= last; c++)
+	{
+		const Glyph *g = &glyphs[c - first];
+		printf("    {%5zu, %3d, %3d, %3d, %3d, %3d}, // 0x%02X",
+			   g->offset, g->w, g->h, cellW, g->x0, g->y0, c);
+		if (c >= 0x20 && c < 0x7F && c != '\\')
+			printf(" '%c'", c);
+		printf("\n");
+	}
+	printf("};\n\n");
+	free(glyphs);
+	printf("const GFX_RunFont %s = {%s_data, %s_glyphs, 0x%02X, 0x%02X, %d};\n",
+		   name, name, name, first, last, cellH);
+
+	fprintf(stderr, "%s: %zu bytes de runs, %d glifos\n", name, out.len, last - first + 1);
+	buf_free(&out);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc >= 4 && strcmp(argv[1], "image") == 0)
+	{
+		int32_t transparent = -1;
+		if (argc == 6 && strcmp(argv[4], "-t") == 0)
+		{
+			uint32_t rgb = strtoul(argv[5], NULL, 16);
+			uint8_t p[3] = {rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF};
+			transparent = rgb565(p);
+		}
+		return convertImage(argv[2], argv[3], transparent);
+	}
+	if (argc == 8 && strcmp(argv[1], "font") == 0)
+		return convertFont(argv[2], argv[3], strtol(argv[4], NULL, 0), strtol(argv[5], NULL, 0),
+						   atoi(argv[6]), atoi(argv[7]));
+
+	fprintf(stderr, "uso: %s image <in.ppm> <nome> [-t RRGGBB]\n"
+					"     %s font <folha.ppm> <nome> <primeiro> <ultimo> <larguraCelula> <alturaCelula>\n",
+			argv[0], argv[0]);
+	return 1;
+}
@@ -0,0 +1,644 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pico/stdlib.h"
+#include "ili9341.h"
+#include "gfx.h"
+#include "gfx_console.h"
+#include "gfx_widgets.h"
+#include "gfx_chart.h"
+#include "gfx_asset.h"
+
+#include "ili9341_panel.h"
+#include "asset_encode.h"
+
+// Renders the screens of the example projects through the real gfx and
+// ili9341 code on top of the panel model and reports, per frame, what goes
+// over the SPI bus and how long the host took to produce it.
+//
+//   gfx_bench [-n frames] [-s spi_mhz] [-o ppm_dir] [-w|-c golden] [scene...]
+//
+// With -o, the last frame of each scene is written as <ppm_dir>/<scene>.ppm.
+// -w writes a hash of the last frame of each scene to a golden file and -c
+// compares against one (golden/gfx_bench.txt), exiting non-zero on any
+// mismatch. The hashes only hold for the frame count they were made with, so
+// -c takes it from the file.
+
+typedef struct
+{
+	const char *name;
+	const char *desc;
+	void (*setup)();
+	void (*frame)(int i);
+	void (*teardown)();
+} Scene;
+
+static void resetText()
+{
+	GFX_setCursor(0, 0);
+	GFX_setTextSize(1);
+	GFX_setTextColor(ILI9341_WHITE);
+	GFX_setTextBack(ILI9341_BLACK);
+	GFX_setClearColor(ILI9341_BLACK);
+}
+
+static void landscapeFramebuf()
+{
+	LCD_setRotation(1);
+	GFX_createFramebuf();
+	resetText();
+	GFX_clearScreen();
+	GFX_flush();
+}
+
+// Fake sensor signal, the same for every run
+static float wave(int i, float amp)
+{
+	return amp * sinf(i * 0.21f) + amp * 0.3f * sinf(i * 1.7f);
+}
+
+// ============================================================
+// spi_display_ili9341
+// ============================================================
+
+static void helloFrame(int i)
+{
+	GFX_clearScreen();
+	GFX_setCursor(0, 0);
+	GFX_printf("Hello GFX!\n%d", i);
+	GFX_flush();
+}
+
+static void helloSetup()
+{
+	landscapeFramebuf();
+	GFX_setTextSize(3);
+}
+
+static void hello4Setup()
+{
+	LCD_setRotation(1);
+	GFX_createIndexedFramebuf(4);
+	resetText();
+	GFX_setTextSize(3);
+}
+
+// Without a framebuffer every set pixel is its own address window
+static void unbufferedSetup()
+{
+	LCD_setRotation(1);
+	resetText();
+	GFX_setTextSize(2);
+	LCD_fillScreen(ILI9341_BLACK);
+}
+
+static void unbufferedFrame(int i)
+{
+	GFX_setCursor(0, 0);
+	GFX_printf("Hello GFX!\n%5d", i);
+}
+
+// Transparent text (bg == color) goes through LCD_WritePixel one pixel at a time
+static void unbufferedPxSetup()
+{
+	unbufferedSetup();
+	GFX_setTextBack(ILI9341_WHITE);
+}
+
+// Shapes drawn straight to the panel, then the same through the draw queue
+static void shapesFrame(int i)
+{
+	int16_t r = 20 + i % 20;
+
+	GFX_fillRect(10, 120, 140, 100, ILI9341_BLACK);
+	GFX_drawRect(10, 120, 140, 100, ILI9341_WHITE);
+	GFX_drawCircle(80, 170, r, ILI9341_YELLOW);
+	GFX_drawLine(10, 120, 149, 219, ILI9341_CYAN);
+	GFX_setCursor(0, 0);
+	GFX_printf("Hello GFX!\n%5d", i);
+	GFX_flush();
+}
+
+static void shapesQueueSetup()
+{
+	unbufferedPxSetup();
+	GFX_createQueue();
+}
+
+static void shapesQueueTeardown()
+{
+	GFX_destroyQueue();
+}
+
+// ============================================================
+// AHT10_ILI9341
+// ============================================================
+
+static void aht10Frame(int i)
+{
+	float temperature = 21.0f + wave(i, 2.0f);
+	float humidity = 65.0f + wave(i + 7, 8.0f);
+
+	GFX_clearScreen();
+	GFX_setTextSize(3);
+	GFX_setCursor(10, 20);
+	GFX_setTextColor(ILI9341_YELLOW);
+	GFX_printf("Temp: %.1f C", temperature);
+	GFX_setCursor(10, 80);
+	GFX_setTextColor(ILI9341_CYAN);
+	GFX_printf("Umid: %.1f %%", humidity);
+	GFX_setTextColor(ILI9341_RED);
+	GFX_setTextSize(2);
+	if (temperature < 20.0f)
+	{
+		GFX_setCursor(10, 150);
+		GFX_printf("ALERTA: TEMP. BAIXA!");
+	}
+	if (humidity > 70.0f)
+	{
+		GFX_setCursor(10, 180);
+		GFX_printf("ALERTA: UMID. ALTA!");
+	}
+	GFX_flush();
+}
+
+// ============================================================
+// GY_NEO6MV2_ILI9341_DISPLAY
+// ============================================================
+
+static GFX_Label lblStatus, lblHora, lblLat, lblLon, lblAlt;
+
+static void gpsFullFrame(int i)
+{
+	GFX_fillScreen(ILI9341_BLACK);
+	GFX_setTextSize(2);
+	GFX_setCursor(0, 10);
+	GFX_setTextColor(ILI9341_GREEN);
+	GFX_printf(" Sinal OK (%d satelites)\n\n", 7);
+	GFX_setTextColor(ILI9341_WHITE);
+	GFX_printf(" Hora: %02d:%02d:%02d\n\n", 12, i / 60 % 60, i % 60);
+	GFX_printf(" Lat:  %.5f\n\n", -23.55052f + i * 1e-5f);
+	GFX_printf(" Lon:  %.5f\n\n", -46.63331f);
+	GFX_printf(" Alt:  %.1f m", 760.0f + wave(i, 1.5f));
+	GFX_flush();
+}
+
+static void gpsLabelsSetup()
+{
+	landscapeFramebuf();
+	GFX_labelInit(&lblStatus, 0, 10, 26, 2, ILI9341_GREEN, ILI9341_BLACK);
+	GFX_labelInit(&lblHora, 0, 42, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+	GFX_labelInit(&lblLat, 0, 74, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+	GFX_labelInit(&lblLon, 0, 106, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+	GFX_labelInit(&lblAlt, 0, 138, 26, 2, ILI9341_WHITE, ILI9341_BLACK);
+	GFX_labelPrintf(&lblStatus, " Sinal OK (%d satelites)", 7);
+	GFX_labelPrintf(&lblLon, " Lon:  %.5f", -46.63331f);
+	GFX_flushDamage();
+}
+
+static void gpsLabelsFrame(int i)
+{
+	GFX_labelPrintf(&lblHora, " Hora: %02d:%02d:%02d", 12, i / 60 % 60, i % 60);
+	GFX_labelPrintf(&lblLat, " Lat:  %.5f", -23.55052f + i * 1e-5f);
+	GFX_labelPrintf(&lblAlt, " Alt:  %.1f m", 760.0f + wave(i, 1.5f));
+	GFX_flushDamage();
+}
+
+// ============================================================
+// MPU6050_ILI9341
+// ============================================================
+
+static GFX_Value valAccX, valAccY, valAccZ, valAngulo;
+static GFX_Chart grafico;
+
+static void mpuFullFrame(int i)
+{
+	GFX_clearScreen();
+	GFX_setTextSize(3);
+	GFX_setCursor(0, 20);
+	GFX_printf("Acc X: %.2f g\n", wave(i, 0.5f));
+	GFX_printf("Acc Y: %.2f g\n", wave(i + 3, 0.5f));
+	GFX_printf("Acc Z: %.2f g\n\n", 1.0f + wave(i + 5, 0.1f));
+	GFX_printf("Angulo: %.1f\xF7", wave(i, 40.0f));
+	GFX_flush();
+}
+
+static void mpuWidgetsSetup()
+{
+	landscapeFramebuf();
+	GFX_valueInit(&valAccX, 0, 20, 14, 3, ILI9341_WHITE, ILI9341_BLACK, "Acc X: %.2f g");
+	GFX_valueInit(&valAccY, 0, 44, 14, 3, ILI9341_WHITE, ILI9341_BLACK, "Acc Y: %.2f g");
+	GFX_valueInit(&valAccZ, 0, 68, 14, 3, ILI9341_WHITE, ILI9341_BLACK, "Acc Z: %.2f g");
+	GFX_valueInit(&valAngulo, 0, 116, 15, 3, ILI9341_WHITE, ILI9341_BLACK, "Angulo: %.1f\xF7");
+	GFX_chartInit(&grafico, 0, 150, 320, 86, -90.0f, 90.0f, 1,
+				  ILI9341_CYAN, ILI9341_BLACK, GFX_RGB565(60, 60, 60));
+}
+
+static void mpuWidgetsFrame(int i)
+{
+	GFX_valueSet(&valAccX, wave(i, 0.5f));
+	GFX_valueSet(&valAccY, wave(i + 3, 0.5f));
+	GFX_valueSet(&valAccZ, 1.0f + wave(i + 5, 0.1f));
+	GFX_valueSet(&valAngulo, wave(i, 40.0f));
+	GFX_chartPush(&grafico, wave(i, 40.0f));
+	GFX_chartUpdate(&grafico);
+	GFX_flushDamage();
+}
+
+static void mpuWidgetsTeardown()
+{
+	GFX_chartFree(&grafico);
+}
+
+// ============================================================
+// Console de texto
+// ============================================================
+
+static void consoleHwSetup()
+{
+	LCD_setRotation(0);
+	GFX_createFramebuf();
+	resetText();
+	GFX_clearScreen();
+	GFX_flush();
+	GFX_consoleInit(0, 0, 1);
+}
+
+static void consoleFrame(int i)
+{
+	GFX_consolePrintf("linha %d: dist=%d mm\n", i, 400 + (int)wave(i, 300.0f));
+}
+
+static void consoleFbSetup()
+{
+	LCD_setRotation(0);
+	GFX_createFramebuf();
+	resetText();
+	GFX_clearScreen();
+	GFX_flush();
+}
+
+// Previous approach: move the framebuffer up one text row and resend it all
+static void consoleFbFrame(int i)
+{
+	GFX_scrollUp(8);
+	GFX_setCursor(0, GFX_getHeight() - 8);
+	GFX_printf("linha %d: dist=%d mm", i, 400 + (int)wave(i, 300.0f));
+	GFX_flush();
+}
+
+static void consoleHwTeardown()
+{
+	GFX_consoleEnd();
+}
+
+// ============================================================
+// Assets comprimidos (gfx_asset)
+// ============================================================
+
+#define ICON_SIZE 64
+#define ICON_KEY ILI9341_MAGENTA
+
+static uint16_t iconRaw[ICON_SIZE * ICON_SIZE];
+static uint16_t iconPalette[256];
+static ByteBuf iconData;
+static GFX_Image icon;
+
+// Ringed disc on a transparent background, like a status icon
+static void makeIcon()
+{
+	static const uint16_t rings[] = {ILI9341_YELLOW, ILI9341_ORANGE, ILI9341_RED,
+									 ILI9341_MAGENTA - 0x0800, ILI9341_BLUE, ILI9341_CYAN};
+	if (iconData.len > 0)
+		return;
+	for (int y = 0; y < ICON_SIZE; y++)
+		for (int x = 0; x < ICON_SIZE; x++)
+		{
+			int dx = x - ICON_SIZE / 2, dy = y - ICON_SIZE / 2;
+			int r = (int)sqrtf(dx * dx + dy * dy);
+			uint16_t c = ICON_KEY;
+			if (r < 30)
+				c = rings[r / 5];
+			if (r < 30 && abs(dx + dy) < 2)
+				c = ILI9341_WHITE;
+			iconRaw[y * ICON_SIZE + x] = c;
+		}
+
+	int16_t tIdx;
+	int n = encode_image(iconRaw, ICON_SIZE, ICON_SIZE, ICON_KEY, iconPalette, &tIdx, &iconData);
+	icon = (GFX_Image){ICON_SIZE, ICON_SIZE, iconPalette, n, tIdx, iconData.data};
+}
+
+// Large numerals: the classic font at size 8 turned into a run font
+#define DIGIT_SIZE 8
+#define DIGIT_W (6 * DIGIT_SIZE)
+#define DIGIT_H (8 * DIGIT_SIZE)
+
+static GFX_RunGlyph digitGlyphs[':' - '0' + 1];
+static ByteBuf digitData;
+static GFX_RunFont digits;
+
+static void makeDigits()
+{
+	static uint16_t cell[DIGIT_W * DIGIT_H];
+	static uint8_t mask[DIGIT_W * DIGIT_H];
+
+	if (digitData.len > 0)
+		return;
+	for (int c = '0'; c <= ':'; c++)
+	{
+		GFX_renderChar(cell, DIGIT_W, c, 1, 0, DIGIT_SIZE, DIGIT_SIZE);
+		int x0 = DIGIT_W, y0 = DIGIT_H, x1 = -1, y1 = -1;
+		for (int y = 0; y < DIGIT_H; y++)
+			for (int x = 0; x < DIGIT_W; x++)
+				if (cell[y * DIGIT_W + x])
+				{
+					x0 = x < x0 ? x : x0;
+					y0 = y < y0 ? y : y0;
+					x1 = x > x1 ? x : x1;
+					y1 = y > y1 ? y : y1;
+				}
+		int gw = x1 - x0 + 1, gh = y1 - y0 + 1;
+		for (int y = 0; y < gh; y++)
+			for (int x = 0; x < gw; x++)
+				mask[y * gw + x] = cell[(y0 + y) * DIGIT_W + x0 + x] != 0;
+
+		digitGlyphs[c - '0'] = (GFX_RunGlyph){digitData.len, gw, gh, DIGIT_W, x0, y0};
+		encode_glyph(mask, gw, gh, &digitData);
+	}
+	digits = (GFX_RunFont){digitData.data, digitGlyphs, '0', ':', DIGIT_H};
+}
+
+static void iconSetup()
+{
+	makeIcon();
+	unbufferedSetup();
+}
+
+// The icon kept as raw RGB565 and drawn pixel by pixel
+static void iconPixelsFrame(int i)
+{
+	int16_t x0 = (i * 16) % (320 - ICON_SIZE), y0 = 60;
+	for (int y = 0; y < ICON_SIZE; y++)
+		for (int x = 0; x < ICON_SIZE; x++)
+			if (iconRaw[y * ICON_SIZE + x] != ICON_KEY)
+				GFX_drawPixel(x0 + x, y0 + y, iconRaw[y * ICON_SIZE + x]);
+}
+
+static void iconImageFrame(int i)
+{
+	GFX_drawImage(&icon, (i * 16) % (320 - ICON_SIZE), 60);
+}
+
+// Without a transparent index the image is one streamed window, here clipped
+// by the right and bottom edges
+static void iconOpaqueFrame(int i)
+{
+	GFX_Image opaque = icon;
+	opaque.transparent = -1;
+	GFX_drawImage(&opaque, (i * 16) % 320 - ICON_SIZE / 2, 200);
+}
+
+static void digitsSetup()
+{
+	makeDigits();
+	unbufferedSetup();
+	GFX_setTextSize(DIGIT_SIZE);
+}
+
+static void digitsFbSetup()
+{
+	makeDigits();
+	landscapeFramebuf();
+	GFX_setTextSize(DIGIT_SIZE);
+}
+
+static void digitsClassicFrame(int i)
+{
+	GFX_setCursor(10, 80);
+	GFX_printf("%02d:%02d", i / 60 % 100, i % 60);
+	if (GFX_hasFramebuf())
+		GFX_flushRect(10, 80, 5 * DIGIT_W, DIGIT_H);
+}
+
+static void digitsRunFrame(int i)
+{
+	char text[8];
+	snprintf(text, sizeof(text), "%02d:%02d", i / 60 % 100, i % 60);
+	GFX_drawRunText(&digits, 10, 80, text, ILI9341_WHITE, ILI9341_BLACK);
+	if (GFX_hasFramebuf())
+		GFX_flushRect(10, 80, 5 * DIGIT_W, DIGIT_H);
+}
+
+static const Scene scenes[] = {
+	{"hello", "tftspi_display, full frame", helloSetup, helloFrame, NULL},
+	{"hello_4bpp", "tftspi_display, 4 bpp framebuffer", hello4Setup, helloFrame, NULL},
+	{"hello_unbuffered", "tftspi_display text without framebuffer", unbufferedSetup, unbufferedFrame, NULL},
+	{"hello_unbuf_px", "same, transparent text, pixel by pixel", unbufferedPxSetup, unbufferedFrame, NULL},
+	{"shapes_unbuf", "rect + circle + line + text, no framebuffer", unbufferedPxSetup, shapesFrame, NULL},
+	{"shapes_queue", "same through GFX_createQueue", shapesQueueSetup, shapesFrame, shapesQueueTeardown},
+	{"aht10", "AHT10_ILI9341, full frame", landscapeFramebuf, aht10Frame, NULL},
+	{"gps_full", "GPS screen redrawn and flushed whole", landscapeFramebuf, gpsFullFrame, NULL},
+	{"gps_labels", "GY_NEO6MV2_ILI9341_DISPLAY, labels + damage", gpsLabelsSetup, gpsLabelsFrame, NULL},
+	{"mpu_full", "MPU6050 screen redrawn and flushed whole", landscapeFramebuf, mpuFullFrame, NULL},
+	{"mpu_widgets", "MPU6050_ILI9341, values + chart + damage", mpuWidgetsSetup, mpuWidgetsFrame, mpuWidgetsTeardown},
+	{"console_fb", "one text line per frame, framebuffer scroll", consoleFbSetup, consoleFbFrame, NULL},
+	{"console_hw", "one text line per frame, hardware scroll", consoleHwSetup, consoleFrame, consoleHwTeardown},
+	{"icon_pixels", "64x64 icon as raw RGB565, pixel by pixel", iconSetup, iconPixelsFrame, NULL},
+	{"icon_image", "same icon as an RLE GFX_Image", iconSetup, iconImageFrame, NULL},
+	{"icon_opaque", "same image without transparency, clipped", iconSetup, iconOpaqueFrame, NULL},
+	{"digits_classic", "size 8 classic font, no framebuffer", digitsSetup, digitsClassicFrame, NULL},
+	{"digits_runfont", "same numerals as a run font, no framebuffer", digitsSetup, digitsRunFrame, NULL},
+	{"digits_classic_fb", "size 8 classic font + flushRect", digitsFbSetup, digitsClassicFrame, NULL},
+	{"digits_runfont_fb", "same numerals as a run font + flushRect", digitsFbSetup, digitsRunFrame, NULL},
+};
+
+#define NUM_SCENES (sizeof(scenes) / sizeof(scenes[0]))
+
+static bool selectedScene(const char *name, int argc, char **argv, int first)
+{
+	if (first >= argc)
+		return true;
+	for (int i = first; i < argc; i++)
+		if (strcmp(argv[i], name) == 0)
+			return true;
+	return false;
+}
+
+// Golden file: a "frames <n>" line, then one "<scene> <hash>" line per scene
+typedef struct
+{
+	char name[32];
+	uint64_t hash;
+} Golden;
+
+static Golden golden[NUM_SCENES];
+static size_t numGolden;
+
+static int loadGolden(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return -1;
+
+	char line[128];
+	int frames = -1;
+	while (fgets(line, sizeof(line), f))
+	{
+		Golden g;
+		unsigned long long hash;
+		if (line[0] == '#')
+			continue;
+		if (sscanf(line, "frames %d", &frames) == 1)
+			continue;
+		if (sscanf(line, "%31s %llx", g.name, &hash) == 2 && numGolden < NUM_SCENES)
+		{
+			g.hash = hash;
+			golden[numGolden++] = g;
+		}
+	}
+	fclose(f);
+	return frames;
+}
+
+static const Golden *findGolden(const char *name)
+{
+	for (size_t i = 0; i < numGolden; i++)
+		if (strcmp(golden[i].name, name) == 0)
+			return &golden[i];
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	int frames = 200;
+	bool framesSet = false;
+	float spiMhz = 40.0f;
+	const char *ppmDir = NULL;
+	const char *writePath = NULL, *checkPath = NULL;
+	int arg = 1;
+
+	for (; arg < argc && argv[arg][0] == '-'; arg++)
+	{
+		if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+		{
+			frames = atoi(argv[++arg]);
+			framesSet = true;
+		}
+		else if (strcmp(argv[arg], "-s") == 0 && arg + 1 < argc)
+			spiMhz = atof(argv[++arg]);
+		else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc)
+			ppmDir = argv[++arg];
+		else if (strcmp(argv[arg], "-w") == 0 && arg + 1 < argc)
+			writePath = argv[++arg];
+		else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc)
+			checkPath = argv[++arg];
+		else
+		{
+			fprintf(stderr, "uso: %s [-n frames] [-s spi_mhz] [-o ppm_dir] [-w|-c golden] [cena...]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (frames < 1)
+		frames = 1;
+
+	if (checkPath)
+	{
+		int goldenFrames = loadGolden(checkPath);
+		if (goldenFrames < 1)
+		{
+			fprintf(stderr, "%s: arquivo de referencia invalido\n", checkPath);
+			return 1;
+		}
+		if (framesSet && frames != goldenFrames)
+		{
+			fprintf(stderr, "%s foi gerado com -n %d\n", checkPath, goldenFrames);
+			return 1;
+		}
+		frames = goldenFrames;
+	}
+
+	FILE *writeFile = NULL;
+	if (writePath)
+	{
+		writeFile = fopen(writePath, "w");
+		if (!writeFile)
+		{
+			fprintf(stderr, "falha ao gravar %s\n", writePath);
+			return 1;
+		}
+		fprintf(writeFile, "# Last frame of each gfx_bench scene, FNV-1a of the panel pixels\n");
+		fprintf(writeFile, "frames %d\n", frames);
+	}
+	int mismatches = 0;
+
+	printf("%-17s %10s %6s %7s %9s %9s %8s\n",
+		   "scene", "bytes/fr", "cs/fr", "win/fr", "host us", "wire ms", "max fps");
+
+	for (size_t s = 0; s < NUM_SCENES; s++)
+	{
+		const Scene *sc = &scenes[s];
+		if (!selectedScene(sc->name, argc, argv, arg))
+			continue;
+
+		PANEL_reset();
+		LCD_initDisplay();
+		GFX_destroyFramebuf();
+		sc->setup();
+		PANEL_clearStats();
+
+		uint64_t t0 = time_us_64();
+		for (int i = 0; i < frames; i++)
+			sc->frame(i);
+		uint64_t t1 = time_us_64();
+
+		PANEL_Stats st = PANEL_getStats();
+		double bytes = (double)st.bytes / frames;
+		double wireMs = bytes * 8.0 / (spiMhz * 1000.0);
+		double hostUs = (double)(t1 - t0) / frames;
+		double frameMs = wireMs + hostUs / 1000.0;
+
+		printf("%-17s %10.0f %6.1f %7.1f %9.1f %9.3f %8.1f   %s\n",
+			   sc->name, bytes, (double)st.transactions / frames, (double)st.windows / frames,
+			   hostUs, wireMs, frameMs > 0 ? 1000.0 / frameMs : 0.0, sc->desc);
+
+		if (ppmDir)
+		{
+			char path[512];
+			snprintf(path, sizeof(path), "%s/%s.ppm", ppmDir, sc->name);
+			if (!PANEL_writePPM(path))
+				fprintf(stderr, "falha ao gravar %s\n", path);
+		}
+
+		uint64_t hash = PANEL_hash();
+		if (writeFile)
+			fprintf(writeFile, "%-17s %016llx\n", sc->name, (unsigned long long)hash);
+		if (checkPath)
+		{
+			const Golden *g = findGolden(sc->name);
+			if (!g)
+			{
+				fprintf(stderr, "%s: sem referencia em %s\n", sc->name, checkPath);
+				mismatches++;
+			}
+			else if (g->hash != hash)
+			{
+				fprintf(stderr, "%s: imagem %016llx, referencia %016llx\n", sc->name,
+						(unsigned long long)hash, (unsigned long long)g->hash);
+				mismatches++;
+			}
+		}
+
+		if (sc->teardown)
+			sc->teardown();
+	}
+
+	GFX_destroyFramebuf();
+	if (writeFile)
+		fclose(writeFile);
+	if (checkPath)
+		printf("%d cena(s) diferente(s) da referencia\n", mismatches);
+	return mismatches ? 1 : 0;
+}
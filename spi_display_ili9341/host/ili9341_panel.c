@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ili9341.h"
+#include "ili9341_panel.h"
+
+static uint16_t gram[ILI9341_TFTHEIGHT][ILI9341_TFTWIDTH];
+
+static bool selected, dataMode;
+static uint8_t cmd;
+static uint8_t args[8];
+static uint8_t nargs;
+
+static uint16_t colStart, colEnd, pageStart, pageEnd;
+static uint16_t curCol, curPage;
+static bool writing;
+static uint8_t pixHigh;
+static bool pixHalf;
+
+static uint8_t madctl;
+static uint16_t tfa, vsa = ILI9341_TFTHEIGHT, bfa, vsp;
+
+static PANEL_Stats stats;
+
+void PANEL_reset()
+{
+	memset(gram, 0, sizeof(gram));
+	selected = false;
+	dataMode = true;
+	cmd = ILI9341_NOP;
+	nargs = 0;
+	colStart = curCol = 0;
+	colEnd = ILI9341_TFTWIDTH - 1;
+	pageStart = curPage = 0;
+	pageEnd = ILI9341_TFTHEIGHT - 1;
+	writing = false;
+	pixHalf = false;
+	madctl = 0;
+	tfa = bfa = 0;
+	vsa = ILI9341_TFTHEIGHT;
+	vsp = 0;
+	memset(&stats, 0, sizeof(stats));
+}
+
+// Column / page address (as set by CASET / PASET) to GRAM position
+static bool toGram(uint16_t c, uint16_t p, uint16_t *col, uint16_t *row)
+{
+	uint16_t cc = c, rr = p;
+	if (madctl & MADCTL_MV)
+	{
+		cc = p;
+		rr = c;
+	}
+	if (cc >= ILI9341_TFTWIDTH || rr >= ILI9341_TFTHEIGHT)
+		return false;
+	if (madctl & MADCTL_MX)
+		cc = ILI9341_TFTWIDTH - 1 - cc;
+	if (madctl & MADCTL_MY)
+		rr = ILI9341_TFTHEIGHT - 1 - rr;
+	*col = cc;
+	*row = rr;
+	return true;
+}
+
+static void storePixel(uint16_t color)
+{
+	uint16_t col, row;
+	if (toGram(curCol, curPage, &col, &row))
+	{
+		gram[row][col] = color;
+		stats.pixels++;
+	}
+	if (curCol++ >= colEnd)
+	{
+		curCol = colStart;
+		if (curPage++ >= pageEnd)
+			curPage = pageStart;
+	}
+}
+
+static void runCommand()
+{
+	switch (cmd)
+	{
+	case ILI9341_CASET:
+		if (nargs == 4)
+		{
+			colStart = (args[0] << 8) | args[1];
+			colEnd = (args[2] << 8) | args[3];
+		}
+		break;
+	case ILI9341_PASET:
+		if (nargs == 4)
+		{
+			pageStart = (args[0] << 8) | args[1];
+			pageEnd = (args[2] << 8) | args[3];
+		}
+		break;
+	case ILI9341_MADCTL:
+		if (nargs == 1)
+			madctl = args[0];
+		break;
+	case ILI9341_VSCRDEF:
+		if (nargs == 6)
+		{
+			tfa = (args[0] << 8) | args[1];
+			vsa = (args[2] << 8) | args[3];
+			bfa = (args[4] << 8) | args[5];
+		}
+		break;
+	case ILI9341_VSCRSADD:
+		if (nargs == 2)
+			vsp = (args[0] << 8) | args[1];
+		break;
+	}
+}
+
+void PANEL_select(bool active)
+{
+	if (active && !selected)
+		stats.transactions++;
+	selected = active;
+}
+
+void PANEL_setDC(bool data)
+{
+	dataMode = data;
+}
+
+void PANEL_writeByte(uint8_t b)
+{
+	stats.bytes++;
+	if (!selected)
+		return;
+
+	if (!dataMode)
+	{
+		stats.commands++;
+		cmd = b;
+		nargs = 0;
+		writing = (b == ILI9341_RAMWR);
+		if (writing)
+		{
+			stats.windows++;
+			curCol = colStart;
+			curPage = pageStart;
+			pixHalf = false;
+		}
+		return;
+	}
+
+	if (writing)
+	{
+		if (!pixHalf)
+			pixHigh = b;
+		else
+			storePixel((pixHigh << 8) | b);
+		pixHalf = !pixHalf;
+		return;
+	}
+
+	if (nargs < sizeof(args))
+		args[nargs++] = b;
+	runCommand();
+}
+
+PANEL_Stats PANEL_getStats()
+{
+	return stats;
+}
+
+void PANEL_clearStats()
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+uint16_t PANEL_getWidth()
+{
+	return (madctl & MADCTL_MV) ? ILI9341_TFTHEIGHT : ILI9341_TFTWIDTH;
+}
+
+uint16_t PANEL_getHeight()
+{
+	return (madctl & MADCTL_MV) ? ILI9341_TFTWIDTH : ILI9341_TFTHEIGHT;
+}
+
+uint16_t PANEL_getPixel(uint16_t x, uint16_t y)
+{
+	uint16_t col, row;
+	if (!toGram(x, y, &col, &row))
+		return 0;
+
+	// Rows inside the scroll area show GRAM starting at VSP
+	if (row >= tfa && row < tfa + vsa)
+	{
+		int r = ((int)row - tfa + (int)vsp - tfa) % vsa;
+		row = tfa + (r < 0 ? r + vsa : r);
+	}
+	return gram[row][col];
+}
+
+bool PANEL_writePPM(const char *path)
+{
+	FILE *f = fopen(path, "wb");
+	if (!f)
+		return false;
+
+	uint16_t w = PANEL_getWidth(), h = PANEL_getHeight();
+	fprintf(f, "P6\n%u %u\n255\n", w, h);
+	for (uint16_t y = 0; y < h; y++)
+		for (uint16_t x = 0; x < w; x++)
+		{
+			uint16_t c = PANEL_getPixel(x, y);
+			uint8_t rgb[3] = {
+				(uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+				(uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+				(uint8_t)((c & 0x1F) * 255 / 31)};
+			fwrite(rgb, 1, 3, f);
+		}
+	return fclose(f) == 0;
+}
+
+uint64_t PANEL_hash()
+{
+	uint16_t w = PANEL_getWidth(), h = PANEL_getHeight();
+	uint64_t hash = 14695981039346656037ull;
+
+	hash = (hash ^ w) * 1099511628211ull;
+	hash = (hash ^ h) * 1099511628211ull;
+	for (uint16_t y = 0; y < h; y++)
+		for (uint16_t x = 0; x < w; x++)
+			hash = (hash ^ PANEL_getPixel(x, y)) * 1099511628211ull;
+	return hash;
+}
@@ -0,0 +1,38 @@
+#ifndef ili9341_panel_H
+#define ili9341_panel_H
+#include "pico/stdlib.h"
+
+// Host model of the ILI9341 controller as seen from the SPI bus. The real
+// lib/ili9341 driver runs unchanged on top of pico_host.c, which forwards
+// CS / DC edges and every clocked byte here. The model decodes the command
+// stream (CASET, PASET, RAMWR, MADCTL, VSCRDEF, VSCRSADD), keeps the 240x320
+// GRAM and counts the traffic that would have gone over the wire.
+
+typedef struct
+{
+	uint64_t bytes;		   // Bytes clocked on MOSI, commands included
+	uint32_t transactions; // CS low periods
+	uint32_t commands;	   // Bytes sent with DC low
+	uint32_t windows;	   // RAMWR commands (address window + write)
+	uint64_t pixels;	   // Pixels stored into GRAM
+} PANEL_Stats;
+
+void PANEL_reset();
+void PANEL_select(bool active);
+void PANEL_setDC(bool data);
+void PANEL_writeByte(uint8_t b);
+
+PANEL_Stats PANEL_getStats();
+void PANEL_clearStats();
+
+// Pixels as they appear on the glass (scroll applied), in the coordinates of
+// the current MADCTL rotation
+uint16_t PANEL_getWidth();
+uint16_t PANEL_getHeight();
+uint16_t PANEL_getPixel(uint16_t x, uint16_t y);
+bool PANEL_writePPM(const char *path);
+
+// FNV-1a over the size and the RGB565 pixels on the glass, for golden checks
+uint64_t PANEL_hash();
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+// Host builds are single threaded; a compiler fence keeps the ordering.
+
+static inline void __dmb(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif
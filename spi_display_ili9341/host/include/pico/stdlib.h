@@ -0,0 +1,29 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Minimal stand-in for the Pico SDK so lib/gfx and lib/ili9341 build on Linux.
+// Only what those libraries use is declared; see pico_host.c.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_FUNC_SPI 1
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+void gpio_set_function(uint gpio, uint fn);
+
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+static inline void tight_loop_contents(void) {}
+
+#endif
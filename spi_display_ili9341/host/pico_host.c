@@ -0,0 +1,155 @@
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+
+#include "ili9341_panel.h"
+
+// Pico SDK calls used by lib/gfx and lib/ili9341, implemented on Linux.
+// GPIO writes to the display CS / DC pins and all SPI traffic go to the
+// panel model; sleeps return immediately so benchmarks measure CPU time.
+
+extern uint16_t ili9341_pinCS;
+extern uint16_t ili9341_pinDC;
+
+struct spi_inst
+{
+	spi_hw_t hw;
+};
+
+spi_inst_t host_spi_inst;
+
+// ============================================================
+// GPIO
+// ============================================================
+
+void gpio_init(uint gpio) {}
+void gpio_set_dir(uint gpio, bool out) {}
+void gpio_set_function(uint gpio, uint fn) {}
+
+void gpio_put(uint gpio, bool value)
+{
+	if (gpio == ili9341_pinCS)
+		PANEL_select(!value);
+	else if (gpio == ili9341_pinDC)
+		PANEL_setDC(value);
+}
+
+// ============================================================
+// Tempo
+// ============================================================
+
+void sleep_ms(uint32_t ms) {}
+void sleep_us(uint64_t us) {}
+
+uint64_t time_us_64(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000u;
+}
+
+uint32_t time_us_32(void)
+{
+	return (uint32_t)time_us_64();
+}
+
+// ============================================================
+// SPI
+// ============================================================
+
+uint spi_init(spi_inst_t *spi, uint baudrate)
+{
+	return baudrate;
+}
+
+void spi_deinit(spi_inst_t *spi) {}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		PANEL_writeByte(src[i]);
+	return (int)len;
+}
+
+int spi_write16_blocking(spi_inst_t *spi, const uint16_t *src, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		PANEL_writeByte(src[i] >> 8);
+		PANEL_writeByte(src[i] & 0xFF);
+	}
+	return (int)len;
+}
+
+bool spi_is_busy(spi_inst_t *spi)
+{
+	return false;
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx)
+{
+	return 0;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi)
+{
+	return &spi->hw;
+}
+
+// ============================================================
+// DMA (memoria para memoria, sincrono)
+// ============================================================
+
+int dma_claim_unused_channel(bool required)
+{
+	return 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+	dma_channel_config c = {DMA_SIZE_32, true, false};
+	return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+	c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+	c->read_inc = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+	c->write_inc = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+						   const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+	size_t size = 1u << config->size;
+	uint8_t *dst = (uint8_t *)write_addr;
+	const uint8_t *src = (const uint8_t *)read_addr;
+
+	if (!trigger)
+		return;
+	for (uint i = 0; i < transfer_count; i++)
+	{
+		memmove(dst, src, size);
+		if (config->write_inc)
+			dst += size;
+		if (config->read_inc)
+			src += size;
+	}
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {}
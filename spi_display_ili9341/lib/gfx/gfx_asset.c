@@ -0,0 +1,253 @@
+#include "pico/stdlib.h"
+
+#include "gfx.h"
+#include "gfx_asset.h"
+#include "ili9341.h"
+
+// Span sink shared by images and fonts. With a framebuffer every opaque run
+// is a one-row GFX_fillRect (plain row fills, 16 bpp or indexed). Without
+// one, opaque pixels are collected in spanLine; a block with no transparent
+// pixels gets a single window its rows are streamed into, otherwise each
+// contiguous stretch of a row is sent as its own window.
+#define SPAN_MAX ILI9341_TFTHEIGHT
+
+static uint16_t spanLines[2][SPAN_MAX]; // Alternated while streaming (DMA)
+static uint16_t *spanLine = spanLines[0];
+static int16_t spanX, spanY;	 // Next pixel position
+static int16_t spanStartX;		 // Position of spanLine[0]
+static uint16_t spanLen;		 // Pixels in spanLine
+static bool spanBuffered;
+
+static bool spanStream;					 // Window open, rows streamed into it
+static int16_t streamX0, streamX1;		 // Window columns, end exclusive
+static int16_t streamY0, streamY1;		 // Window rows, end exclusive
+
+// Starts a w x h block at (x, y). opaque means every pixel of every row is
+// painted, so the visible part can be one window.
+static void spanBegin(int16_t x, int16_t y, uint16_t w, uint16_t h, bool opaque)
+{
+	spanBuffered = GFX_hasFramebuf();
+	spanStream = false;
+	if (spanBuffered || !opaque || w > SPAN_MAX)
+		return;
+
+	streamX0 = x < 0 ? 0 : x;
+	streamY0 = y < 0 ? 0 : y;
+	streamX1 = x + w > (int16_t)GFX_getWidth() ? GFX_getWidth() : x + w;
+	streamY1 = y + h > (int16_t)GFX_getHeight() ? GFX_getHeight() : y + h;
+	if (streamX0 >= streamX1 || streamY0 >= streamY1)
+		return; // Off screen, the per-row path clips everything away
+
+	GFX_flushQueue();
+	LCD_beginPixels(streamX0, streamY0, streamX1 - streamX0, streamY1 - streamY0);
+	spanStream = true;
+}
+
+static void spanFinish()
+{
+	if (spanStream)
+		LCD_endPixels();
+	spanStream = false;
+}
+
+static void spanFlush()
+{
+	int16_t x = spanStartX, n = spanLen;
+	uint16_t *p = spanLine;
+
+	spanLen = 0;
+	if (spanStream)
+	{
+		// The row starts at the block's x, its visible columns go out as is
+		if (spanY >= streamY0 && spanY < streamY1)
+		{
+			LCD_writePixels(p + (streamX0 - x), streamX1 - streamX0);
+			spanLine = (spanLine == spanLines[0]) ? spanLines[1] : spanLines[0];
+		}
+		return;
+	}
+	if (n == 0 || spanY < 0 || spanY >= (int16_t)GFX_getHeight())
+		return;
+	if (x < 0)
+	{
+		p -= x;
+		n += x;
+		x = 0;
+	}
+	if (x + n > (int16_t)GFX_getWidth())
+		n = GFX_getWidth() - x;
+	if (n > 0)
+	{
+		GFX_flushQueue();
+		LCD_WriteBitmap(x, spanY, n, 1, p);
+	}
+}
+
+static void spanRow(int16_t x, int16_t y)
+{
+	spanX = spanStartX = x;
+	spanY = y;
+	spanLen = 0;
+}
+
+static void spanRun(uint16_t n, uint16_t color)
+{
+	if (spanBuffered)
+	{
+		if (n == 1)
+			GFX_drawPixel(spanX, spanY, color);
+		else
+			GFX_fillRect(spanX, spanY, n, 1, color);
+		spanX += n;
+		return;
+	}
+
+	while (n > 0)
+	{
+		if (spanLen == SPAN_MAX)
+		{
+			spanFlush();
+			spanStartX = spanX;
+		}
+		spanLine[spanLen++] = color;
+		spanX++;
+		n--;
+	}
+}
+
+static void spanSkip(uint16_t n)
+{
+	if (!spanBuffered)
+		spanFlush();
+	spanX += n;
+	spanStartX = spanX;
+}
+
+static void spanEnd()
+{
+	if (!spanBuffered)
+		spanFlush();
+}
+
+void GFX_drawImage(const GFX_Image *img, int16_t x, int16_t y)
+{
+	const uint8_t *p = img->data;
+
+	spanBegin(x, y, img->width, img->height, img->transparent < 0);
+	for (uint16_t j = 0; j < img->height; j++)
+	{
+		spanRow(x, y + j);
+		uint16_t left = img->width;
+		while (left > 0)
+		{
+			uint8_t c = *p++;
+			uint16_t n = (c & 0x7F) + 1;
+			if (n > left)
+				n = left; // Corrupt data, stay inside the row
+
+			if (c & 0x80)
+			{
+				uint8_t idx = *p++;
+				if (idx == img->transparent)
+					spanSkip(n);
+				else
+					spanRun(n, img->palette[idx]);
+			}
+			else
+			{
+				for (uint16_t i = 0; i < n; i++)
+				{
+					uint8_t idx = *p++;
+					if (idx == img->transparent)
+						spanSkip(1);
+					else
+						spanRun(1, img->palette[idx]);
+				}
+			}
+			left -= n;
+		}
+		spanEnd();
+	}
+	spanFinish();
+}
+
+int16_t GFX_drawRunChar(const GFX_RunFont *f, int16_t x, int16_t y, unsigned char c,
+						uint16_t color, uint16_t bg)
+{
+	if (c < f->first || c > f->last)
+		return x;
+
+	const GFX_RunGlyph *g = &f->glyph[c - f->first];
+	const uint8_t *p = f->data + g->dataOffset;
+	bool opaque = (bg != color);
+
+	if (!opaque)
+	{
+		spanBegin(x, y, 0, 0, false);
+		for (uint8_t j = 0; j < g->height; j++)
+		{
+			spanRow(x + g->xOffset, y + g->yOffset + j);
+			uint8_t left = g->width;
+			bool fg = false;
+			while (left > 0)
+			{
+				uint8_t n = *p++;
+				if (n > left)
+					n = left;
+				if (fg)
+					spanRun(n, color);
+				else
+					spanSkip(n);
+				left -= n;
+				fg = !fg;
+			}
+			spanEnd();
+		}
+		return x + g->xAdvance;
+	}
+
+	// Opaque: paint the whole cell, background around the bounding box. Every
+	// row is exactly the cell wide unless the glyph sticks out of it.
+	spanBegin(x, y, g->xAdvance, f->yAdvance,
+			  g->xOffset >= 0 && g->xOffset + g->width <= g->xAdvance);
+	for (uint8_t j = 0; j < f->yAdvance; j++)
+	{
+		int16_t row = j - g->yOffset;
+		spanRow(x, y + j);
+		if (row < 0 || row >= g->height)
+		{
+			spanRun(g->xAdvance, bg);
+			spanEnd();
+			continue;
+		}
+
+		if (g->xOffset > 0)
+			spanRun(g->xOffset, bg);
+		uint8_t left = g->width;
+		bool fg = false;
+		while (left > 0)
+		{
+			uint8_t n = *p++;
+			if (n > left)
+				n = left;
+			if (n > 0)
+				spanRun(n, fg ? color : bg);
+			left -= n;
+			fg = !fg;
+		}
+		int16_t right = g->xAdvance - g->xOffset - g->width;
+		if (right > 0)
+			spanRun(right, bg);
+		spanEnd();
+	}
+	spanFinish();
+	return x + g->xAdvance;
+}
+
+int16_t GFX_drawRunText(const GFX_RunFont *f, int16_t x, int16_t y, const char *text,
+						uint16_t color, uint16_t bg)
+{
+	while (*text)
+		x = GFX_drawRunChar(f, x, y, (unsigned char)*text++, color, bg);
+	return x;
+}
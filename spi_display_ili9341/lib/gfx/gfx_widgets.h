@@ -0,0 +1,95 @@
+#ifndef gfx_widgets_H
+#define gfx_widgets_H
+
+#include "pico/stdlib.h"
+
+// Retained widgets on top of gfx.c. Each widget remembers what it last drew
+// and only redraws (and marks as damaged) the part that changed, so a screen
+// is refreshed with GFX_flushDamage() instead of a full GFX_flush().
+// The *Set functions return true when something was redrawn. After the
+// area under a widget is overwritten (e.g. GFX_fillScreen), call its
+// *Invalidate function so the next *Set redraws it completely.
+
+#ifndef GFX_LABEL_MAX
+#define GFX_LABEL_MAX 32
+#endif
+
+// Fixed-width text field in the classic font. Only the character cells that
+// differ from the text on screen are redrawn.
+typedef struct
+{
+	int16_t x, y;
+	uint8_t size;
+	uint8_t width; // Field width in characters, 0 = as long as the text
+	uint16_t color, bg;
+	char cells[GFX_LABEL_MAX + 1]; // Characters currently on screen
+	uint8_t len;				   // Number of cells drawn so far
+	bool valid;
+} GFX_Label;
+
+void GFX_labelInit(GFX_Label *l, int16_t x, int16_t y, uint8_t width, uint8_t size,
+				   uint16_t color, uint16_t bg);
+void GFX_labelSetColor(GFX_Label *l, uint16_t color, uint16_t bg);
+bool GFX_labelSet(GFX_Label *l, const char *text);
+bool GFX_labelPrintf(GFX_Label *l, const char *format, ...);
+void GFX_labelInvalidate(GFX_Label *l);
+
+// Label showing a number through a printf format, e.g. "%6.2f g"
+typedef struct
+{
+	GFX_Label label;
+	const char *format;
+	float value;
+} GFX_Value;
+
+void GFX_valueInit(GFX_Value *v, int16_t x, int16_t y, uint8_t width, uint8_t size,
+				   uint16_t color, uint16_t bg, const char *format);
+bool GFX_valueSet(GFX_Value *v, float value);
+void GFX_valueInvalidate(GFX_Value *v);
+
+// Horizontal bar graph with a one pixel border
+typedef struct
+{
+	int16_t x, y, w, h;
+	float min, max;
+	uint16_t color, bg, border;
+	int16_t fill; // Filled inner width currently on screen
+	bool valid;
+} GFX_Bar;
+
+void GFX_barInit(GFX_Bar *b, int16_t x, int16_t y, int16_t w, int16_t h,
+				 float min, float max, uint16_t color, uint16_t bg, uint16_t border);
+bool GFX_barSet(GFX_Bar *b, float value);
+void GFX_barInvalidate(GFX_Bar *b);
+
+// Half-circle dial with a needle, min on the left and max on the right
+typedef struct
+{
+	int16_t cx, cy, r;
+	float min, max;
+	uint16_t dial, needle, bg;
+	int16_t nx, ny; // Needle tip currently on screen
+	bool valid;
+} GFX_Gauge;
+
+void GFX_gaugeInit(GFX_Gauge *g, int16_t cx, int16_t cy, int16_t r, float min, float max,
+				   uint16_t dial, uint16_t needle, uint16_t bg);
+bool GFX_gaugeSet(GFX_Gauge *g, float value);
+void GFX_gaugeInvalidate(GFX_Gauge *g);
+
+// Round status indicator, colors[state] gives the fill for each state
+typedef struct
+{
+	int16_t x, y, r;
+	const uint16_t *colors;
+	uint8_t numStates;
+	uint8_t state;
+	bool valid;
+} GFX_StatusIcon;
+
+void GFX_statusInit(GFX_StatusIcon *s, int16_t x, int16_t y, int16_t r,
+					const uint16_t *colors, uint8_t numStates);
+bool GFX_statusSet(GFX_StatusIcon *s, uint8_t state);
+void GFX_statusInvalidate(GFX_StatusIcon *s);
+
+#endif